@@ -0,0 +1,68 @@
+##################################################################
+# Simulator events/s of star-buffer-mp --topology=leafspine as the
+# fabric grows. Run from ns-3.34/, like run_ns3.py:
+#   python3 ../detailed_ae/leafspine/benchmark.py [--outdir DIR]
+# The generated configs and the logs go to DIR, a fresh temporary
+# directory by default, so the source tree is left untouched.
+##################################################################
+
+import subprocess as sp
+import argparse
+import os
+import re
+import tempfile
+
+# (numLeaves, numSpines, hostsPerLeaf)
+FABRICS = [(2, 2, 4), (4, 2, 8), (4, 4, 16), (8, 4, 16), (8, 8, 32), (16, 8, 32)]
+
+
+def write_conf(path, numLeaves, hostsPerLeaf, cca=4):
+    # one sink per leaf, all other hosts are senders with one Long flow each;
+    # senders are spread round-robin over the leaves, so most flows cross the spines
+    numSinks = numLeaves
+    numSenders = hostsPerLeaf - 1
+    with open(path, 'w') as f:
+        for sink in range(numSinks):
+            f.write("%d\n" % numSenders)
+        for sink in range(numSinks):
+            for sender in range(numSenders):
+                # sink sender type conf start cca diffserv srcLinkRate numFlows
+                f.write("%d\t%d\tLong\t100001\t0\t%d\t1\t2\t1\n" % (sink, sender, cca))
+    return numSinks
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    # sources stop 2 s before the end of the simulation, so keep this above 2;
+    # events/s settles quickly; the rates are kept low so the debug build finishes in minutes
+    parser.add_argument('--simDuration', type=float, default=2.2)
+    parser.add_argument('--hostBw', default="100")
+    parser.add_argument('--fabricBw', default="400")
+    parser.add_argument('--outdir', default=None, help="where the configs and logs go, outside the source tree")
+    args = parser.parse_args()
+
+    outdir = os.path.abspath(args.outdir) if args.outdir else tempfile.mkdtemp(prefix="leafspine_benchmark_")
+    confdir = os.path.join(outdir, "configurations")
+    logdir = os.path.join(outdir, "logs") + os.sep
+    os.makedirs(confdir, exist_ok=True)
+    print("# configs and logs in", outdir)
+    print("leaves spines hosts events wallclock_s events_per_s")
+    for numLeaves, numSpines, hostsPerLeaf in FABRICS:
+        conf = os.path.join(confdir, "l%d_s%d_h%d.conf" % (numLeaves, numSpines, hostsPerLeaf))
+        numSinks = write_conf(conf, numLeaves, hostsPerLeaf)
+        joined = lambda v: "_".join([v] * numSinks)
+        cmd = ("star-buffer-mp --topology=leafspine --numLeaves=%d --numSpines=%d --fabricBw=%s "
+               "--simDuration=%s --queueDiscType=Fifo --qdiscSize=8334 --appConfigFile=%s --numSinks=%d "
+               "--midDelayString=%s --srcBwString=%s --midBwString=%s --adaptiveIncreaseParameterString=%s "
+               "--adaptiveDecreaseParameterString=%s --bufferSize=1250000 --bufferAlgorithm=111 "
+               "--startProbeBuffer=1250000 --monitorInterval=500 --smoothQlenCollection=500 --smoothWindow=100 "
+               "--smoothOutlierThreshold=0 --pawMode=pa --randomSeed=1 --targetBW=125000 --mainRoomNumQueues=12 "
+               "--logdir=%s"
+               % (numLeaves, numSpines, args.fabricBw, args.simDuration, conf, numSinks,
+                  joined("0.01"), joined(args.hostBw), joined(args.hostBw), joined("2"), joined("4"), logdir))
+        proc = sp.run("./waf --run-no-build \"" + cmd + "\"", shell=True, stdout=sp.PIPE, stderr=sp.STDOUT, text=True)
+        m = re.search(r"Simulator events: (\d+), wallclock ([\d.e+-]+)s, ([\d.e+-]+) events/s", proc.stdout)
+        if m is None:
+            print(numLeaves, numSpines, numLeaves * hostsPerLeaf, "failed")
+            continue
+        print(numLeaves, numSpines, numLeaves * hostsPerLeaf, m.group(1), m.group(2), m.group(3))
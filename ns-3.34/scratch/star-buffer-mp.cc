@@ -43,7 +43,11 @@
 #include <random>
 #include <cstddef>
 #include <algorithm>
+#include <cmath>
+#include <chrono>
 #include <regex>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -109,7 +113,7 @@ std::vector<std::vector < std::vector < std::vector<std::string> > >> appSetting
 std::string ccaMap[16] = {"Gcc", "Nada", "", "Fixed", 
   "Cubic", "Bbr", "Copa", "Yeah", 
   "Illinois", "Vegas", "Htcp", "Bic", 
-  "LinuxReno", "Scalable", "", ""};
+  "LinuxReno", "Scalable", "Dctcp", ""};
 
 std::string autoDecayingFunc = "Linear";
 double_t autoDecayingCoef = 1.;
@@ -124,6 +128,59 @@ QueueDiscContainer bottleneckQueueDiscsCollection;
 QueueDiscContainer outputQueueDiscsCollection;
 // Ptr<UtilityWarehouse> utilityWarehouse;
 
+// AnnC: every trace file, so that a branch (see branchFile) can move them under its own directory
+std::vector<std::pair<Ptr<OutputStreamWrapper>, std::string>> traceStreams;
+
+Ptr<OutputStreamWrapper> CreateTraceStream (std::string fileName) {
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (fileName, std::ios::out);
+  NS_ABORT_MSG_UNLESS (stream->GetStream ()->good (), "Unable to open file " << fileName);
+  traceStreams.push_back(std::make_pair(stream, fileName));
+  return stream;
+}
+
+void FlushTraceStreams () {
+  for (uint32_t i=0; i<traceStreams.size(); i++) {
+    traceStreams[i].first->GetStream ()->flush ();
+  }
+  std::cout.flush ();
+}
+
+// Copy what was traced so far from oldDir to newDir and keep tracing there
+void MoveTraceStreams (std::string oldDir, std::string newDir) {
+  for (uint32_t i=0; i<traceStreams.size(); i++) {
+    std::string oldName = traceStreams[i].second;
+    if (oldName.compare(0, oldDir.size(), oldDir) != 0) continue;
+    std::string newName = newDir + oldName.substr(oldDir.size());
+    std::ofstream *ofs = dynamic_cast<std::ofstream *> (traceStreams[i].first->GetStream ());
+    ofs->close ();
+    std::filesystem::copy_file (oldName, newName, std::filesystem::copy_options::overwrite_existing);
+    ofs->open (newName, std::ios::out | std::ios::app);
+    traceStreams[i].second = newName;
+  }
+}
+
+// How many branches to run at once: the children share the warmed-up state copy-on-write,
+// so each one is budgeted the resident size of the parent out of the available memory
+uint32_t BranchSlots () {
+  uint64_t residentPages = 0, availableKb = 0;
+  std::ifstream statm("/proc/self/statm");
+  statm >> residentPages >> residentPages;
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  uint64_t value;
+  std::string unit;
+  while (meminfo >> key >> value >> unit) {
+    if (key == "MemAvailable:") {
+      availableKb = value;
+      break;
+    }
+  }
+  uint64_t residentKb = residentPages * sysconf(_SC_PAGESIZE) / 1024;
+  uint64_t slots = residentKb > 0 ? availableKb / residentKb : 1;
+  slots = std::min(slots, (uint64_t)sysconf(_SC_NPROCESSORS_ONLN));
+  return std::max(slots, (uint64_t)1);
+}
+
 uint32_t Ipv4Hash (Ipv4Address src, Ipv4Address dest, uint8_t prot, uint16_t srcPort, uint16_t destPort, uint32_t perturbation = 0) {
   /* serialize the 5-tuple and the perturbation in buf */
   uint8_t buf[17];
@@ -145,6 +202,11 @@ uint32_t Ipv4Hash (Ipv4Address src, Ipv4Address dest, uint8_t prot, uint16_t src
   return hash;
 }
 
+// AnnC: flow ECMP in the leaf-spine topology; the perturbation (switch node id) avoids hash polarization
+uint32_t EcmpHash (uint32_t perturbation, Ipv4Address src, Ipv4Address dest, uint8_t prot, uint16_t srcPort, uint16_t destPort) {
+  return Ipv4Hash (src, dest, prot, srcPort, destPort, perturbation);
+}
+
 static void DbeTracer (Ptr<OutputStreamWrapper> stream, Ptr<const QueueDiscItem> item, const char* reason) {
   *stream->GetStream () << Simulator::Now ().GetSeconds () << " [DropBeforeEnqueue] " << reason << " ";
   item->Print (*stream->GetStream ());
@@ -467,6 +529,7 @@ void StatQdisc (Ptr<QueueDisc> q, std::string qdisctype, Ptr<OutputStreamWrapper
 
 uint64_t flowIdGlobal = 0;
 std::map<uint32_t, uint32_t> ccaQueueidMapping;
+std::vector<std::pair<std::string, Ptr<GameClient>>> gameClients; // "sender<id>_port<port>" -> receiver
 std::vector<double> rttBuckets;
 // std::vector < float > sendersAsrcLinkRates, sendersBsrcLinkRates;
 std::vector<std::vector<double>> sendersSrcLinkRatesArray;
@@ -488,7 +551,6 @@ void InstallApp (Ptr<Node> source,
                  uint32_t mainRoomQueueScheme) {
   Ipv4Address sourceAddr = source->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
   Ipv4Address sinkAddr = sink->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
-  AsciiTraceHelper ascii;
   std::vector < std::vector<std::string> > appSettings = appSettingsArray[sinkID][senderID];
   double srcDelay = sendersSrcLinkRatesArray[sinkID][senderID];
   // if (sinkID == 0) {
@@ -507,6 +569,8 @@ void InstallApp (Ptr<Node> source,
 
   // Ptr<OutputStreamWrapper> appTrStream = ascii.CreateFileStream (appTrFileName.c_str ());
   // Ptr<OutputStreamWrapper> bwTrStream = ascii.CreateFileStream (bwTrFileName.c_str ());
+  // opened by the first Video/Ctrl app of this sender, as the decoders log every frame there
+  Ptr<OutputStreamWrapper> appTrStream, bwTrStream;
 
   std::default_random_engine re;
   for (uint16_t appIndex = 0; appIndex < appSettings.size (); appIndex++) {
@@ -535,40 +599,47 @@ void InstallApp (Ptr<Node> source,
     bool tcpEnabled = ccaOption & 0xFC;
 
     if (appType == "Video" || appType == "Ctrl") {
-      // for (uint16_t flowIndex = 0; flowIndex < flowNum; flowIndex++) {
-      //   uint16_t port = portBase + flowIndex;
-      //   Ipv4Header::DscpType dscp = flowIndex < dscpFlowNum ? Ipv4Header::DSCP_CS2 : Ipv4Header::DscpDefault;
-      //   if (tcpEnabled) {
-      //     flowHash.push_back(Ipv4Hash(sourceAddr, sinkAddr, 6, port, port));
-      //   }
-      //   else {
-      //     flowHash.push_back(Ipv4Hash(sourceAddr, sinkAddr, 17, port, port));
-      //   }
-      //   Ptr<GameServer> sendApp = CreateObject<GameServer> ();
-      //   Ptr<GameClient> recvApp = CreateObject<GameClient> ();
-      //   source->AddApplication (sendApp);
-      //   sink->AddApplication (recvApp);
-      //   Ipv4Address sendIp = source->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
-      //   Ipv4Address recvIp = sink->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
-
-      //   uint32_t delayDdlMs = 10000;
-      //   uint32_t interval = 20;
-      //   std::string fecPolicy = "rtx";
-
-      //   sendApp->Setup (
-      //     sendIp, port, recvIp, port,
-      //     MicroSeconds (delayDdlMs * 1000), interval,
-      //     fecPolicy, tcpEnabled, dscp, appTrStream, bwTrStream
-      //   );
-      //   recvApp->Setup (
-      //     sendIp, port, port, interval, 
-      //     MicroSeconds (delayDdlMs * 1000), tcpEnabled, appTrStream
-      //   );
-
-      //   sendApp->SetController (ccaMap[ccaOption]);
-      //   sourceApps.Add (sendApp);
-      //   sinkApps.Add (recvApp);
-      // }
+      NS_ABORT_MSG_IF (tcpEnabled, "Video/Ctrl apps run GCC/NADA over udp, cca " << ccaOption << " is a tcp one");
+      if (!appTrStream) {
+        appTrStream = CreateTraceStream (appTrFileName.c_str ());
+        bwTrStream = CreateTraceStream (bwTrFileName.c_str ());
+      }
+      for (uint16_t flowIndex = 0; flowIndex < flowNum; flowIndex++) {
+        uint16_t port = portBase + flowIndex;
+        Ipv4Header::DscpType dscp = flowIndex < dscpFlowNum ? Ipv4Header::DSCP_CS2 : Ipv4Header::DscpDefault;
+        flowHash.push_back(Ipv4Hash(sourceAddr, sinkAddr, 17, port, port));
+        Ptr<GameServer> sendApp = CreateObject<GameServer> ();
+        Ptr<GameClient> recvApp = CreateObject<GameClient> ();
+        source->AddApplication (sendApp);
+        sink->AddApplication (recvApp);
+
+        uint32_t delayDdlMs = 10000;
+        uint32_t interval = 20;
+        std::string fecPolicy = "rtx";
+
+        sendApp->Setup (
+          sourceAddr, port, sinkAddr, port,
+          MicroSeconds (delayDdlMs * 1000), interval,
+          fecPolicy, tcpEnabled, dscp, appTrStream, bwTrStream
+        );
+        recvApp->Setup (
+          sourceAddr, port, port, interval, 
+          MicroSeconds (delayDdlMs * 1000), tcpEnabled, appTrStream
+        );
+
+        // AnnC: tagged like BulkSend, otherwise GenQueueDisc puts the video and its feedback in p=0
+        uint32_t flowPriority = longBurstV3FlowPriority;
+        uint32_t flowId = flowIdGlobal++;
+        sendApp->SetFlowTags (flowId, flowPriority);
+        recvApp->SetFlowTags (flowIdGlobal++, 0); // AnnC: the sink of the flow takes the next id
+
+        sendApp->SetController (ccaMap[ccaOption]);
+        sendApp->SetStartTime (startTime + Seconds(appStart));
+        sourceApps.Add (sendApp);
+        sinkApps.Add (recvApp);
+        gameClients.push_back (std::make_pair ("sender" + std::to_string(senderID) + "_port" + std::to_string(port), recvApp));
+        std::cout << "appIndex=" << appIndex << ", flowIndex=" << flowIndex << ", flowId=" << flowId << ", port=" << port << ", cca=" << ccaMap[ccaOption] << ", appStart=" << appStart << ", flowPriority=" << flowPriority << std::endl;
+      }
     }
     else if (appType == "Ftp" || appType == "Web") {
       std::vector<uint32_t> ftpMaxBytes;
@@ -600,6 +671,10 @@ void InstallApp (Ptr<Node> source,
         std::fill (ftpMaxBytes.begin (), ftpMaxBytes.end (), (appConf / 1000) << 10);
       }
       NS_ASSERT (tcpEnabled); /* these apps have to be tcp */
+      TypeId cca = GetCca (ccaMap[ccaOption]);
+      BulkFlowHelper bulkFlows ("ns3::TcpSocketFactory");
+      std::vector<BulkFlowHelper::Flow> flows;
+      flows.reserve (flowNum);
       for (uint16_t flowIndex = 0; flowIndex < flowNum; flowIndex++) {
 
         // uint16_t flowPriority = 0;
@@ -622,31 +697,17 @@ void InstallApp (Ptr<Node> source,
         uint32_t flowPriority = longBurstV3FlowPriority;
 
         uint16_t port = portBase + flowIndex;
-        InetSocketAddress localAddress (Ipv4Address::GetAny (), port);
         // Ipv4Header::DscpType dscp = flowIndex < dscpFlowNum ? Ipv4Header::DSCP_CS2 : Ipv4Header::DscpDefault;
-        // localAddress.SetTos (dscp << 2);
-        InetSocketAddress remoteAddress (sinkAddr, port);
-        // remoteAddress.SetTos (dscp << 2);
-        BulkSendHelper ftp ("ns3::TcpSocketFactory", Address ());
-        ftp.SetAttribute ("Local", AddressValue (localAddress));
-        ftp.SetAttribute ("Remote", AddressValue (remoteAddress));
-        ftp.SetAttribute ("MaxBytes", UintegerValue (ftpMaxBytes[flowIndex]));
-        ftp.SetAttribute ("TcpCongestionOps", TypeIdValue (GetCca (ccaMap[ccaOption])));
-        ftp.SetAttribute("FlowId", UintegerValue(flowIdGlobal++));
-        ftp.SetAttribute("priority",UintegerValue(flowPriority));
-        ftp.SetAttribute("priorityCustom",UintegerValue(flowPriority));
-        ApplicationContainer appFtp = ftp.Install (source);
-        appFtp.Start(startTime + Seconds(appStart));
-        sourceApps.Add (appFtp);
+        flows.push_back ({port, ftpMaxBytes[flowIndex], startTime + Seconds(appStart), cca, uint32_t (flowIdGlobal++), flowPriority});
         std::cout << "appIndex=" << appIndex << ", flowIndex=" << flowIndex << ", flowId=" << flowIdGlobal-1 << ", appStart=" << appStart << ", flowPriority=" << flowPriority << std::endl;
 
-        PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", Address (localAddress));
-        sinkApps.Add (sinkHelper.Install (sink));
+        flowHash.push_back (Ipv4Hash (sourceAddr, sinkAddr, 6, port, port));
+      }
+      bulkFlows.Install (source, sink, sinkAddr, flows, sourceApps, sinkApps);
+      if (flowNum > 0) {
         sinkApps.Get(0)->SetAttribute("flowId", UintegerValue(100+flowIdGlobal+flowNum)); // AnnC: maybe they dont have enough to queue
         sinkApps.Get(0)->SetAttribute("priority",UintegerValue(0));
         sinkApps.Get(0)->SetAttribute("priorityCustom",UintegerValue(0));
-
-        flowHash.push_back (Ipv4Hash (sourceAddr, sinkAddr, 6, port, port));
       }
 
       std::vector<uint64_t> flowsizelist;
@@ -676,22 +737,22 @@ void InstallApp (Ptr<Node> source,
       if (!light_logging) {
         std::string fctTrFileNameFull = fctTrFileName + "_app" + std::to_string(appIndex) + ".tr";
         Simulator::Schedule (Seconds (fctStatIntervalSec+appStart) + startTime, &StatFctStartEndOnly, sourceApps, portBase, flowNum, 
-          ascii.CreateFileStream (fctTrFileNameFull.c_str ()));
+          CreateTraceStream (fctTrFileNameFull.c_str ()));
 
         std::string gptTrFileNameFull = gptTrFileName + "_app" + std::to_string(appIndex) + ".tr";
         Simulator::Schedule (Seconds (fctStatIntervalSec+appStart) + startTime, &StatGoodputStartEndOnly, sourceApps, sinkApps, portBase, flowNum, 0,
-          ascii.CreateFileStream (gptTrFileNameFull.c_str ()));
+          CreateTraceStream (gptTrFileNameFull.c_str ()));
       } else {
         if (long_goodput_logging) {
           std::string gptTrFileNameFull = gptTrFileName + "_app" + std::to_string(appIndex) + ".tr";
           Simulator::Schedule (Seconds (fctStatIntervalSec+appStart) + startTime, &StatGoodputStartEndOnly, sourceApps, sinkApps, portBase, flowNum, 0,
-            ascii.CreateFileStream (gptTrFileNameFull.c_str ()));
+            CreateTraceStream (gptTrFileNameFull.c_str ()));
         }
 
         if (fct_logging) {
           std::string fctTrFileNameFull = fctTrFileName + "_app" + std::to_string(appIndex) + ".tr";
           Simulator::Schedule (Seconds (fctStatIntervalSec+appStart) + startTime, &StatFctStartEndOnly, sourceApps, portBase, flowNum, 
-            ascii.CreateFileStream (fctTrFileNameFull.c_str ()));
+            CreateTraceStream (fctTrFileNameFull.c_str ()));
         }
       }
     }
@@ -708,6 +769,11 @@ void InstallApp (Ptr<Node> source,
       std::uniform_real_distribution<double> unif(0,startRangeMs);
       // std::default_random_engine re;
       re.seed(randomSeed);
+      TypeId cca = GetCca (ccaMap[ccaOption]);
+      BulkFlowHelper bulkFlows ("ns3::TcpSocketFactory");
+      std::vector<BulkFlowHelper::Flow> flows;
+      flows.reserve (flowNum);
+      bulkFlows.SetSourceAttribute ("InitialCwnd", UintegerValue (flowSizeInPackets));
       for (uint16_t flowIndex = 0; flowIndex < flowNum; flowIndex++) {
         
         // uint16_t flowPriority = 0;
@@ -731,34 +797,18 @@ void InstallApp (Ptr<Node> source,
 
         uint16_t port = portBase + flowIndex;
         std::cout << "port=" << port << std::endl;
-        InetSocketAddress localAddress (Ipv4Address::GetAny (), port);
-        // Ipv4Header::DscpType dscp = flowIndex < dscpFlowNum ? Ipv4Header::DSCP_CS2 : Ipv4Header::DscpDefault;
-        // localAddress.SetTos (dscp << 2);
-        InetSocketAddress remoteAddress (sinkAddr, port);
-        // remoteAddress.SetTos (dscp << 2);
-        BulkSendHelper ftp ("ns3::TcpSocketFactory", Address ());
-        ftp.SetAttribute ("Local", AddressValue (localAddress));
-        ftp.SetAttribute ("Remote", AddressValue (remoteAddress));
-        ftp.SetAttribute ("MaxBytes", UintegerValue (flowSize));
-        ftp.SetAttribute ("TcpCongestionOps", TypeIdValue (GetCca (ccaMap[ccaOption])));
-        ftp.SetAttribute("FlowId", UintegerValue(flowIdGlobal++));
-        ftp.SetAttribute("priority",UintegerValue(flowPriority));
-        ftp.SetAttribute("priorityCustom",UintegerValue(flowPriority));
-        ftp.SetAttribute("InitialCwnd", UintegerValue (flowSizeInPackets));
-        ApplicationContainer appFtp = ftp.Install (source);
         double randomStartMs = unif(re);
-        appFtp.Start(startTime + Seconds(appStart + randomStartMs/1000.));
-        // appFtp.Start(startTime + Seconds(3));
-        sourceApps.Add (appFtp);
+        flows.push_back ({port, flowSize, startTime + Seconds(appStart + randomStartMs/1000.), cca, uint32_t (flowIdGlobal++), flowPriority});
         std::cout << "appIndex=" << appIndex << ", flowIndex=" << flowIndex << ", flowId=" << flowIdGlobal-1 << ", appStart=" << appStart << ", randomStartMs=" << randomStartMs << ", flowPriority=" << flowPriority << std::endl;
+        flowIdGlobal++; // AnnC: the sink of the flow takes the next id
 
-        PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", Address (localAddress));
-        sinkApps.Add (sinkHelper.Install (sink));
-        sinkApps.Get(0)->SetAttribute("flowId", UintegerValue(flowIdGlobal++)); // AnnC: maybe they dont have enough to queue
+        flowHash.push_back (Ipv4Hash (sourceAddr, sinkAddr, 6, port, port));
+      }
+      bulkFlows.Install (source, sink, sinkAddr, flows, sourceApps, sinkApps);
+      if (flowNum > 0) {
+        sinkApps.Get(0)->SetAttribute("flowId", UintegerValue(flowIdGlobal-1)); // AnnC: maybe they dont have enough to queue
         sinkApps.Get(0)->SetAttribute("priority",UintegerValue(0));
         sinkApps.Get(0)->SetAttribute("priorityCustom",UintegerValue(0));
-
-        flowHash.push_back (Ipv4Hash (sourceAddr, sinkAddr, 6, port, port));
       }
       
       std::vector<uint64_t> flowsizelist;
@@ -788,22 +838,22 @@ void InstallApp (Ptr<Node> source,
       if (!light_logging) {
         std::string fctTrFileNameFull = fctTrFileName + "_app" + std::to_string(appIndex) + ".tr";
         Simulator::Schedule (Seconds (fctStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatFctStartEndOnly, sourceApps, portBase, flowNum, 
-          ascii.CreateFileStream (fctTrFileNameFull.c_str ()));
+          CreateTraceStream (fctTrFileNameFull.c_str ()));
 
         std::string gptTrFileNameFull = gptTrFileName + "_app" + std::to_string(appIndex) + ".tr";
         Simulator::Schedule (Seconds (fctStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatGoodputStartEndOnly, sourceApps, sinkApps, portBase, flowNum, 0,
-          ascii.CreateFileStream (gptTrFileNameFull.c_str ()));
+          CreateTraceStream (gptTrFileNameFull.c_str ()));
       } else {
         if (long_goodput_logging) {
           std::string gptTrFileNameFull = gptTrFileName + "_app" + std::to_string(appIndex) + ".tr";
           Simulator::Schedule (Seconds (fctStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatGoodputStartEndOnly, sourceApps, sinkApps, portBase, flowNum, 0,
-            ascii.CreateFileStream (gptTrFileNameFull.c_str ()));
+            CreateTraceStream (gptTrFileNameFull.c_str ()));
         }
 
         if (fct_logging) {
           std::string fctTrFileNameFull = fctTrFileName + "_app" + std::to_string(appIndex) + ".tr";
           Simulator::Schedule (Seconds (fctStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatFctStartEndOnly, sourceApps, portBase, flowNum,
-            ascii.CreateFileStream (fctTrFileNameFull.c_str ()));
+            CreateTraceStream (fctTrFileNameFull.c_str ()));
         }
       }
     }
@@ -816,6 +866,10 @@ void InstallApp (Ptr<Node> source,
       std::uniform_real_distribution<double> unif(0,startRangeMs);
       // std::default_random_engine re;
       re.seed(randomSeed);
+      TypeId cca = GetCca (ccaMap[ccaOption]);
+      BulkFlowHelper bulkFlows ("ns3::TcpSocketFactory");
+      std::vector<BulkFlowHelper::Flow> flows;
+      flows.reserve (flowNum);
       for (uint16_t flowIndex = 0; flowIndex < flowNum; flowIndex++) {
         
         // uint16_t flowPriority = 0;
@@ -839,47 +893,33 @@ void InstallApp (Ptr<Node> source,
          
         uint16_t port = portBase + flowIndex;
         std::cout << "port=" << port << std::endl;
-        InetSocketAddress localAddress (Ipv4Address::GetAny (), port);
-        // Ipv4Header::DscpType dscp = flowIndex < dscpFlowNum ? Ipv4Header::DSCP_CS2 : Ipv4Header::DscpDefault;
-        // localAddress.SetTos (dscp << 2);
-        InetSocketAddress remoteAddress (sinkAddr, port);
-        // remoteAddress.SetTos (dscp << 2);
-        BulkSendHelper ftp ("ns3::TcpSocketFactory", Address ());
-        ftp.SetAttribute ("Local", AddressValue (localAddress));
-        ftp.SetAttribute ("Remote", AddressValue (remoteAddress));
-        ftp.SetAttribute ("MaxBytes", UintegerValue (flowSize));
-        ftp.SetAttribute ("TcpCongestionOps", TypeIdValue (GetCca (ccaMap[ccaOption])));
-        ftp.SetAttribute("FlowId", UintegerValue(flowIdGlobal++));
-        ftp.SetAttribute("priority",UintegerValue(flowPriority));
-        ftp.SetAttribute("priorityCustom",UintegerValue(flowPriority));
-        ApplicationContainer appFtp = ftp.Install (source);
         double randomStartMs = unif(re);
-        appFtp.Start(startTime + Seconds(appStart + randomStartMs/1000.));
-        sourceApps.Add (appFtp);
+        flows.push_back ({port, flowSize, startTime + Seconds(appStart + randomStartMs/1000.), cca, uint32_t (flowIdGlobal++), flowPriority});
         std::cout << "appIndex=" << appIndex << ", flowIndex=" << flowIndex << ", flowId=" << flowIdGlobal-1 << ", appStart=" << appStart << ", randomStartMs=" << randomStartMs << ", flowPriority=" << flowPriority << std::endl;
+        flowIdGlobal++; // AnnC: the sink of the flow takes the next id
 
-        PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", Address (localAddress));
-        sinkApps.Add (sinkHelper.Install (sink));
-        sinkApps.Get(0)->SetAttribute("flowId", UintegerValue(flowIdGlobal++)); // AnnC: maybe they dont have enough to queue
+        flowHash.push_back (Ipv4Hash (sourceAddr, sinkAddr, 6, port, port));
+      }
+      bulkFlows.Install (source, sink, sinkAddr, flows, sourceApps, sinkApps);
+      if (flowNum > 0) {
+        sinkApps.Get(0)->SetAttribute("flowId", UintegerValue(flowIdGlobal-1)); // AnnC: maybe they dont have enough to queue
         sinkApps.Get(0)->SetAttribute("priority",UintegerValue(0));
         sinkApps.Get(0)->SetAttribute("priorityCustom",UintegerValue(0));
-
-        flowHash.push_back (Ipv4Hash (sourceAddr, sinkAddr, 6, port, port));
       }
         
       if (!light_logging) {
         std::string fctTrFileNameFull = fctTrFileName + "_app" + std::to_string(appIndex) + ".tr";
         Simulator::Schedule (Seconds (fctStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatFct, sourceApps, portBase, flowNum, 
-          ascii.CreateFileStream (fctTrFileNameFull.c_str ()));
+          CreateTraceStream (fctTrFileNameFull.c_str ()));
 
         std::string gptTrFileNameFull = gptTrFileName + "_app" + std::to_string(appIndex) + ".tr";
         Simulator::Schedule (Seconds (gptStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatGoodput, sourceApps, sinkApps, portBase, flowNum, 0,
-          ascii.CreateFileStream (gptTrFileNameFull.c_str ()));
+          CreateTraceStream (gptTrFileNameFull.c_str ()));
       } else {
         if (long_goodput_logging) {
           std::string gptTrFileNameFull = gptTrFileName + "_app" + std::to_string(appIndex) + ".tr";
           Simulator::Schedule (Seconds (gptStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatGoodput, sourceApps, sinkApps, portBase, flowNum, 0,
-            ascii.CreateFileStream (gptTrFileNameFull.c_str ()));
+            CreateTraceStream (gptTrFileNameFull.c_str ()));
         }
 
         if (fct_logging) {
@@ -899,6 +939,10 @@ void InstallApp (Ptr<Node> source,
       std::uniform_real_distribution<double> unif(0,startRangeMs);
       // std::default_random_engine re;
       re.seed(randomSeed);
+      TypeId cca = GetCca (ccaMap[ccaOption]);
+      BulkFlowHelper bulkFlows ("ns3::TcpSocketFactory");
+      std::vector<BulkFlowHelper::Flow> flows;
+      flows.reserve (flowNum);
       for (uint16_t flowIndex = 0; flowIndex < flowNum; flowIndex++) {
         
         // uint16_t flowPriority = 0;
@@ -922,33 +966,19 @@ void InstallApp (Ptr<Node> source,
          
         uint16_t port = portBase + flowIndex;
         std::cout << "port=" << port << std::endl;
-        InetSocketAddress localAddress (Ipv4Address::GetAny (), port);
-        // Ipv4Header::DscpType dscp = flowIndex < dscpFlowNum ? Ipv4Header::DSCP_CS2 : Ipv4Header::DscpDefault;
-        // localAddress.SetTos (dscp << 2);
-        InetSocketAddress remoteAddress (sinkAddr, port);
-        // remoteAddress.SetTos (dscp << 2);
-        BulkSendHelper ftp ("ns3::TcpSocketFactory", Address ());
-        ftp.SetAttribute ("Local", AddressValue (localAddress));
-        ftp.SetAttribute ("Remote", AddressValue (remoteAddress));
-        ftp.SetAttribute ("MaxBytes", UintegerValue (flowSize));
-        ftp.SetAttribute ("TcpCongestionOps", TypeIdValue (GetCca (ccaMap[ccaOption])));
-        ftp.SetAttribute("FlowId", UintegerValue(flowIdGlobal++));
-        ftp.SetAttribute("priority",UintegerValue(flowPriority));
-        ftp.SetAttribute("priorityCustom",UintegerValue(flowPriority));
-        ApplicationContainer appFtp = ftp.Install (source);
         double randomStartMs = unif(re);
-        appFtp.Start(startTime + Seconds(appStart + randomStartMs/1000.));
-        sourceApps.Add (appFtp);
-        sourceApps.Start(startTime + Seconds(appStart + randomStartMs/1000.));
+        flows.push_back ({port, flowSize, startTime + Seconds(appStart + randomStartMs/1000.), cca, uint32_t (flowIdGlobal++), flowPriority});
         std::cout << "appIndex=" << appIndex << ", flowIndex=" << flowIndex << ", flowId=" << flowIdGlobal-1 << ", appStart=" << appStart << ", randomStartMs=" << randomStartMs << ", flowPriority=" << flowPriority << std::endl;
 
-        PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", Address (localAddress));
-        sinkApps.Add (sinkHelper.Install (sink));
+        flowHash.push_back (Ipv4Hash (sourceAddr, sinkAddr, 6, port, port));
+      }
+      bulkFlows.Install (source, sink, sinkAddr, flows, sourceApps, sinkApps);
+      if (flowNum > 0) {
         sinkApps.Get(0)->SetAttribute("flowId", UintegerValue(100+flowIdGlobal+flowNum)); // AnnC: maybe they dont have enough to queue
         sinkApps.Get(0)->SetAttribute("priority",UintegerValue(0));
         sinkApps.Get(0)->SetAttribute("priorityCustom",UintegerValue(0));
-
-        flowHash.push_back (Ipv4Hash (sourceAddr, sinkAddr, 6, port, port));
+        // AnnC: Sized has always started all of its flows at the last drawn start time
+        sourceApps.Start(flows.back ().start);
       }
 
       std::vector<uint64_t> flowsizelist;
@@ -978,22 +1008,22 @@ void InstallApp (Ptr<Node> source,
       if (!light_logging) {
         std::string fctTrFileNameFull = fctTrFileName + "_app" + std::to_string(appIndex) + ".tr";
         Simulator::Schedule (Seconds (fctStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatFctStartEndOnly, sourceApps, portBase, flowNum, 
-          ascii.CreateFileStream (fctTrFileNameFull.c_str ()));
+          CreateTraceStream (fctTrFileNameFull.c_str ()));
 
         std::string gptTrFileNameFull = gptTrFileName + "_app" + std::to_string(appIndex) + ".tr";
         Simulator::Schedule (Seconds (fctStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatGoodputStartEndOnly, sourceApps, sinkApps, portBase, flowNum, 0,
-          ascii.CreateFileStream (gptTrFileNameFull.c_str ()));
+          CreateTraceStream (gptTrFileNameFull.c_str ()));
       } else {
         if (long_goodput_logging) {
           std::string gptTrFileNameFull = gptTrFileName + "_app" + std::to_string(appIndex) + ".tr";
           Simulator::Schedule (Seconds (gptStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatGoodputStartEndOnly, sourceApps, sinkApps, portBase, flowNum, 0,
-            ascii.CreateFileStream (gptTrFileNameFull.c_str ()));
+            CreateTraceStream (gptTrFileNameFull.c_str ()));
         }
 
         if (fct_logging) {
           std::string fctTrFileNameFull = fctTrFileName + "_app" + std::to_string(appIndex) + ".tr";
           Simulator::Schedule (Seconds (fctStatIntervalSec+appStart+startRangeMs/1000.) + startTime, &StatFctStartEndOnly, sourceApps, portBase, flowNum, 
-            ascii.CreateFileStream (fctTrFileNameFull.c_str ()));
+            CreateTraceStream (fctTrFileNameFull.c_str ()));
         }
       }
     }
@@ -1164,7 +1194,7 @@ void InstallApp (Ptr<Node> source,
       NS_ABORT_MSG ("Unknown application type: " << appType);
     }
 
-    if (appType != "Long" && appType != "OnOff" && appType != "ConOnOff" && appType != "Burst" && appType != "BurstV2" && appType != "BurstV3" && appType != "Web" && appType != "Sized" && appType != "UDP") {
+    if (appType != "Long" && appType != "OnOff" && appType != "ConOnOff" && appType != "Burst" && appType != "BurstV2" && appType != "BurstV3" && appType != "Web" && appType != "Sized" && appType != "UDP" && appType != "Video" && appType != "Ctrl") {
       sourceApps.Start (startTime);
     }
     if (appType != "ConOnOff" && appType != "Burst" && appType != "BurstV2") {
@@ -1303,6 +1333,225 @@ std::string toStringNoTrailingZeros(const std::string& str) {
     return str.substr(0, dotPos);
 }
 
+// AnnC: optional convergence-based early termination.
+// Every ToR stat sample (statIntervalSec) feeds the tracked metrics; samples are grouped into
+// batches of convBatchSec and we stop once the batch-means CI of every metric is within tolerance.
+bool convEnabled = false;
+double convWarmupSec = 5;          // samples before this time are discarded
+double convBatchSec = 1;           // length of one batch
+uint32_t convMinBatches = 10;      // do not test before this many batches
+double convConfidence = 0.95;      // confidence level of the CI
+double convRelTolerance = 0.05;    // CI half-width must be within this fraction of the mean
+std::string convMetrics = "share_lat_thres";
+bool convStopped = false;
+double convStopSec = 0;
+std::string convStopReason = "";
+double convBatchStartSec = -1;
+
+struct ConvergenceMetric {
+  double percentile = -1;    // <0: batch mean of samples; otherwise this percentile of the batch samples
+  double absTolerance = 0;   // floor for the half-width when the mean is ~0 (e.g., an idle queue)
+  std::vector<double> batchSamples;
+  std::vector<double> batchValues;
+};
+std::map<std::string,ConvergenceMetric> convMetricMap;
+
+double ConvergenceQuantile(double confidence, uint32_t df) {
+  // two-sided normal quantile by bisection, then Cornish-Fisher correction to Student's t
+  double target = 1-(1-confidence)/2;
+  double lo = 0, hi = 10;
+  for (uint32_t i=0; i<60; i++) {
+    double mid = (lo+hi)/2;
+    if (0.5*std::erfc(-mid/std::sqrt(2.0)) < target) lo = mid; else hi = mid;
+  }
+  double z = (lo+hi)/2;
+  double v = df;
+  double z3 = z*z*z, z5 = z3*z*z, z7 = z5*z*z;
+  return z + (z3+z)/(4*v) + (5*z5+16*z3+3*z)/(96*v*v) + (3*z7+19*z5+17*z3-15*z)/(384*v*v*v);
+}
+
+void ConvergenceAddSample(std::string name, double value, double percentile, double absTolerance) {
+  if (Simulator::Now().GetSeconds() < convWarmupSec) return;
+  ConvergenceMetric &m = convMetricMap[name];
+  m.percentile = percentile;
+  m.absTolerance = absTolerance;
+  m.batchSamples.push_back(value);
+}
+
+// returns mean and CI half-width of the batch values
+std::pair<double,double> ConvergenceInterval(const ConvergenceMetric &m) {
+  uint32_t k = m.batchValues.size();
+  double mean = 0;
+  for (double x : m.batchValues) mean += x;
+  mean /= k;
+  double var = 0;
+  for (double x : m.batchValues) var += (x-mean)*(x-mean);
+  var /= (k-1);
+  return std::make_pair(mean, ConvergenceQuantile(convConfidence,k-1)*std::sqrt(var/k));
+}
+
+void ConvergenceCloseBatch() {
+  for (auto &entry : convMetricMap) {
+    ConvergenceMetric &m = entry.second;
+    if (m.batchSamples.empty()) continue;
+    double value = 0;
+    if (m.percentile < 0) {
+      for (double x : m.batchSamples) value += x;
+      value /= m.batchSamples.size();
+    } else {
+      size_t idx = std::min(m.batchSamples.size()-1, size_t(m.percentile*m.batchSamples.size()));
+      std::nth_element(m.batchSamples.begin(), m.batchSamples.begin()+idx, m.batchSamples.end());
+      value = m.batchSamples[idx];
+    }
+    m.batchValues.push_back(value);
+    m.batchSamples.clear();
+  }
+
+  if (convMetricMap.empty()) return;
+  for (const auto &entry : convMetricMap) {
+    const ConvergenceMetric &m = entry.second;
+    if (m.batchValues.size() < std::max(convMinBatches,(uint32_t)2)) return;
+    std::pair<double,double> ci = ConvergenceInterval(m);
+    if (ci.second > std::max(convRelTolerance*std::fabs(ci.first), m.absTolerance)) return;
+  }
+
+  convStopped = true;
+  convStopSec = Simulator::Now().GetSeconds();
+  convStopReason = "converged";
+  std::cout << "Convergence: all " << convMetricMap.size() << " metrics within tolerance at " << convStopSec << "s, stopping" << std::endl;
+  Simulator::Stop();
+}
+
+// AnnC: the algorithms whose per-queue threshold is Titrate's currMaxSizeAllowed
+bool HasTitrateThres(uint32_t bufferAlgorithm) {
+  return bufferAlgorithm >= MY;
+}
+
+// called once per ToR stat sample, with the same values that are written to tor.tr
+void ConvergenceRecord(uint32_t port, uint32_t priority, double sentBytes, uint32_t qSize, uint64_t maxSize, double portBwGbps, bool hasThres) {
+  if (!convEnabled || convStopped) return;
+  // queue 0 is dedicated to short control packets
+  if (priority == 0) return;
+  std::string key = "port" + std::to_string(port) + "_queue" + std::to_string(priority);
+  if (convMetrics.find("share") != std::string::npos && portBwGbps > 0) {
+    // fraction of the port bandwidth the queue sent during the sample interval
+    double share = 8.0*sentBytes/(statIntervalSec*1e9)/portBwGbps;
+    ConvergenceAddSample(key+"_share", share, -1, 0.01);
+  }
+  if (convMetrics.find("lat") != std::string::npos && portBwGbps > 0) {
+    double latUs = 8.0*qSize/(portBwGbps*1e3);
+    ConvergenceAddSample(key+"_latP50", latUs, 0.5, 1);
+    ConvergenceAddSample(key+"_latP99", latUs, 0.99, 1);
+  }
+  if (hasThres && convMetrics.find("thres") != std::string::npos) {
+    ConvergenceAddSample(key+"_thres", maxSize, -1, 1500);
+  }
+}
+
+void ConvergenceEndSample() {
+  if (!convEnabled || convStopped) return;
+  double now = Simulator::Now().GetSeconds();
+  if (now < convWarmupSec) return;
+  if (convBatchStartSec < 0) convBatchStartSec = now;
+  if (now - convBatchStartSec >= convBatchSec) {
+    convBatchStartSec = now;
+    ConvergenceCloseBatch();
+  }
+}
+
+void ConvergenceReport(std::string fileName, double stopTime) {
+  if (!convEnabled) return;
+  if (!convStopped) {
+    convStopSec = stopTime;
+    convStopReason = "horizon";
+  }
+  std::ofstream out(fileName);
+  out << "stopTime " << convStopSec << std::endl;
+  out << "reason " << convStopReason << std::endl;
+  out << "metric numBatches mean halfWidth" << std::endl;
+  for (const auto &entry : convMetricMap) {
+    const ConvergenceMetric &m = entry.second;
+    out << entry.first << " " << m.batchValues.size();
+    if (m.batchValues.size() >= 2) {
+      std::pair<double,double> ci = ConvergenceInterval(m);
+      out << " " << ci.first << " " << ci.second;
+    }
+    out << std::endl;
+  }
+  out.close();
+  std::cout << "Convergence: stopped at " << convStopSec << "s, reason=" << convStopReason << std::endl;
+}
+
+// nearest-rank percentile of a sorted sample
+double SortedPercentile(const std::vector<double> &sorted, double p) {
+  size_t rank = (size_t)std::ceil(p*sorted.size()); // 1-based
+  return sorted[std::min(std::max(rank, (size_t)1), sorted.size())-1];
+}
+
+void GameLatencyRow(std::ofstream &out, std::string name, std::vector<double> &delays, uint64_t stalls, uint64_t discarded) {
+  std::sort(delays.begin(), delays.end());
+  out << name << " " << delays.size();
+  if (delays.empty()) {
+    out << " - - - -";
+  } else {
+    out << " " << SortedPercentile(delays, 0.5) << " " << SortedPercentile(delays, 0.95) << " " << SortedPercentile(delays, 0.99) << " " << delays.back();
+  }
+  out << " " << stalls << " " << discarded << std::endl;
+}
+
+// AnnC: frame delay distribution and stalls of all Video/Ctrl receivers, for interactive traffic.
+// streamEnd is when the servers stop sending, a receiver that has decoded nothing for a while by then is stalled.
+void GameLatencyReport(std::string fileName, Time streamEnd) {
+  if (gameClients.empty()) return;
+  std::ofstream out(fileName);
+  out << "flow frames p50Ms p95Ms p99Ms maxMs stalls discarded" << std::endl;
+  std::vector<double> allDelays;
+  uint64_t allStalls = 0, allDiscarded = 0;
+  for (const auto &entry : gameClients) {
+    Ptr<VideoDecoder> decoder = entry.second->GetDecoder();
+    std::vector<double> delays;
+    for (const Time &delay : decoder->GetFrameDelays()) {
+      delays.push_back(delay.GetMicroSeconds()/1000.);
+    }
+    allDelays.insert(allDelays.end(), delays.begin(), delays.end());
+    uint32_t stalls = decoder->GetStallCount(streamEnd);
+    allStalls += stalls;
+    allDiscarded += decoder->GetDiscardedFrameCount();
+    GameLatencyRow(out, entry.first, delays, stalls, decoder->GetDiscardedFrameCount());
+  }
+  GameLatencyRow(out, "all", allDelays, allStalls, allDiscarded);
+  out.close();
+  std::cout << "Game latency: " << gameClients.size() << " flows, " << allDelays.size() << " frames";
+  if (!allDelays.empty()) {
+    std::cout << ", p50 " << SortedPercentile(allDelays, 0.5) << "ms, p95 " << SortedPercentile(allDelays, 0.95)
+              << "ms, p99 " << SortedPercentile(allDelays, 0.99) << "ms";
+  }
+  std::cout << ", " << allStalls << " stalls, " << allDiscarded << " discarded" << std::endl;
+}
+
+// AnnC: end-of-run dump of the per-class GenQueueDisc histograms, plus each queue merged over the output ports
+void DumpHistograms(std::string fileName, uint32_t nPrior) {
+  std::ofstream out(fileName);
+  out << "port queue metric count mean p50 p99 p99.9 max" << std::endl;
+  for (uint32_t port=0; port<bottleneckQueueDiscsCollection.GetN(); port++) {
+    DynamicCast<GenQueueDisc>(bottleneckQueueDiscsCollection.Get(port))->PrintHistograms(out);
+  }
+  for (uint32_t priority=0; priority<nPrior; priority++) {
+    LogLinearHistogram sojourn, occupancy;
+    for (uint32_t sink=0; sink<outputQueueDiscsCollection.GetN(); sink++) {
+      Ptr<GenQueueDisc> genDisc = DynamicCast<GenQueueDisc>(outputQueueDiscsCollection.Get(sink));
+      sojourn.Merge(genDisc->GetSojournHistogram(priority));
+      occupancy.Merge(genDisc->GetOccupancyHistogram(priority));
+    }
+    out << "sinks " << priority << " sojournNs ";
+    sojourn.PrintSummary(out);
+    out << std::endl << "sinks " << priority << " occupancyBytes ";
+    occupancy.PrintSummary(out);
+    out << std::endl;
+  }
+  out.close();
+}
+
 void InvokeToRStats(Ptr<OutputStreamWrapper> stream, uint32_t BufferSize, uint32_t nPrior, uint32_t bufferAlgorithm){
 	double nanodelay = statIntervalSec*1e9;
   int64_t currentNanoSeconds = Simulator::Now().GetNanoSeconds();
@@ -1326,16 +1575,20 @@ void InvokeToRStats(Ptr<OutputStreamWrapper> stream, uint32_t BufferSize, uint32
 			uint64_t maxSize = 0;
       if (bufferAlgorithm == DT) {
         maxSize = genDisc->GetAlpha(priority)*remaining;
-      } else if (bufferAlgorithm == MY) {
-        uint32_t proberId = sharedMemory->getProberId(port, priority);
-        maxSize = sharedMemory->getCurrMaxSizeAllowed(proberId);
+      } else if (HasTitrateThres(bufferAlgorithm)) {
+        // AnnC: use the port's own buffer, each switch has one in the leaf-spine topology
+        Ptr<SharedMemoryBuffer> portBuffer = genDisc->GetSharedMemory();
+        uint32_t proberId = portBuffer->getProberId(genDisc->getPortId(), priority);
+        maxSize = portBuffer->getCurrMaxSizeAllowed(proberId);
       } else {
         std::cout << "InvokeToRStats has not implemented for bufferAlgorithm " << bufferAlgorithm << std::endl;
       }
 			*stream->GetStream() << " " << qSize << " " << th << " " << sentBytes << " " << droppedBytes << " " << maxSize;
+      ConvergenceRecord(port, priority, sentBytes, qSize, maxSize, genDisc->getPortBw(), HasTitrateThres(bufferAlgorithm));
 		}
 	}
 	*stream->GetStream() << std::endl;
+  ConvergenceEndSample();
 
 	Simulator::Schedule(Seconds(statIntervalSec), InvokeToRStats, stream, BufferSize, nPrior, bufferAlgorithm);
 }
@@ -1406,16 +1659,20 @@ void InvokeToRStatsSinkOnly(Ptr<OutputStreamWrapper> stream, uint32_t BufferSize
         uint64_t maxSize = 0;
         if (bufferAlgorithm == DT) {
           maxSize = genDisc->GetAlpha(priority)*remaining;
-        } else if (bufferAlgorithm >= MY) {
-          uint32_t proberId = sharedMemory->getProberId(port, priority);
-          maxSize = sharedMemory->getCurrMaxSizeAllowed(proberId);
+        } else if (HasTitrateThres(bufferAlgorithm)) {
+          // AnnC: use the port's own buffer, each switch has one in the leaf-spine topology
+          Ptr<SharedMemoryBuffer> portBuffer = genDisc->GetSharedMemory();
+          uint32_t proberId = portBuffer->getProberId(genDisc->getPortId(), priority);
+          maxSize = portBuffer->getCurrMaxSizeAllowed(proberId);
         } else {
           std::cout << "InvokeToRStatsSinkOnly has not implemented for bufferAlgorithm " << bufferAlgorithm << std::endl;
         }
         *stream->GetStream() << " " << qSize << " " << th << " " << sentBytes << " " << droppedBytes << " " << maxSize;
+        ConvergenceRecord(port, priority, sentBytes, qSize, maxSize, genDisc->getPortBw(), HasTitrateThres(bufferAlgorithm));
       }
     }
     *stream->GetStream() << std::endl;
+    ConvergenceEndSample();
   // }
 
 	Simulator::Schedule(Seconds(statIntervalSec), InvokeToRStatsSinkOnly, stream, BufferSize, nPrior, bufferAlgorithm, numSinks, queueDiscType);
@@ -1432,7 +1689,6 @@ void DeltaBandwidth(Ptr<Node> node, float dbwSecond, std::string dbwMbps, uint32
 }
 
 Ptr<OutputStreamWrapper> torStats;
-AsciiTraceHelper torTraceHelper;
 
 // double alpha_values[8]={1};
 
@@ -1485,6 +1741,7 @@ int main (int argc, char *argv[]) {
   uint32_t bufferSize = 25000; // in bytes
   uint32_t bufferAlgorithm = MY;
   uint32_t burstReserve = 0;
+  uint32_t waterFillUs = 0;
 
   uint32_t startProbeBuffer = 1500;
 
@@ -1556,6 +1813,7 @@ int main (int argc, char *argv[]) {
   // cmd.AddValue ("sinkAalpha", "alpha value for sinkA (for DT 101)", sinkAalpha);
   // cmd.AddValue ("sinkBalpha", "alpha value for sinkB (for DT 101)", sinkBalpha);
   cmd.AddValue ("burstReserve", "The amount of buffer reserved for future burst (for MY 111)", burstReserve);
+  cmd.AddValue ("waterFillUs", "Window in us of the water-filling buffer allocator, 0 to grant buffer first come, first served (for MY 111)", waterFillUs);
 
   cmd.AddValue ("startProbeBuffer", "The amount of buffer (in bytes) given when we first start probing; this is a temporary variable", startProbeBuffer);
 
@@ -1664,6 +1922,52 @@ int main (int argc, char *argv[]) {
   cmd.AddValue ("ParDecreaseRatio", "", ParDecreaseRatio);
   cmd.AddValue ("ParExploreThres", "", ParExploreThres);
 
+  double branchAt = 0;
+  std::string branchFile = "";
+  uint32_t branchJobs = 0;
+  cmd.AddValue ("branchAt", "Simulate up to this time (in s) once, then fork one branch per line of branchFile", branchAt);
+  cmd.AddValue ("branchFile", "One branch per line, given as the Par* and burstReserve options it overrides, eg, '--ParExploreThres=5 --ParIncreaseRatio=20'", branchFile);
+  cmd.AddValue ("branchJobs", "How many branches run at once, 0 to fit them in the available memory", branchJobs);
+
+  cmd.AddValue ("convEnabled", "Stop the simulation early once the tracked metrics have converged", convEnabled);
+  cmd.AddValue ("convWarmup", "Warm-up in seconds before convergence samples are collected", convWarmupSec);
+  cmd.AddValue ("convBatch", "Batch length in seconds for batch-means confidence intervals", convBatchSec);
+  cmd.AddValue ("convMinBatches", "Minimum number of batches before testing for convergence", convMinBatches);
+  cmd.AddValue ("convConfidence", "Confidence level of the batch-means confidence intervals, eg, 0.95", convConfidence);
+  cmd.AddValue ("convRelTolerance", "Maximum CI half-width relative to the mean, eg, 0.05", convRelTolerance);
+  cmd.AddValue ("convMetrics", "Metrics to track, any of share (fraction of the port bandwidth),lat,thres, eg, 'share_lat_thres'", convMetrics);
+
+  bool useEcn = false;
+  double ecnHardDropRatio = 2;
+  cmd.AddValue ("useEcn", "Mark instead of drop above currMaxSizeAllowed (for MY 111), and enable ECN on the TCP senders", useEcn);
+  cmd.AddValue ("ecnHardDropRatio", "With useEcn, still drop once the queue exceeds this multiple of currMaxSizeAllowed", ecnHardDropRatio);
+  double ecnMarkRatio = 0.5;
+  cmd.AddValue ("ecnMarkRatio", "With useEcn, also mark once the queue exceeds this fraction of currMaxSizeAllowed, 1 to mark only above it", ecnMarkRatio);
+  bool trimOnDrop = false;
+  cmd.AddValue ("trimOnDrop", "NDP-style trimming: enqueue the headers of packets the buffer management drops", trimOnDrop);
+
+  std::string topology = "star";
+  uint32_t numLeaves = 2;
+  uint32_t numSpines = 2;
+  std::string fabricBw = "1000";
+  std::string fabricDelay = "0.01";
+  cmd.AddValue ("topology", "star: all ports on a single buffer node; leafspine: hosts spread over leaves, each leaf connected to every spine", topology);
+  cmd.AddValue ("numLeaves", "Number of leaf switches (leafspine)", numLeaves);
+  cmd.AddValue ("numSpines", "Number of spine switches (leafspine)", numSpines);
+  cmd.AddValue ("fabricBw", "Leaf-spine link bandwidth in Mbps (leafspine)", fabricBw);
+  cmd.AddValue ("fabricDelay", "Leaf-spine link delay in ms (leafspine)", fabricDelay);
+
+  bool histEnabled = false;
+  cmd.AddValue ("histEnabled", "Record per-class sojourn time and queue occupancy histograms in GenQueueDisc", histEnabled);
+  bool fullPacketMetadata = false;
+  cmd.AddValue ("fullPacketMetadata", "Record the full packet metadata (Packet::EnablePrinting) instead of only the TCP and IPv4 headers that GenQueueDisc needs", fullPacketMetadata);
+  bool headerCache = false;
+  cmd.AddValue ("headerCache", "Keep decoded IPv4 and TCP headers on packets, so that the next layers and hops do not deserialize them again", headerCache);
+  bool sharedPacing = false;
+  cmd.AddValue ("sharedPacing", "Pace the TCP sockets of a node (BBR, Copa) with one pacing scheduler instead of a timer per socket", sharedPacing);
+  double groTimeoutUs = 0;
+  cmd.AddValue ("groTimeoutUs", "Coalesce the in-order TCP segments received by the sinks (GRO), holding each for up to this many microseconds; 0 disables it", groTimeoutUs);
+
   cmd.Parse (argc, argv);
 
   // uint32_t nPrior = headRoomNumQueues + mainRoomNumQueues + 1;
@@ -1963,9 +2267,20 @@ int main (int argc, char *argv[]) {
   if (bufferAlgorithm == DT) {
     // conf += "_" + std::to_string((uint16_t)sinkAalpha) + "_" + std::to_string((uint16_t)sinkBalpha);
     conf += "_" + alphaString;
-  } else if (bufferAlgorithm >= MY) {
-    conf += "_" + std::to_string(burstReserve);
   }
+  // AnnC: the parts of conf a branch can change, rebuilt by the branch
+  auto reserveTag = [&] () {
+    if (bufferAlgorithm < MY) return std::string("");
+    return "_" + std::to_string(burstReserve) + (waterFillUs > 0 ? "_wf" + std::to_string(waterFillUs) : "");
+  };
+  auto parTag = [&] () {
+    return std::to_string(ParHistLen) + "_" + std::to_string(ParRemoveStartLen) + "_" + std::to_string(ParRemoveStartThres) + "_" + std::to_string(ParExploreThres) + "_" + std::to_string(ParSafeThres)
+    + "_" + std::to_string(ParConsecIncreaseThres) + "_" + std::to_string(ParStepIncreaseCap) + "_" + std::to_string(ParIncreaseRatio)
+    + "_" + std::to_string(ParConsecDecreaseThres) + "_" + std::to_string(ParStepDecreaseCap) + "_" + std::to_string(ParDecreaseRatio)
+    + "_" + std::to_string(ParMinQOutlier) + "_" + std::to_string(ParMinQHold);
+  };
+  size_t confReservePos = conf.size();
+  conf += reserveTag();
   // if (queueDiscType == "Dwrr") {
   //   conf += "_" + std::to_string (dwrrPrioRatio).substr (0, 4);
   // } else if (queueDiscType == "Auto") {
@@ -2017,10 +2332,9 @@ int main (int argc, char *argv[]) {
 
   conf += "/" + toStringNoTrailingZeros(std::to_string(dropRateThreshold)) + "_" + std::to_string(monitorlongms) + "_" + adaptiveIncreaseParameterString + "_" + adaptiveDecreaseParameterString; // toStringNoTrailingZeros(std::to_string(adaptiveIncreaseParameter)) + "_" + toStringNoTrailingZeros(std::to_string(adaptiveDecreaseParameter));
 
-  conf += "/" + std::to_string(ParHistLen) + "_" + std::to_string(ParRemoveStartLen) + "_" + std::to_string(ParRemoveStartThres) + "_" + std::to_string(ParExploreThres) + "_" + std::to_string(ParSafeThres)
-  + "_" + std::to_string(ParConsecIncreaseThres) + "_" + std::to_string(ParStepIncreaseCap) + "_" + std::to_string(ParIncreaseRatio)
-  + "_" + std::to_string(ParConsecDecreaseThres) + "_" + std::to_string(ParStepDecreaseCap) + "_" + std::to_string(ParDecreaseRatio)
-  + "_" + std::to_string(ParMinQOutlier) + "_" + std::to_string(ParMinQHold);
+  conf += "/";
+  size_t confParPos = conf.size();
+  conf += parTag();
 
   conf += "/" + std::to_string(smoothQlenCollectionByUs) + "_" + std::to_string(smoothWindowByNumData) + "_" + std::to_string(smoothOutlierThresholdByMultiple);
 
@@ -2193,7 +2507,7 @@ int main (int argc, char *argv[]) {
     }
   }
 
-  torStats = torTraceHelper.CreateFileStream (torOutFile);
+  torStats = CreateTraceStream (torOutFile);
 	*torStats->GetStream ()
 	<< "time "
 	<< "bufferSizeMB "
@@ -2248,6 +2562,7 @@ int main (int argc, char *argv[]) {
   // Config::SetDefault ("ns3::TcpSocketBase::RTO", TimeValue (MicroSeconds (1000000)) );
   Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (1));
   Config::SetDefault ("ns3::TcpCopa::ModeSwitch", BooleanValue (false));
+  Config::SetDefault ("ns3::TcpL4Protocol::SharedPacing", BooleanValue (sharedPacing));
   Config::SetDefault ("ns3::PacketTcpSender::SockBufDutyRatio", DoubleValue (sockBufDutyRatio));
   Config::SetDefault ("ns3::FifoQueueDisc::MaxSize", StringValue (std::to_string(queueDiscSize) + "p"));
   // Config::SetDefault ("ns3::PfifoFastQueueDisc::MaxSize", StringValue (std::to_string(queueDiscSize) + "p"));
@@ -2257,6 +2572,14 @@ int main (int argc, char *argv[]) {
   Config::SetDefault("ns3::GenQueueDisc::nPrior", UintegerValue(nPrior));
   Config::SetDefault("ns3::GenQueueDisc::RoundRobin", UintegerValue(1));
   Config::SetDefault("ns3::GenQueueDisc::StrictPriority", UintegerValue(0));
+  Config::SetDefault("ns3::GenQueueDisc::EnableHistograms", BooleanValue(histEnabled));
+  Config::SetDefault("ns3::GenQueueDisc::UseEcn", BooleanValue(useEcn));
+  Config::SetDefault("ns3::GenQueueDisc::EcnHardDropRatio", DoubleValue(ecnHardDropRatio));
+  Config::SetDefault("ns3::GenQueueDisc::EcnMarkRatio", DoubleValue(ecnMarkRatio));
+  Config::SetDefault("ns3::GenQueueDisc::TrimOnDrop", BooleanValue(trimOnDrop));
+  if (useEcn) {
+    Config::SetDefault ("ns3::TcpSocketBase::UseEcn", StringValue ("On"));
+  }
 
   // Config::SetDefault ("ns3::TcpSocket::ConnTimeout", TimeValue (MilliSeconds (10))); // syn retry interval
   // uint32_t BDP = aRTTms * aMidBw/(nPrior-1) / 8.0 *1000;
@@ -2271,17 +2594,31 @@ int main (int argc, char *argv[]) {
   // Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (0));
   // Config::SetDefault ("ns3::TcpSocket::PersistTimeout", TimeValue (Seconds (20)));
 
-  sharedMemory = CreateObject<SharedMemoryBuffer>();
-	sharedMemory->SetAttribute("BufferSize",UintegerValue(bufferSize));
-	sharedMemory->SetSharedBufferSize(bufferSize);
-  
   // Create gateway, source, and sink
   NodeContainer sinksNodes, bufferNodes;
   std::vector<NodeContainer> sendersNodesArray;
   // sendersANodes.Create(numSendersA);
   // sendersBNodes.Create(numSendersB);
   sinksNodes.Create(numSinks);
-  bufferNodes.Create(1);
+  NodeContainer leafNodes, spineNodes;
+  if (topology.compare("star")==0) {
+    bufferNodes.Create(1);
+    // AnnC: the leaf-spine fabric creates one buffer per switch and points sharedMemory at one of them
+    sharedMemory = CreateObject<SharedMemoryBuffer>();
+    sharedMemory->SetAttribute("BufferSize",UintegerValue(bufferSize));
+    sharedMemory->SetSharedBufferSize(bufferSize);
+  } else if (topology.compare("leafspine")==0) {
+    leafNodes.Create(numLeaves);
+    spineNodes.Create(numSpines);
+    Config::SetDefault ("ns3::Ipv4GlobalRouting::FlowEcmpRouting", BooleanValue(true));
+    if (deltaBwConfigFile.compare("")!=0) {
+      std::cerr << "deltaBwConfigFile is only supported in the star topology" << std::endl;
+      return 1;
+    }
+  } else {
+    std::cerr << "Unknown topology: " << topology << std::endl;
+    return 1;
+  }
   for (uint32_t sink=0; sink<numSinks; sink++) {
     NodeContainer sendersNodesThisSink;
     sendersNodesThisSink.Create(numSendersArray[sink]);
@@ -2316,6 +2653,13 @@ int main (int argc, char *argv[]) {
 
   InternetStackHelper stack;
   stack.InstallAll ();
+  if (groTimeoutUs > 0) {
+    // AnnC: only the sinks receive data; the senders receive ACKs only
+    Config::SetDefault ("ns3::TcpGro::Timeout", TimeValue (MicroSeconds (groTimeoutUs)));
+    for (uint32_t sink=0; sink<numSinks; sink++) {
+      sinksNodes.Get (sink)->GetObject<TcpL4Protocol> ()->SetAttribute ("Gro", BooleanValue (true));
+    }
+  }
 
   Ipv4AddressHelper address;
   address.SetBase ("10.0.0.0", "255.255.255.0");
@@ -2432,6 +2776,7 @@ int main (int argc, char *argv[]) {
 	// 	address.Assign (devices); // only useful for sinks
   // }
 
+  if (topology.compare("star")==0) {
   for (uint32_t sink=0; sink<numSinks; sink++) {
     for (uint32_t sender=0; sender<sendersNodesArray[sink].GetN(); sender++) {
       PointToPointHelper senderSrcLink;
@@ -2580,6 +2925,99 @@ int main (int argc, char *argv[]) {
     address.Assign (devices); // not even for sinks
   }
   std::cout << "Finish setting up output ports" << std::endl;
+  } else {
+    // AnnC: leaf-spine fabric. Hosts (sinks first, then senders in app config order) are spread
+    // round-robin over the leaves, and every leaf connects to every spine. Each switch has its
+    // own SharedMemoryBuffer and a GenQueueDisc on every egress port; portids are per switch.
+    std::vector<Ptr<SharedMemoryBuffer>> switchBuffers;
+    std::vector<uint32_t> switchNumPorts(numLeaves+numSpines, 0);
+    for (uint32_t sw=0; sw<numLeaves+numSpines; sw++) {
+      Ptr<SharedMemoryBuffer> sm = CreateObject<SharedMemoryBuffer>();
+      sm->SetAttribute("BufferSize",UintegerValue(bufferSize));
+      sm->SetSharedBufferSize(bufferSize);
+      switchBuffers.push_back(sm);
+    }
+    // the global sharedMemory (used for occupiedBufferPct in tor.tr) is the buffer of sink 0's leaf
+    sharedMemory = switchBuffers[0];
+
+    // sink is only used to pick the per-output-port parameters (inc/dec/alpha)
+    auto setUpGenDisc = [&](Ptr<QueueDisc> qdisc, uint32_t sw, std::string bwMbps, uint32_t sink) {
+      Ptr<GenQueueDisc> genDisc = DynamicCast<GenQueueDisc> (qdisc);
+      genDisc->SetPortId(switchNumPorts[sw]++);
+      genDisc->setNPrior(nPrior);
+      genDisc->setPortBw(MbpsStringToGbpsDouble(bwMbps+"Mbps"));
+      genDisc->setTargetBw(targetBW);
+      genDisc->setParameters(ParHistLen,ParRemoveStartLen,ParRemoveStartThres,ParExploreThres,ParSafeThres,ParConsecIncreaseThres,ParStepIncreaseCap,ParIncreaseRatio,ParConsecDecreaseThres,ParStepDecreaseCap,ParDecreaseRatio,ParMinQOutlier,ParMinQHold);
+      genDisc->SetSharedMemory(switchBuffers[sw]);
+      genDisc->SetBufferAlgorithm(bufferAlgorithm);
+      genDisc->setMainRoomQueueScheme(mainRoomQueueScheme);
+      genDisc->setMainRoomNumQueues(mainRoomNumQueues);
+      genDisc->setProbingStats(startProbeBuffer,monitorlongms,dropRateThreshold,incArray[sink],decArray[sink],smoothQlenCollectionByUs,smoothWindowByNumData,smoothOutlierThresholdByMultiple,pawMode);
+      genDisc->setUpTrackingStats(nPrior);
+      for(uint32_t n=0;n<nPrior;n++){
+        genDisc->alphas[n] = alphaArray.size()>0 ? alphaArray[sink] : 8;
+      }
+      for (const auto& entry : fvThresVec) {
+        genDisc->insertIntoFixedVaryThresVec(entry.first,entry.second);
+      }
+    };
+
+    uint32_t hostIndex = 0;
+    QueueDiscContainer sinkQueueDiscs;
+    for (uint32_t sink=0; sink<numSinks; sink++) {
+      uint32_t leaf = (hostIndex++) % numLeaves;
+      NetDeviceContainer devices = senderMidLinkArray[sink].Install(leafNodes.Get(leaf), sinksNodes.Get(sink));
+      QueueDiscContainer queuediscs = tc.Install(devices.Get(0)); // queuedisc on the leaf
+      setUpGenDisc(queuediscs.Get(0), leaf, midBwArray[sink], sink);
+      sinkQueueDiscs.Add(queuediscs.Get(0));
+      address.NewNetwork ();
+      address.Assign (devices);
+    }
+    for (uint32_t sink=0; sink<numSinks; sink++) {
+      for (uint32_t sender=0; sender<sendersNodesArray[sink].GetN(); sender++) {
+        uint32_t leaf = (hostIndex++) % numLeaves;
+        PointToPointHelper senderSrcLink;
+        senderSrcLink.SetDeviceAttribute ("DataRate", StringValue (srcBwArray[sink]+"Mbps"));
+        senderSrcLink.SetChannelAttribute ("Delay", StringValue (std::to_string(sendersSrcLinkRatesArray[sink][sender]) + "ms"));
+        NetDeviceContainer devices = senderSrcLink.Install(leafNodes.Get(leaf), sendersNodesArray[sink].Get(sender));
+        QueueDiscContainer queuediscs = tc.Install(devices.Get(0)); // queuedisc on the leaf, towards the sender
+        setUpGenDisc(queuediscs.Get(0), leaf, srcBwArray[sink], sink);
+        bottleneckQueueDiscsCollection.Add(queuediscs.Get(0));
+        address.NewNetwork ();
+        address.Assign (devices);
+      }
+    }
+    PointToPointHelper fabricLink;
+    fabricLink.SetDeviceAttribute ("DataRate", StringValue (fabricBw+"Mbps"));
+    fabricLink.SetChannelAttribute ("Delay", StringValue (fabricDelay+"ms"));
+    for (uint32_t leaf=0; leaf<numLeaves; leaf++) {
+      for (uint32_t spine=0; spine<numSpines; spine++) {
+        NetDeviceContainer devices = fabricLink.Install(leafNodes.Get(leaf), spineNodes.Get(spine));
+        QueueDiscContainer queuediscs = tc.Install(devices);
+        setUpGenDisc(queuediscs.Get(0), leaf, fabricBw, 0);
+        setUpGenDisc(queuediscs.Get(1), numLeaves+spine, fabricBw, 0);
+        bottleneckQueueDiscsCollection.Add(queuediscs.Get(0));
+        bottleneckQueueDiscsCollection.Add(queuediscs.Get(1));
+        address.NewNetwork ();
+        address.Assign (devices);
+      }
+    }
+    // sink-facing ports go last, in sink order, as InvokeToRStatsSinkOnly expects
+    for (uint32_t sink=0; sink<numSinks; sink++) {
+      bottleneckQueueDiscsCollection.Add(sinkQueueDiscs.Get(sink));
+      outputQueueDiscsCollection.Add(sinkQueueDiscs.Get(sink));
+    }
+
+    for (uint32_t sw=0; sw<numLeaves+numSpines; sw++) {
+      switchBuffers[sw]->SetAttribute("BurstReserve",UintegerValue(burstReserve));
+      switchBuffers[sw]->SetAttribute("WaterFillInterval",TimeValue(MicroSeconds(waterFillUs)));
+      switchBuffers[sw]->setUp(switchNumPorts[sw], nPrior, randomSeed, 0, mainRoomNumQueues);
+      Ptr<Node> switchNode = sw<numLeaves ? leafNodes.Get(sw) : spineNodes.Get(sw-numLeaves);
+      Ptr<Ipv4GlobalRouting> routing = Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting> (switchNode->GetObject<Ipv4> ()->GetRoutingProtocol ());
+      routing->SetEcmpHashCallback (MakeBoundCallback (&EcmpHash, switchNode->GetId ()));
+    }
+    std::cout << "Finish setting up leaf-spine: " << numLeaves << " leaves, " << numSpines << " spines, " << hostIndex << " hosts" << std::endl;
+  }
 
   if (deltaBwConfigFile.compare("")!=0) {
     std::ifstream deltaBwConfigStream(deltaBwConfigFile);
@@ -2600,7 +3038,9 @@ int main (int argc, char *argv[]) {
     deltaBwConfigStream.close();
   }
   
+  if (topology.compare("star")==0) {
   sharedMemory->SetAttribute("BurstReserve",UintegerValue(burstReserve));
+  sharedMemory->SetAttribute("WaterFillInterval",TimeValue(MicroSeconds(waterFillUs)));
   double smallestRTTms = 0;
   // if (aRTTms == 0) {
   //   smallestRTTms = bRTTms;
@@ -2615,6 +3055,7 @@ int main (int argc, char *argv[]) {
     myNumPorts += sendersNodesArray[sink].GetN();
   }
   sharedMemory->setUp(myNumPorts, nPrior, randomSeed, smallestRTTms, mainRoomNumQueues);
+  }
 
   // NetDeviceContainer devicesSrcLink, devicesDstLink, devicesMidLink;
 
@@ -2659,6 +3100,7 @@ int main (int argc, char *argv[]) {
   uint32_t portBase = 1000;
   uint32_t sender_id = 0;
   uint32_t random_seed = randomSeed;
+  auto appsWallStart = std::chrono::steady_clock::now();
   // for (uint32_t senderA=0; senderA<sendersANodes.GetN(); senderA++) {
   //   std::string appTrFileName = appTrFileNamePrefix + "_sender" + std::to_string(sender_id) + ".tr";
   //   std::string bwTrFileName = bwTrFileNamePrefix + "_sender" + std::to_string(sender_id) + ".tr";
@@ -2696,7 +3138,8 @@ int main (int argc, char *argv[]) {
       random_seed++;
     }
   }
-  std::cout << "Finish setting up apps" << std::endl;
+  double appsWallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - appsWallStart).count();
+  std::cout << "Finish setting up apps: " << flowHash.size() << " flows in " << appsWallSec << "s" << std::endl;
 
   Ptr<FlowMonitor> flowMonitor;
   FlowMonitorHelper flowHelper;
@@ -2728,13 +3171,22 @@ int main (int argc, char *argv[]) {
     Simulator::Schedule(MicroSeconds (10),&InvokeToRStats,torStats, bufferSize, nPrior, bufferAlgorithm);
   }
   
-  AsciiTraceHelper ascii;
-  Packet::EnablePrinting ();
+  // AnnC: MyBM finds the TcpHeader through the packet metadata; recording only TCP/IPv4 headers keeps
+  // the per-packet metadata bounded instead of growing a list for every packet
+  if (fullPacketMetadata) {
+    Packet::EnablePrinting ();
+  } else {
+    Packet::EnableSelectivePrinting (TcpHeader::GetTypeId ());
+    Packet::EnableSelectivePrinting (Ipv4Header::GetTypeId ());
+  }
+  if (headerCache) {
+    Packet::EnableHeaderCache ();
+  }
   for (uint32_t port=0; port<bottleneckQueueDiscsCollection.GetN(); port++) {
     std::string dropTrFileName = dropTrFileNamePrefix + "_port" + std::to_string(port) + ".tr";
     Ptr<GenQueueDisc> qdisc = DynamicCast<GenQueueDisc>(bottleneckQueueDiscsCollection.Get(port));
     if (!light_logging) {
-      Simulator::Schedule (MicroSeconds (10), &TraceQdiscDrop, qdisc, ascii.CreateFileStream (dropTrFileName));
+      Simulator::Schedule (MicroSeconds (10), &TraceQdiscDrop, qdisc, CreateTraceStream (dropTrFileName));
     }
   }
 
@@ -2742,7 +3194,7 @@ int main (int argc, char *argv[]) {
     std::string qdiscTrFileName = qdiscTrFileNamePrefix + "_port" + std::to_string(port) + ".tr";
     Ptr<GenQueueDisc> q = DynamicCast<GenQueueDisc>(bottleneckQueueDiscsCollection.Get(port));
     if (!light_logging) {
-      Simulator::Schedule (Seconds(statIntervalSec + 1), &StatQdisc, q, queueDiscType, ascii.CreateFileStream (qdiscTrFileName));
+      Simulator::Schedule (Seconds(statIntervalSec + 1), &StatQdisc, q, queueDiscType, CreateTraceStream (qdiscTrFileName));
     }
   }
   // Simulator::Schedule (MicroSeconds (10), &TraceQdiscDrop, qdiscs.Get (0), ascii.CreateFileStream (dropTrFileName));
@@ -2757,11 +3209,147 @@ int main (int argc, char *argv[]) {
   RngSeedManager::SetSeed (randomSeed);
 
   Simulator::Stop (Seconds (stopTime));
+  auto wallStart = std::chrono::steady_clock::now();
+  bool branchFailed = false;
+  if (branchFile != "" && branchAt > 0) {
+    // AnnC: simulate the shared warm-up once, then fork a child per branch that continues with its own
+    // overrides and output directory; the parent waits for them and finishes with its own options
+    std::vector<std::string> branches;
+    std::ifstream branchStream(branchFile);
+    NS_ABORT_MSG_UNLESS (branchStream.is_open(), "Error opening file: " << branchFile);
+    std::string branchLine;
+    while (std::getline(branchStream, branchLine)) {
+      if (branchLine.find_first_not_of(" \t") != std::string::npos) branches.push_back(branchLine);
+    }
+    branchStream.close();
+
+    auto parseBranch = [&] (const std::string &line) {
+      std::vector<std::string> branchArgs(1, argv[0]);
+      std::stringstream branchTokens(line);
+      std::string token;
+      while (branchTokens >> token) branchArgs.push_back(token);
+      CommandLine branchCmd;
+      branchCmd.AddValue ("ParHistLen", "", ParHistLen);
+      branchCmd.AddValue ("ParRemoveStartLen", "", ParRemoveStartLen);
+      branchCmd.AddValue ("ParRemoveStartThres", "", ParRemoveStartThres);
+      branchCmd.AddValue ("ParSafeThres", "", ParSafeThres);
+      branchCmd.AddValue ("ParConsecIncreaseThres", "", ParConsecIncreaseThres);
+      branchCmd.AddValue ("ParStepIncreaseCap", "", ParStepIncreaseCap);
+      branchCmd.AddValue ("ParConsecDecreaseThres", "", ParConsecDecreaseThres);
+      branchCmd.AddValue ("ParStepDecreaseCap", "", ParStepDecreaseCap);
+      branchCmd.AddValue ("ParMinQOutlier", "", ParMinQOutlier);
+      branchCmd.AddValue ("ParMinQHold", "", ParMinQHold);
+      branchCmd.AddValue ("ParIncreaseRatio", "", ParIncreaseRatio);
+      branchCmd.AddValue ("ParDecreaseRatio", "", ParDecreaseRatio);
+      branchCmd.AddValue ("ParExploreThres", "", ParExploreThres);
+      branchCmd.AddValue ("burstReserve", "", burstReserve);
+      branchCmd.Parse (branchArgs);
+    };
+
+    // AnnC: work out every output directory before the warm-up, two branches must not write to the same one
+    std::vector<std::string> branchConfs;
+    std::string branchMarker = "_br" + toStringNoTrailingZeros(std::to_string(branchAt));
+    for (uint32_t b=0; b<branches.size(); b++) {
+      auto saved = std::make_tuple(ParHistLen, ParRemoveStartLen, ParRemoveStartThres, ParSafeThres, ParConsecIncreaseThres, ParStepIncreaseCap,
+                                   ParConsecDecreaseThres, ParStepDecreaseCap, ParMinQOutlier, ParMinQHold, ParIncreaseRatio, ParDecreaseRatio,
+                                   ParExploreThres, burstReserve);
+      std::string oldReserveTag = reserveTag();
+      std::string oldParTag = parTag();
+      parseBranch(branches[b]);
+      std::string branchConf = conf;
+      branchConf.replace(confParPos, oldParTag.size(), parTag());
+      branchConf.replace(confReservePos, oldReserveTag.size(), reserveTag());
+      std::tie(ParHistLen, ParRemoveStartLen, ParRemoveStartThres, ParSafeThres, ParConsecIncreaseThres, ParStepIncreaseCap,
+               ParConsecDecreaseThres, ParStepDecreaseCap, ParMinQOutlier, ParMinQHold, ParIncreaseRatio, ParDecreaseRatio,
+               ParExploreThres, burstReserve) = saved;
+      NS_ABORT_MSG_IF (branchConf == conf, "Branch " << b << " has the same options as the warm-up run: " << branches[b]);
+      branchConf += branchMarker;
+      for (uint32_t other=0; other<b; other++) {
+        NS_ABORT_MSG_IF (branchConfs[other] == branchConf, "Branches " << other << " and " << b << " have the same options: "
+                         << branches[other] << " and " << branches[b]);
+      }
+      branchConfs.push_back(branchConf);
+    }
+
+    Simulator::Stop (Seconds (branchAt));
+    Simulator::Run ();
+    FlushTraceStreams ();
+    uint32_t slots = branchJobs > 0 ? branchJobs : BranchSlots ();
+    std::cout << "Branching at " << branchAt << "s into " << branches.size() << " branches, " << slots << " at a time" << std::endl;
+
+    bool isBranch = false;
+    std::map<pid_t, uint32_t> running; // pid -> branch
+    std::vector<uint32_t> failed;
+    auto reap = [&] () {
+      int status;
+      pid_t pid = wait(&status);
+      if (pid < 0) return;
+      uint32_t b = running[pid];
+      running.erase(pid);
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0) return;
+      failed.push_back(b);
+      if (WIFSIGNALED(status)) {
+        std::cerr << "Branch " << b << " (pid " << pid << ") killed by signal " << WTERMSIG(status) << ": " << branches[b] << std::endl;
+      } else {
+        std::cerr << "Branch " << b << " (pid " << pid << ") exited with status " << WEXITSTATUS(status) << ": " << branches[b] << std::endl;
+      }
+    };
+    for (uint32_t b=0; b<branches.size() && !isBranch; b++) {
+      if (running.size() == slots) {
+        reap();
+      }
+      std::cout.flush();
+      std::cerr.flush();
+      pid_t pid = fork();
+      NS_ABORT_MSG_IF (pid < 0, "Unable to fork branch " << b);
+      if (pid > 0) {
+        running[pid] = b;
+        continue;
+      }
+      isBranch = true;
+
+      parseBranch(branches[b]);
+      std::set<Ptr<SharedMemoryBuffer>> buffers;
+      for (uint32_t port=0; port<bottleneckQueueDiscsCollection.GetN(); port++) {
+        Ptr<GenQueueDisc> genDisc = DynamicCast<GenQueueDisc>(bottleneckQueueDiscsCollection.Get(port));
+        genDisc->setParameters(ParHistLen,ParRemoveStartLen,ParRemoveStartThres,ParExploreThres,ParSafeThres,ParConsecIncreaseThres,ParStepIncreaseCap,ParIncreaseRatio,ParConsecDecreaseThres,ParStepDecreaseCap,ParDecreaseRatio,ParMinQOutlier,ParMinQHold);
+        buffers.insert(genDisc->GetSharedMemory());
+      }
+      for (Ptr<SharedMemoryBuffer> buffer : buffers) {
+        buffer->SetAttribute("BurstReserve",UintegerValue(burstReserve));
+      }
+
+      fs::create_directories(dir + branchConfs[b]);
+      MoveTraceStreams(dir + conf, dir + branchConfs[b]);
+      conf = branchConfs[b];
+      std::cout << "Branch " << b << " (pid " << getpid() << "): " << branches[b] << " -> " << dir + conf << std::endl;
+    }
+    if (!isBranch) {
+      while (!running.empty()) {
+        reap();
+      }
+      if (!failed.empty()) {
+        std::sort(failed.begin(), failed.end());
+        std::cerr << failed.size() << " of " << branches.size() << " branches failed:";
+        for (uint32_t b : failed) std::cerr << " " << b;
+        std::cerr << std::endl;
+        branchFailed = true;
+      }
+    }
+  }
   Simulator::Run ();
+  double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  std::cout << "Simulator events: " << Simulator::GetEventCount() << ", wallclock " << wallSec << "s, "
+            << Simulator::GetEventCount()/wallSec << " events/s" << std::endl;
 
   flowMonitor->SerializeToXmlFile(dir + conf + "/flowmonitor.xml", true, true);
+  ConvergenceReport(dir + conf + "/convergence.tr", stopTime);
+  GameLatencyReport(dir + conf + "/game.tr", Seconds(stopTime - 2)); // the sourceApps stop time
+  if (histEnabled) {
+    DumpHistograms(dir + conf + "/histogram.tr", nPrior);
+  }
 
   // sharedMemory->printDesignZeroVec(sharedMemory->getTotalProbers()-1); // AnnC: hard-coded for a single-port scenario
   Simulator::Destroy ();
-  return 0;
+  return branchFailed ? 1 : 0;
 }
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "bulk-flow-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/address.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/abort.h"
+
+namespace ns3 {
+
+BulkFlowHelper::BulkFlowHelper (std::string protocol)
+{
+  m_sourceFactory.SetTypeId ("ns3::BulkSendApplication");
+  m_sourceFactory.Set ("Protocol", StringValue (protocol));
+  m_sinkFactory.SetTypeId ("ns3::PacketSink");
+  m_sinkFactory.Set ("Protocol", StringValue (protocol));
+
+  TypeId source = m_sourceFactory.GetTypeId ();
+  m_local = Lookup (source, "Local");
+  m_remote = Lookup (source, "Remote");
+  m_maxBytes = Lookup (source, "MaxBytes");
+  m_cca = Lookup (source, "TcpCongestionOps");
+  m_flowId = Lookup (source, "FlowId");
+  m_priority = Lookup (source, "priority");
+  m_priorityCustom = Lookup (source, "priorityCustom");
+  m_sinkLocal = Lookup (m_sinkFactory.GetTypeId (), "Local");
+}
+
+struct TypeId::AttributeInformation
+BulkFlowHelper::Lookup (TypeId tid, std::string name)
+{
+  struct TypeId::AttributeInformation info;
+  if (!tid.LookupAttributeByName (name, &info))
+    {
+      NS_FATAL_ERROR ("Invalid attribute " << name << " of " << tid.GetName ());
+    }
+  return info;
+}
+
+void
+BulkFlowHelper::Set (Ptr<Application> app, const struct TypeId::AttributeInformation &info,
+                     const AttributeValue &value)
+{
+  NS_ABORT_MSG_UNLESS (info.checker->Check (value) && info.accessor->Set (PeekPointer (app), value),
+                       "Invalid value of attribute " << info.name);
+}
+
+void
+BulkFlowHelper::SetSourceAttribute (std::string name, const AttributeValue &value)
+{
+  m_sourceFactory.Set (name, value);
+}
+
+void
+BulkFlowHelper::SetSinkAttribute (std::string name, const AttributeValue &value)
+{
+  m_sinkFactory.Set (name, value);
+}
+
+void
+BulkFlowHelper::Install (Ptr<Node> source, Ptr<Node> sink, Ipv4Address sinkAddress,
+                         const std::vector<Flow> &flows,
+                         ApplicationContainer &sources, ApplicationContainer &sinks) const
+{
+  for (const Flow &flow : flows)
+    {
+      Address local = InetSocketAddress (Ipv4Address::GetAny (), flow.port);
+
+      Ptr<Application> app = m_sourceFactory.Create<Application> ();
+      Set (app, m_local, AddressValue (local));
+      Set (app, m_remote, AddressValue (InetSocketAddress (sinkAddress, flow.port)));
+      Set (app, m_maxBytes, UintegerValue (flow.maxBytes));
+      Set (app, m_cca, TypeIdValue (flow.cca));
+      Set (app, m_flowId, UintegerValue (flow.flowId));
+      Set (app, m_priority, UintegerValue (flow.priority));
+      Set (app, m_priorityCustom, UintegerValue (flow.priority));
+      app->SetStartTime (flow.start);
+      source->AddApplication (app);
+      sources.Add (app);
+
+      app = m_sinkFactory.Create<Application> ();
+      Set (app, m_sinkLocal, AddressValue (local));
+      sink->AddApplication (app);
+      sinks.Add (app);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BULK_FLOW_HELPER_H
+#define BULK_FLOW_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/type-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/node.h"
+#include "ns3/application-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup bulksend
+ * \brief A helper to install many BulkSendApplication / PacketSink pairs
+ * from a flow table.
+ *
+ * BulkSendHelper and PacketSinkHelper look each attribute up by name
+ * whenever it is set, so building a pair of helpers per flow costs about
+ * ten name lookups and checked value copies per flow. This helper looks
+ * the per-flow attributes up once, when it is constructed, and sets them
+ * on each application through their accessors. The attributes shared by
+ * all flows are set once on the factories.
+ *
+ * No socket is created at install time: the applications create theirs
+ * when they start.
+ */
+class BulkFlowHelper
+{
+public:
+  /** A row of the flow table. */
+  struct Flow
+  {
+    uint16_t port;      //!< Port of the sink, also the local port of the source.
+    uint64_t maxBytes;  //!< MaxBytes of the source, 0 for no limit.
+    Time start;         //!< Start time of the source.
+    TypeId cca;         //!< TcpCongestionOps of the source.
+    uint32_t flowId;    //!< FlowId of the source.
+    uint32_t priority;  //!< priority and priorityCustom of the source.
+  };
+
+  /**
+   * \param protocol the name of the socket factory of both ends,
+   *        e.g. ns3::TcpSocketFactory.
+   */
+  BulkFlowHelper (std::string protocol);
+
+  /**
+   * Set an attribute shared by all the BulkSendApplications.
+   *
+   * \param name the name of the application attribute to set
+   * \param value the value of the application attribute to set
+   */
+  void SetSourceAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Set an attribute shared by all the PacketSinks.
+   *
+   * \param name the name of the application attribute to set
+   * \param value the value of the application attribute to set
+   */
+  void SetSinkAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Install one BulkSendApplication on \p source and one PacketSink on
+   * \p sink per row of \p flows. The source of a row sends to
+   * \p sinkAddress on the port of the row, from the same local port.
+   * The sinks keep their default start time.
+   *
+   * \param source the node of the BulkSendApplications.
+   * \param sink the node of the PacketSinks.
+   * \param sinkAddress the address of \p sink.
+   * \param flows the flow table.
+   * \param sources the container the BulkSendApplications are added to,
+   *        in the order of \p flows.
+   * \param sinks the container the PacketSinks are added to, in the
+   *        order of \p flows.
+   */
+  void Install (Ptr<Node> source, Ptr<Node> sink, Ipv4Address sinkAddress,
+                const std::vector<Flow> &flows,
+                ApplicationContainer &sources, ApplicationContainer &sinks) const;
+
+private:
+  /**
+   * \param tid the application type.
+   * \param name the name of one of its attributes.
+   * \returns the accessor and checker of the attribute.
+   */
+  static struct TypeId::AttributeInformation Lookup (TypeId tid, std::string name);
+
+  /**
+   * Set a resolved attribute of an application.
+   *
+   * \param app the application.
+   * \param info the resolved attribute.
+   * \param value the value.
+   */
+  static void Set (Ptr<Application> app, const struct TypeId::AttributeInformation &info,
+                   const AttributeValue &value);
+
+  ObjectFactory m_sourceFactory;  //!< Factory of the BulkSendApplications.
+  ObjectFactory m_sinkFactory;    //!< Factory of the PacketSinks.
+
+  struct TypeId::AttributeInformation m_local;           //!< BulkSendApplication::Local.
+  struct TypeId::AttributeInformation m_remote;          //!< BulkSendApplication::Remote.
+  struct TypeId::AttributeInformation m_maxBytes;        //!< BulkSendApplication::MaxBytes.
+  struct TypeId::AttributeInformation m_cca;             //!< BulkSendApplication::TcpCongestionOps.
+  struct TypeId::AttributeInformation m_flowId;          //!< BulkSendApplication::FlowId.
+  struct TypeId::AttributeInformation m_priority;        //!< BulkSendApplication::priority.
+  struct TypeId::AttributeInformation m_priorityCustom;  //!< BulkSendApplication::priorityCustom.
+  struct TypeId::AttributeInformation m_sinkLocal;       //!< PacketSink::Local.
+};
+
+} // namespace ns3
+
+#endif /* BULK_FLOW_HELPER_H */
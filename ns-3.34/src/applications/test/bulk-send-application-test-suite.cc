@@ -36,6 +36,7 @@
 #include "ns3/bulk-send-helper.h"
 #include "ns3/packet-sink.h"
 #include "ns3/packet-sink-helper.h"
+#include "ns3/bulk-flow-helper.h"
 
 using namespace ns3;
 
@@ -250,6 +251,96 @@ BulkSendSeqTsSizeTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_received, 300000, "Received the full 300000 bytes");
 }
 
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * This test checks that BulkFlowHelper sets the per-flow attributes and
+ * start time of each source, and the local address of each sink.
+ */
+class BulkFlowHelperTestCase : public TestCase
+{
+public:
+  BulkFlowHelperTestCase ();
+  virtual ~BulkFlowHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BulkFlowHelperTestCase::BulkFlowHelperTestCase ()
+  : TestCase ("Check the attributes of the flows installed by BulkFlowHelper")
+{
+}
+
+BulkFlowHelperTestCase::~BulkFlowHelperTestCase ()
+{
+}
+
+void
+BulkFlowHelperTestCase::DoRun (void)
+{
+  Ptr<Node> sender = CreateObject<Node> ();
+  Ptr<Node> receiver = CreateObject<Node> ();
+  Ipv4Address sinkAddress ("10.1.1.2");
+
+  std::vector<BulkFlowHelper::Flow> flows;
+  flows.push_back ({1001, 300000, Seconds (0.5), TypeId::LookupByName ("ns3::TcpNewReno"), 1, 2});
+  flows.push_back ({1002, 0, Seconds (1.0), TypeId::LookupByName ("ns3::TcpBic"), 2, 3});
+  flows.push_back ({1003, 1000, MilliSeconds (1500), TypeId::LookupByName ("ns3::TcpVegas"), 7, 1});
+
+  BulkFlowHelper helper ("ns3::TcpSocketFactory");
+  helper.SetSourceAttribute ("SendSize", UintegerValue (1400));
+  ApplicationContainer sources;
+  ApplicationContainer sinks;
+  helper.Install (sender, receiver, sinkAddress, flows, sources, sinks);
+
+  NS_TEST_ASSERT_MSG_EQ (sources.GetN (), flows.size (), "One source per flow");
+  NS_TEST_ASSERT_MSG_EQ (sinks.GetN (), flows.size (), "One sink per flow");
+  NS_TEST_ASSERT_MSG_EQ (sender->GetNApplications (), flows.size (), "Sources are on the sender");
+  NS_TEST_ASSERT_MSG_EQ (receiver->GetNApplications (), flows.size (), "Sinks are on the receiver");
+
+  for (uint32_t i = 0; i < flows.size (); ++i)
+    {
+      const BulkFlowHelper::Flow &flow = flows[i];
+      Ptr<Application> source = sources.Get (i);
+      NS_TEST_ASSERT_MSG_NE (DynamicCast<BulkSendApplication> (source), 0, "Source is a BulkSendApplication");
+
+      AddressValue address;
+      source->GetAttribute ("Local", address);
+      NS_TEST_EXPECT_MSG_EQ (address.Get (), Address (InetSocketAddress (Ipv4Address::GetAny (), flow.port)), "Local of flow " << i);
+      source->GetAttribute ("Remote", address);
+      NS_TEST_EXPECT_MSG_EQ (address.Get (), Address (InetSocketAddress (sinkAddress, flow.port)), "Remote of flow " << i);
+
+      UintegerValue uinteger;
+      source->GetAttribute ("MaxBytes", uinteger);
+      NS_TEST_EXPECT_MSG_EQ (uinteger.Get (), flow.maxBytes, "MaxBytes of flow " << i);
+      source->GetAttribute ("FlowId", uinteger);
+      NS_TEST_EXPECT_MSG_EQ (uinteger.Get (), flow.flowId, "FlowId of flow " << i);
+      source->GetAttribute ("priority", uinteger);
+      NS_TEST_EXPECT_MSG_EQ (uinteger.Get (), flow.priority, "priority of flow " << i);
+      source->GetAttribute ("priorityCustom", uinteger);
+      NS_TEST_EXPECT_MSG_EQ (uinteger.Get (), flow.priority, "priorityCustom of flow " << i);
+      source->GetAttribute ("SendSize", uinteger);
+      NS_TEST_EXPECT_MSG_EQ (uinteger.Get (), 1400, "Shared SendSize of flow " << i);
+
+      TypeIdValue cca;
+      source->GetAttribute ("TcpCongestionOps", cca);
+      NS_TEST_EXPECT_MSG_EQ (cca.Get (), flow.cca, "TcpCongestionOps of flow " << i);
+
+      TimeValue start;
+      source->GetAttribute ("StartTime", start);
+      NS_TEST_EXPECT_MSG_EQ (start.Get (), flow.start, "Start time of flow " << i);
+
+      Ptr<Application> sink = sinks.Get (i);
+      NS_TEST_ASSERT_MSG_NE (DynamicCast<PacketSink> (sink), 0, "Sink is a PacketSink");
+      sink->GetAttribute ("Local", address);
+      NS_TEST_EXPECT_MSG_EQ (address.Get (), Address (InetSocketAddress (Ipv4Address::GetAny (), flow.port)), "Local of sink " << i);
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup applications-test
  * \ingroup tests
@@ -267,6 +358,7 @@ BulkSendTestSuite::BulkSendTestSuite ()
 {
   AddTestCase (new BulkSendBasicTestCase, TestCase::QUICK);
   AddTestCase (new BulkSendSeqTsSizeTestCase, TestCase::QUICK);
+  AddTestCase (new BulkFlowHelperTestCase, TestCase::QUICK);
 }
 
 static BulkSendTestSuite g_bulkSendTestSuite; //!< Static variable for test initialization
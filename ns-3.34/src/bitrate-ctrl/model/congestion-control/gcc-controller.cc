@@ -858,15 +858,11 @@ void GccController::OveruseEstimatorUpdate(int64_t t_delta, double ts_delta, int
                       (1 - smoothing_coef_) * accumulated_delay_;
 
   // Simple linear regression.
-  delay_hist_.push_back(std::make_pair(
-      static_cast<double>(now_ms),
-      smoothed_delay_));
+  delay_hist_.Add(static_cast<double>(now_ms), smoothed_delay_);
 
-  while (delay_hist_.front ().first + window_size_ < now_ms) {
-      delay_hist_.pop_front();
+  while (delay_hist_.Front().first + window_size_ < now_ms) {
+      delay_hist_.PopFront();
   }
-  
-  delay_hist_.shrink_to_fit();
 
   // if(delay_hist_.size() == window_size_) {
       // Update trend_ if it is possible to fit a line to the data. The delay
@@ -874,7 +870,7 @@ void GccController::OveruseEstimatorUpdate(int64_t t_delta, double ts_delta, int
       // 0 < trend < 1   ->  the delay increases, queues are filling up
       //   trend == 0    ->  the delay does not change
       //   trend < 0     ->  the delay decreases, queues are being emptied
-      offset_ = LinearFitSlope(delay_hist_);  // offset_ in kalkan is the trend in trendline
+      offset_ = delay_hist_.Slope();  // offset_ in kalkan is the trend in trendline
   // }
 	
 
@@ -937,25 +933,84 @@ void GccController::OveruseEstimatorUpdate(int64_t t_delta, double ts_delta, int
   */
 }
 
-double GccController::LinearFitSlope(const std::deque<std::pair<double, double>>& points)
+TrendlineAccumulator::TrendlineAccumulator()
+: points_()
+, origin_x_(0)
+, origin_y_(0)
+, sum_x_(0)
+, sum_y_(0)
+, sum_xy_(0)
+, sum_xx_(0)
+, pops_since_recenter_(0)
+{}
+
+void TrendlineAccumulator::Add(double x, double y)
+{
+    if (points_.empty()) {
+        origin_x_ = x;
+        origin_y_ = y;
+    }
+    points_.push_back(std::make_pair(x, y));
+    const double dx = x - origin_x_;
+    const double dy = y - origin_y_;
+    sum_x_ += dx;
+    sum_y_ += dy;
+    sum_xy_ += dx * dy;
+    sum_xx_ += dx * dx;
+}
+
+void TrendlineAccumulator::PopFront()
 {
-    // Compute the "center of mass".
-    double sum_x = 0;
-    double sum_y = 0;
-    for(const std::pair<double, double>& point : points) {
-        sum_x += point.first;
-        sum_y += point.second;
+    const double dx = points_.front().first - origin_x_;
+    const double dy = points_.front().second - origin_y_;
+    points_.pop_front();
+    sum_x_ -= dx;
+    sum_y_ -= dy;
+    sum_xy_ -= dx * dy;
+    sum_xx_ -= dx * dx;
+    if (++pops_since_recenter_ >= points_.size()) {
+        Recenter();
     }
-    double x_avg = sum_x / points.size();
-    double y_avg = sum_y / points.size();
-    // Compute the slope k = \sum (x_i-x_avg)(y_i-y_avg) / \sum (x_i-x_avg)^2
-    double numerator = 0;
-    double denominator = 0;
-    for(const std::pair<double, double>& point : points) {
-        numerator += (point.first - x_avg) * (point.second - y_avg);
-        denominator += (point.first - x_avg) * (point.first - x_avg);
+}
+
+void TrendlineAccumulator::Clear()
+{
+    points_.clear();
+    Recenter();
+}
+
+void TrendlineAccumulator::Recenter()
+{
+    // Recompute the sums from scratch around the oldest point, this also
+    // drops the rounding error accumulated by the add/evict updates
+    sum_x_ = sum_y_ = sum_xy_ = sum_xx_ = 0;
+    pops_since_recenter_ = 0;
+    if (points_.empty()) {
+        return;
+    }
+    origin_x_ = points_.front().first;
+    origin_y_ = points_.front().second;
+    for (const std::pair<double, double>& point : points_) {
+        const double dx = point.first - origin_x_;
+        const double dy = point.second - origin_y_;
+        sum_x_ += dx;
+        sum_y_ += dy;
+        sum_xy_ += dx * dy;
+        sum_xx_ += dx * dx;
+    }
+}
+
+double TrendlineAccumulator::Slope() const
+{
+    if (points_.empty()) {
+        return 0;
     }
-    if(denominator == 0) {
+    // k = \sum (x_i-x_avg)(y_i-y_avg) / \sum (x_i-x_avg)^2
+    //   = (\sum xy - \sum x \sum y / n) / (\sum x^2 - (\sum x)^2 / n)
+    const double n = points_.size();
+    const double numerator = sum_xy_ - sum_x_ * sum_y_ / n;
+    const double denominator = sum_xx_ - sum_x_ * sum_x_ / n;
+    if(denominator <= 0) {
         return 0;
     }
     return numerator / denominator;
@@ -40,6 +40,7 @@
 #include <string>
 #include <limits>
 #include <cstdio>
+#include <deque>
 
 #include "ns3/checks.h"
 #include "ns3/safe_minmax.h"
@@ -48,6 +49,44 @@
 
 namespace rmcat {
 
+/**
+ * Least-squares slope over a sliding window of (x, y) points, e.g. the
+ * (arrival time in ms, smoothed delay) samples of the trendline estimator.
+ *
+ * Add and PopFront are O(1): the fit is computed from running sums of
+ * x, y, xy and x^2. The sums are kept relative to an origin that is moved
+ * to the oldest point once as many points have been evicted as are left in
+ * the window, so they stay small as x grows (amortized O(1)).
+ */
+class TrendlineAccumulator
+{
+public:
+    TrendlineAccumulator();
+
+    void Add(double x, double y);
+    void PopFront();
+    void Clear();
+
+    const std::pair<double, double>& Front() const { return points_.front(); }
+    bool Empty() const { return points_.empty(); }
+    size_t Size() const { return points_.size(); }
+
+    /** Slope of the least-squares line, 0 if all x are equal */
+    double Slope() const;
+
+private:
+    void Recenter();
+
+    std::deque<std::pair<double, double>> points_;
+    double origin_x_;
+    double origin_y_;
+    double sum_x_;
+    double sum_y_;
+    double sum_xy_;
+    double sum_xx_;
+    size_t pops_since_recenter_;
+};
+
 /**
  * Simplistic implementation of a sender-based congestion controller. The
  * algorithm simply returns a constant, hard-coded bandwidth when queried.
@@ -139,7 +178,6 @@ public:
 
 private:
 /*Overuse Estimator Function */
-    double LinearFitSlope(const std::deque<std::pair<double, double>>& points);
     void Detect(double trend, double ts_delta, int64_t now_ms);
     double UpdateMinFramePeriod(double ts_delta);
     void UpdateNoiseEstimate(double residual, double ts_delta, bool stable_state);
@@ -198,7 +236,7 @@ private:
     double accumulated_delay_;
     double smoothed_delay_;
         // Linear least squares regression.
-    std::deque<std::pair<double, double>> delay_hist_;
+    TrendlineAccumulator delay_hist_;
 
 /*Overuse Detector variable*/
     double k_up_;
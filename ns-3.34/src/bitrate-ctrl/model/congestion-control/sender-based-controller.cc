@@ -185,6 +185,12 @@ bool SenderBasedController::processSendPacket(uint64_t txTimestampUs,
             break;
         }
     }
+    // Same bound for the transit history, which is otherwise only pruned
+    //  when the sender sees a complete group
+    while (lessThan(m_PacketTransitHistory.front().txTimestampUs + 10 * MAX_INTER_PACKET_TIME_US,
+                    txTimestampUs)) {
+        m_PacketTransitHistory.pop_front();
+    }
     return true;
 }
 
@@ -279,9 +285,13 @@ bool SenderBasedController::processFeedback(uint64_t nowUs,
     uint32_t intvl_pseudo_size = 0;
     // std::cout<<"time now: " << nowUs << " sender-based-controoler record size: "<<" packet seq: "
     //          <<packet.sequence<<" last seq: "<<" begin: "<<m_PacketTransitHistory.begin()->sequence<<" end: "<<m_PacketTransitHistory.end()->sequence<<" ";
-    for (auto it = m_PacketTransitHistory.begin(); it != m_PacketTransitHistory.end(); it ++) {
-        if (it->sequence > m_lastRecvSequence && it->sequence <= packet.sequence &&
-            nowUs - it->txTimestampUs < 1000000) {
+    // The history is in send order, so walk back from the newest packet and
+    // stop at the first one sent more than 1s ago
+    for (auto it = m_PacketTransitHistory.rbegin(); it != m_PacketTransitHistory.rend(); it ++) {
+        if (nowUs - it->txTimestampUs >= 1000000) {
+            break;
+        }
+        if (it->sequence > m_lastRecvSequence && it->sequence <= packet.sequence) {
             intvl_pseudo_size += it->size;
             // std::cout << " [" << it->sequence << " " << it->size << " " << it->txTimestampUs << "] ";
         }
@@ -297,6 +307,13 @@ bool SenderBasedController::processFeedback(uint64_t nowUs,
     m_recvHistory.push_back(packet);
     m_pktSizeSum += packet.size;
 
+    // getCurrentRecvRate only looks 1s back and prunes the receive history
+    //  itself, but not when it bails out early
+    while (lessThan(m_recvHistory.front().txTimestampUs + 10 * MAX_INTER_PACKET_TIME_US,
+                    packet.txTimestampUs)) {
+        m_recvHistory.pop_front();
+    }
+
     // Garbage collect history to keep its length within limits
     while (true) {
         const uint64_t lastTimestampUs = m_packetHistory.back().txTimestampUs;
@@ -318,7 +335,8 @@ void SenderBasedController::UpdateLossRate(uint8_t loss_q8) {
 }
 
 void SenderBasedController::PrunTransitHistory (uint16_t tar_seq) {
-    while (Uint16Less (m_PacketTransitHistory.front().sequence, tar_seq)) {
+    while (!m_PacketTransitHistory.empty() &&
+           Uint16Less (m_PacketTransitHistory.front().sequence, tar_seq)) {
         // std::cout << "PrunTransitHistory:: " << m_PacketTransitHistory.front().sequence  << "\n";
         // std::cout << "PrunTransitHistory:: " << tar_seq << "\n";
         m_PacketTransitHistory.pop_front();
@@ -60,12 +60,13 @@ bool PacketBatch::CheckComplete() {
             // Assume every FEC packet stores data of all other data packets
             NS_ASSERT(this->fec_pkts.size() > 0);
             Time now = Simulator::Now();
-            auto data_pkt_digests = this->fec_pkts.begin()->second->GetDataPacketDigests();
-            for(auto data_pkt_digest : data_pkt_digests) {
+            Ptr<FECPacket> fec_pkt = this->fec_pkts.begin()->second;
+            for(uint16_t i = 0;i < fec_pkt->GetDataPacketDigestNum();i++) {
+                const DataPktDigest& data_pkt_digest = fec_pkt->GetDataPacketDigest(i);
                 // std::cout << "[PacketBatch] in FEC packets: pkt_id_in_batch: " << 
-                //     data_pkt_digest->pkt_id_in_batch << "pkt_id_in_group: " << 
-                //     data_pkt_digest->pkt_id_in_group <<'\n';
-                if(this->data_pkts.find(data_pkt_digest->pkt_id_in_batch) == this->data_pkts.end()) {
+                //     data_pkt_digest.pkt_id_in_batch << "pkt_id_in_group: " << 
+                //     data_pkt_digest.pkt_id_in_group <<'\n';
+                if(this->data_pkts.find(data_pkt_digest.pkt_id_in_batch) == this->data_pkts.end()) {
                     // data packet not exists in this->data_pkts
                     Ptr<DataPacket> data_pkt = Create<DataPacket> (
                         data_pkt_digest,
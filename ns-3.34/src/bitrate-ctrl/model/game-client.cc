@@ -53,6 +53,13 @@ void GameClient::Setup (Ipv4Address srcIP, uint16_t srcPort, uint16_t destPort,
     }
 };
 
+Ptr<VideoDecoder> GameClient::GetDecoder() { return this->decoder; };
+
+void GameClient::SetFlowTags(uint32_t flowId, uint8_t priority) {
+    NS_ABORT_MSG_IF(!this->receiver, "GameClient::SetFlowTags called before Setup");
+    this->receiver->SetFlowTags(flowId, priority);
+};
+
 void GameClient::DoDispose() {
 
 };
@@ -64,7 +71,9 @@ void GameClient::StartApplication(void) {
 
 void GameClient::StopApplication(void) {
     NS_LOG_ERROR("\n[Client] Stopping GameClient...");
-    this->receiver->StopRunning();
+    if (this->receiver) {
+        this->receiver->StopRunning();
+    }
 };
 
 void GameClient::ReplyFrameACK(uint32_t frame_id, Time frame_encode_time) {
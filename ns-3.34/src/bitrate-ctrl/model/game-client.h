@@ -25,6 +25,14 @@ public:
     ~GameClient();
     void Setup (Ipv4Address srcIP, uint16_t srcPort, uint16_t destPort, uint16_t interval, 
         Time delayDdl, bool tcpEnabled, Ptr<OutputStreamWrapper> appTrStream);
+    Ptr<VideoDecoder> GetDecoder();
+    /**
+     * \brief Tag the feedback packets of this flow for GenQueueDisc
+     *
+     * \param flowId FlowIdTag of the feedback packets
+     * \param priority MyPriorityTag of the feedback packets
+     */
+    void SetFlowTags(uint32_t flowId, uint8_t priority);
     bool m_cc_create;
     uint16_t interval;
 
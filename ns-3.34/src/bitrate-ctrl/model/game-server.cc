@@ -63,6 +63,11 @@ void GameServer::SetController(std::string cca) {
     m_cca = cca;
 }
 
+void GameServer::SetFlowTags(uint32_t flowId, uint8_t priority) {
+    NS_ABORT_MSG_IF(!m_sender, "GameServer::SetFlowTags called before Setup");
+    m_sender->SetFlowTags(flowId, priority);
+}
+
 void GameServer::DoDispose() {};
 
 void GameServer::StartApplication() {
@@ -73,8 +78,13 @@ void GameServer::StartApplication() {
 
 void GameServer::StopApplication() {
     NS_LOG_ERROR("\n\n[Server] Stopping GameServer...");
-    m_sender->StopRunning();
-    m_encoder->StopEncoding();
+    /* the stop time may come before Setup or the start time */
+    if (m_sender) {
+        m_sender->StopRunning();
+    }
+    if (m_encoder) {
+        m_encoder->StopEncoding();
+    }
 };
 
 uint32_t GameServer::GetNextFrameId () { return m_frameId ++; };
@@ -45,6 +45,13 @@ public:
         Ptr<OutputStreamWrapper> bwTrStream
     );
     void SetController(std::string cca);
+    /**
+     * \brief Tag the packets of this flow for GenQueueDisc, as BulkSendApplication does
+     *
+     * \param flowId FlowIdTag of the video packets
+     * \param priority MyPriorityTag of the video packets
+     */
+    void SetFlowTags(uint32_t flowId, uint8_t priority);
 protected:
     void DoDispose();
 private:
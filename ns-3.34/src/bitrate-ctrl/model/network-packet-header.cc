@@ -1,9 +1,14 @@
 #include "network-packet-header.h"
+#include "ns3/fec-policy.h"
+#include "ns3/abort.h"
 
 
 namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("PacketHeader");
 
+static_assert (FECPacketHeader::MAX_DATA_PKTS == FECPolicy::MAX_GROUP_SIZE,
+    "FECPacketHeader must hold the digests of a full FEC group");
+
 TypeId GroupPacketInfo::GetTypeId() {
     static TypeId tid = TypeId ("ns3::GroupPacketInfo")
         .SetParent<Object> ()
@@ -72,7 +77,8 @@ TypeId NetworkPacketPayload::GetTypeId() {
 
 NetworkPacketPayload::NetworkPacketPayload() {
     this->payload_size = 0;
-    this->payload_buffer = new uint8_t[1];
+    /* the payload is never materialized, ToNetPacket only uses payload_size */
+    this->payload_buffer = nullptr;
 };
 
 NetworkPacketPayload::~NetworkPacketPayload() {};
@@ -193,18 +199,6 @@ DataPktFrameInfo::DataPktFrameInfo(uint32_t frame_id, uint16_t pkt_id_in_frame)
 DataPktFrameInfo::~DataPktFrameInfo() {};
 
 
-/* class DataPktDigest */
-TypeId DataPktDigest::GetTypeId() {
-    static TypeId tid = TypeId ("ns3::DataPktDigest")
-        .SetParent<Object> ()
-        .SetGroupName("bitrate-ctrl")
-    ;
-    return tid;
-};
-
-DataPktDigest::~DataPktDigest() {};
-
-
 // class DataPacketHeader
 TypeId DataPacketHeader::GetTypeId() {
     static TypeId tid = TypeId ("ns3::DataPacketHeader")
@@ -277,46 +271,46 @@ FECPacketHeader::~FECPacketHeader() {};
 
 TypeId FECPacketHeader::GetInstanceTypeId (void) const { return GetTypeId(); };
 
+static_assert(sizeof(DataPktDigest) == 2 + 2 + 4 + 2 + 2, "DataPktDigest must match its wire size");
+
 uint32_t FECPacketHeader::GetSerializedSize () const {
-    return this->data_pkts.size() * (2 + 2 + 4 + 2 + 2) + 2;
+    return this->data_pkts.size() * sizeof(DataPktDigest) + 2;
 };
 
 void FECPacketHeader::Serialize (Buffer::Iterator start) const {
     start.WriteHtonU16(this->data_pkts.size());
-    for(auto digest : this->data_pkts) {
-        start.WriteHtonU16(digest->pkt_id_in_batch);
-        start.WriteHtonU16(digest->pkt_id_in_group);
-        start.WriteHtonU32(digest->frame_id);
-        start.WriteHtonU16(digest->frame_pkt_num);
-        start.WriteHtonU16(digest->pkt_id_in_frame);
+    for(const DataPktDigest& digest : this->data_pkts) {
+        start.WriteHtonU16(digest.pkt_id_in_batch);
+        start.WriteHtonU16(digest.pkt_id_in_group);
+        start.WriteHtonU32(digest.frame_id);
+        start.WriteHtonU16(digest.frame_pkt_num);
+        start.WriteHtonU16(digest.pkt_id_in_frame);
     }
 };
 
 uint32_t FECPacketHeader::Deserialize (Buffer::Iterator start) {
-    uint32_t read_size = 2;
-    uint16_t pkts_size = start.ReadNtohU16();
-    while(pkts_size>0) {
-        Ptr<DataPktDigest> digest = Create<DataPktDigest> ();
-        digest->pkt_id_in_batch = start.ReadNtohU16();
-        digest->pkt_id_in_group = start.ReadNtohU16();
-        digest->frame_id = start.ReadNtohU32();
-        digest->frame_pkt_num = start.ReadNtohU16();
-        digest->pkt_id_in_frame = start.ReadNtohU16();
-        this->data_pkts.push_back(digest);
-        read_size += 12;
-        pkts_size--;
+    uint16_t data_pkt_num = start.ReadNtohU16();
+    NS_ABORT_MSG_IF(data_pkt_num > MAX_DATA_PKTS,
+        "FEC header protects " << data_pkt_num << " data packets, more than " << MAX_DATA_PKTS);
+    this->data_pkts.resize(data_pkt_num);
+    for(DataPktDigest& digest : this->data_pkts) {
+        digest.pkt_id_in_batch = start.ReadNtohU16();
+        digest.pkt_id_in_group = start.ReadNtohU16();
+        digest.frame_id = start.ReadNtohU32();
+        digest.frame_pkt_num = start.ReadNtohU16();
+        digest.pkt_id_in_frame = start.ReadNtohU16();
     }
-    return read_size;
+    return data_pkt_num * sizeof(DataPktDigest) + 2;
 };
 
 void FECPacketHeader::Print (std::ostream &os) const {
     os << "FEC Group Size=" << this->data_pkts.size();
-    for(auto digest : this->data_pkts) {
-        os << "digest->pkt_id_in_batch" << digest->pkt_id_in_batch;
-        os << "digest->pkt_id_in_group" << digest->pkt_id_in_group;
-        os << "digest->frame_id" << digest->frame_id;
-        os << "digest->frame_pkt_num" << digest->frame_pkt_num;
-        os << "digest->pkt_id_in_frame" << digest->pkt_id_in_frame;
+    for(const DataPktDigest& digest : this->data_pkts) {
+        os << "digest->pkt_id_in_batch" << digest.pkt_id_in_batch;
+        os << "digest->pkt_id_in_group" << digest.pkt_id_in_group;
+        os << "digest->frame_id" << digest.frame_id;
+        os << "digest->frame_pkt_num" << digest.frame_pkt_num;
+        os << "digest->pkt_id_in_frame" << digest.pkt_id_in_frame;
     }
 };
 
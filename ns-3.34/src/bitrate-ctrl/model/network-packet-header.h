@@ -104,17 +104,16 @@ public:
 };
 
 
-class DataPktDigest : public Object {
-public:
-    static TypeId GetTypeId (void);
+/* Digest of a data packet protected by a FEC packet, same 12-byte layout as on the wire.
+   Plain struct so FECPacketHeader can keep them inline */
+struct DataPktDigest {
     uint16_t pkt_id_in_batch;
     uint16_t pkt_id_in_group;
     uint32_t frame_id;
     uint16_t frame_pkt_num;
     uint16_t pkt_id_in_frame;
-    DataPktDigest();
+    DataPktDigest() = default;
     DataPktDigest(Ptr<DataPacket> pkt);
-    ~DataPktDigest();
 };
 
 class DataPacketHeader : public SimpleRefCount<DataPacketHeader,Header> {
@@ -141,8 +140,15 @@ public:
 };  // class DataPacketHeader
 
 class FECPacketHeader : public SimpleRefCount<FECPacketHeader,Header> {
+public:
+    /* FECPolicy::MAX_GROUP_SIZE, a batch never protects more data packets;
+       fec-policy.h includes this header, so network-packet-header.cc checks
+       that the two agree */
+    static const uint16_t MAX_DATA_PKTS = 100;
 private:
-    std::vector<Ptr<DataPktDigest>> data_pkts;
+    /* plain digests, one per protected packet: a copy of the header costs the
+       group it protects, not MAX_DATA_PKTS entries */
+    std::vector<DataPktDigest> data_pkts;
 public:
     friend class FECPacket;
     static TypeId GetTypeId (void);
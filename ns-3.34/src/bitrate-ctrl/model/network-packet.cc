@@ -1,4 +1,5 @@
 #include "network-packet.h"
+#include "ns3/abort.h"
 
 namespace ns3
 {
@@ -131,8 +132,6 @@ uint8_t VideoPacket::GetTXCount() { return this->video_header.tx_count; };
 
 uint16_t VideoPacket::GetMaxPayloadSize() { return NetworkPacket::MAX_PACKET_SIZE - 42; };
 
-DataPktDigest::DataPktDigest() {};
-
 DataPktDigest::DataPktDigest(Ptr<DataPacket> pkt) {
     this->pkt_id_in_batch = pkt->GetPktIdBatch();
     this->pkt_id_in_group = pkt->GetPktIdGroup();
@@ -183,14 +182,14 @@ Ptr<Packet> DataPacket::ToTcpSendPacket() {
     return packet;
 };
 
-DataPacket::DataPacket(Ptr<DataPktDigest> data_pkt_digest,
+DataPacket::DataPacket(const DataPktDigest& data_pkt_digest,
     uint32_t group_id, uint16_t group_data_num, uint16_t group_fec_num,
     uint32_t batch_id, uint16_t batch_data_num, uint16_t batch_fec_num) : VideoPacket(PacketType::DATA_PKT) {
-    this->data_header.frame_id = data_pkt_digest->frame_id;
-    this->data_header.frame_pkt_num = data_pkt_digest->frame_pkt_num;
-    this->data_header.pkt_id_in_frame = data_pkt_digest->pkt_id_in_frame;
-    this->SetFECBatch(batch_id, batch_data_num, batch_fec_num, data_pkt_digest->pkt_id_in_batch);
-    this->SetFECGroup(group_id, group_data_num, group_fec_num, data_pkt_digest->pkt_id_in_group);
+    this->data_header.frame_id = data_pkt_digest.frame_id;
+    this->data_header.frame_pkt_num = data_pkt_digest.frame_pkt_num;
+    this->data_header.pkt_id_in_frame = data_pkt_digest.pkt_id_in_frame;
+    this->SetFECBatch(batch_id, batch_data_num, batch_fec_num, data_pkt_digest.pkt_id_in_batch);
+    this->SetFECGroup(group_id, group_data_num, group_fec_num, data_pkt_digest.pkt_id_in_group);
 };
 
 uint16_t DataPacket::GetMaxPayloadSize() { return VideoPacket::GetMaxPayloadSize() - 12; };
@@ -247,9 +246,7 @@ TypeId FECPacket::GetTypeId() {
 
 FECPacket::FECPacket(uint8_t tx_count, std::vector<Ptr<DataPacket>> data_pkts) : VideoPacket(PacketType::FEC_PKT) {
     this->SetTXCount(tx_count);
-    for(auto data_pkt : data_pkts) {
-        this->fec_header.data_pkts.push_back(Create<DataPktDigest> (data_pkt));
-    }
+    this->SetDataPackets(data_pkts);
 };
 
 FECPacket::FECPacket(Ptr<Packet> packet) : VideoPacket(PacketType::FEC_PKT) {
@@ -272,14 +269,22 @@ Ptr<Packet> FECPacket::ToNetPacket() {
 };
 
 uint32_t FECPacket::GetHeaderLength() {
-    return 2 /* size */ + this->fec_header.data_pkts.size() * (2 + 2 + 4 + 2 + 2);
+    return this->fec_header.GetSerializedSize();
 };
 
-std::vector<Ptr<DataPktDigest>> FECPacket::GetDataPacketDigests() { return this->fec_header.data_pkts; };
+uint16_t FECPacket::GetDataPacketDigestNum() { return this->fec_header.data_pkts.size(); };
+
+const DataPktDigest& FECPacket::GetDataPacketDigest(uint16_t i) {
+    NS_ASSERT(i < this->fec_header.data_pkts.size());
+    return this->fec_header.data_pkts[i];
+};
 
 void FECPacket::SetDataPackets(std::vector<Ptr<DataPacket>> data_pkts) {
+    NS_ABORT_MSG_IF(this->fec_header.data_pkts.size() + data_pkts.size() > FECPacketHeader::MAX_DATA_PKTS,
+        "FEC packet cannot protect more than " << FECPacketHeader::MAX_DATA_PKTS << " data packets");
+    this->fec_header.data_pkts.reserve(this->fec_header.data_pkts.size() + data_pkts.size());
     for(auto data_pkt : data_pkts) {
-        this->fec_header.data_pkts.push_back(Create<DataPktDigest> (data_pkt));
+        this->fec_header.data_pkts.push_back(DataPktDigest(data_pkt));
     }
 };
 
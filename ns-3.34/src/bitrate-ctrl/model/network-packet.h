@@ -135,7 +135,7 @@ public:
      *
      * @param data_packet_digest digest about data packets stored in FECPackets
      */
-    DataPacket(Ptr<DataPktDigest> data_pkt_digest,
+    DataPacket(const DataPktDigest& data_pkt_digest,
         uint32_t group_id, uint16_t group_data_num, uint16_t group_fec_num,
         uint32_t batch_id, uint16_t batch_data_num, uint16_t batch_fec_num
     );
@@ -184,7 +184,9 @@ protected:
 private:
     uint32_t GetHeaderLength();
 public:
-    std::vector<Ptr<DataPktDigest>> GetDataPacketDigests();
+    uint16_t GetDataPacketDigestNum();
+    /* parsed in place in the FEC header, valid as long as this packet */
+    const DataPktDigest& GetDataPacketDigest(uint16_t i);
     void SetDataPackets(std::vector<Ptr<DataPacket>> data_pkts);
 };  // class FECPacket
 
@@ -1,5 +1,7 @@
 #include "packet-receiver.h"
 #include "game-client.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/custom-priority-tag.h"
 
 namespace ns3 {
 
@@ -16,10 +18,25 @@ TypeId PacketReceiver::GetTypeId() {
 PacketReceiver::PacketReceiver ()
 : game_client{NULL}
 , m_socket {NULL}
+, m_flowId {0}
+, m_priority {0}
 {};
 
 PacketReceiver::~PacketReceiver () {};
 
+void PacketReceiver::SetFlowTags(uint32_t flowId, uint8_t priority) {
+    m_flowId = flowId;
+    m_priority = priority;
+}
+
+void PacketReceiver::TagPacket(Ptr<Packet> pkt) {
+    FlowIdTag flowid(m_flowId);
+    pkt->AddPacketTag(flowid);
+    MyPriorityTag a;
+    a.SetPriority(m_priority);
+    pkt->AddPacketTag(a);
+}
+
 void PacketReceiver::StartApplication(GameClient* client, Ptr<VideoDecoder> decoder, Time delay_ddl, Ptr<Node> node) {
     this->game_client = client;
     this->decoder = decoder;
@@ -27,12 +27,21 @@ public:
     virtual void StopRunning() = 0;
     virtual void ReplyACK(std::vector<Ptr<DataPacket>> data_pkts, uint16_t last_pkt_id) = 0;
 
+    /**
+     * \brief Flow id and priority tags carried by every feedback packet, for GenQueueDisc
+     */
+    void SetFlowTags(uint32_t flowId, uint8_t priority);
+
 
 protected:
     GameClient * game_client;
     Ptr<Socket> m_socket;
     Ptr<VideoDecoder> decoder;
     Time delay_ddl;     /* delay ddl */
+    uint32_t m_flowId;
+    uint8_t m_priority;
+
+    void TagPacket(Ptr<Packet> pkt);
 
 };  // class PacketReceiver
 
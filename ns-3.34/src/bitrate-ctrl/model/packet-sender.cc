@@ -1,4 +1,6 @@
 #include "packet-sender.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/custom-priority-tag.h"
 
 namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("PacketSender");
@@ -13,6 +15,8 @@ TypeId PacketSender::GetTypeId() {
 
 PacketSender::PacketSender (void)
 : m_socket {NULL}
+, m_flowId {0}
+, m_priority {0}
 , m_ccEnabled {true}
 {
     NS_LOG_FUNCTION (this);
@@ -37,6 +41,19 @@ void PacketSender::SetParams (
 
 PacketSender::~PacketSender() {};
 
+void PacketSender::SetFlowTags(uint32_t flowId, uint8_t priority) {
+    m_flowId = flowId;
+    m_priority = priority;
+};
+
+void PacketSender::TagPacket(Ptr<Packet> pkt) {
+    FlowIdTag flowid(m_flowId);
+    pkt->AddPacketTag(flowid);
+    MyPriorityTag a;
+    a.SetPriority(m_priority);
+    pkt->AddPacketTag(a);
+};
+
 uint32_t PacketSender::GetSendingRateBps() {
     return m_bitrate;
 };
@@ -73,6 +90,7 @@ TypeId PacketFrame::GetTypeId()
 PacketFrame::PacketFrame(std::vector<Ptr<VideoPacket>> packets, bool retransmission)
 {
     this->packets_in_Frame.assign(packets.begin(), packets.end());
+    this->next_pkt_idx = 0;
     this->retransmission = retransmission;
 };
 
@@ -80,12 +98,12 @@ PacketFrame::~PacketFrame() {};
 
 uint32_t PacketFrame::Frame_size_in_byte()
 {
-    return this->packets_in_Frame.size() * this->per_packet_size;
+    return Frame_size_in_packet() * this->per_packet_size;
 };
 
 uint32_t PacketFrame::Frame_size_in_packet()
 {
-    return this->packets_in_Frame.size();
+    return this->packets_in_Frame.size() - this->next_pkt_idx;
 };
 
 SentPacketInfo::SentPacketInfo(uint16_t id, uint16_t batch_id, Time sendtime, PacketType type, bool isgoodput, uint16_t size){
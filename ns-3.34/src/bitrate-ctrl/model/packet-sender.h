@@ -44,6 +44,8 @@ public:
 
     std::vector<Ptr<VideoPacket>> packets_in_Frame;
 
+    uint32_t next_pkt_idx; /* index of the next packet to send in packets_in_Frame */
+
     Time Frame_encode_time_; /*the encodde time of the packets in this frame */
 
     uint32_t per_packet_size; /* bytes in each packet */
@@ -51,12 +53,12 @@ public:
     bool retransmission; /* whether the packets are retransmission packets */
 
     /**
-     * \brief calculate the total bytes in this frame
+     * \brief calculate the total bytes in this frame that are not sent yet
      */
     uint32_t Frame_size_in_byte();
 
     /**
-     * \brief calculate the total number of packets in this frame
+     * \brief calculate the number of packets in this frame that are not sent yet
      */
     uint32_t Frame_size_in_packet();
 
@@ -83,8 +85,15 @@ public:
     virtual void CreateFrame(uint32_t frame_id, uint16_t pkt_id, uint16_t data_pkt_max_payload, uint16_t data_pkt_num, uint32_t data_size) = 0;
     
     virtual void StopRunning()=0;
+
+    /**
+     * \brief Flow id and priority tags carried by every packet sent, for GenQueueDisc
+     */
+    void SetFlowTags(uint32_t flowId, uint8_t priority);
     
 protected:
+    void TagPacket(Ptr<Packet> pkt);
+
     GameServer * m_gameServer;
     void (GameServer::*m_encodeFunc)(uint32_t encodeBitrateBps);
     Ptr<Socket> m_socket; 
@@ -94,6 +103,8 @@ protected:
     Ipv4Address m_destIP;
     uint16_t m_destPort;
     Ipv4Header::DscpType m_dscp;
+    uint32_t m_flowId;
+    uint8_t m_priority;
 
     uint32_t m_bitrate;
     bool m_ccEnabled;
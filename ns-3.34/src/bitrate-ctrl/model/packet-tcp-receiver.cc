@@ -39,7 +39,9 @@ void PacketTcpReceiver::StartApplication(GameClient* client, Ptr<VideoDecoder> d
     }
 }
 void PacketTcpReceiver::StopRunning(){
-    this->m_socket->Close();
+    if (this->m_socket) {
+        this->m_socket->Close();
+    }
 }
 
 void PacketTcpReceiver::HandleAccept (Ptr<Socket> s, const Address& from)
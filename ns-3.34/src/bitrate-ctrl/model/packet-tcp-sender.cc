@@ -69,7 +69,9 @@ void PacketTcpSender::StartApplication (Ptr<Node> node) {
 
 void PacketTcpSender::StopRunning(){
     PacketSender::StopRunning();
-    m_socket->Close();
+    if (m_socket) {
+        m_socket->Close();
+    }
     m_eventUpdateDuty.Cancel();
 }
 
@@ -359,14 +359,18 @@ void PacketUdpReceiver::Feedback_NetState ()
 
     Ptr<NetStatePacket> nstpacket = Create<NetStatePacket>();
     nstpacket->SetNetStates(netstate);
-    m_socket->Send(nstpacket->ToNetPacket());
+    Ptr<Packet> pkt = nstpacket->ToNetPacket();
+    TagPacket(pkt);
+    m_socket->Send(pkt);
     // this->m_recv_sample.clear();
     m_feedbackTimer.Schedule();
 };
 
 
 void PacketUdpReceiver::SendPacket(Ptr<NetworkPacket> pkt) {
-    m_socket->Send(pkt->ToNetPacket());
+    Ptr<Packet> netPkt = pkt->ToNetPacket();
+    TagPacket(netPkt);
+    m_socket->Send(netPkt);
 }
 
 void PacketUdpReceiver::Set_FECgroup_delay(Time& fec_group_delay_)
@@ -403,7 +407,9 @@ void PacketUdpReceiver::StopRunning() {
     if(this->m_feedbackTimer.IsRunning()){
         this->m_feedbackTimer.Cancel();
     }
-    this->m_socket->Close();
+    if (this->m_socket) {
+        this->m_socket->Close();
+    }
     this->OutputStatistics();
 };
 
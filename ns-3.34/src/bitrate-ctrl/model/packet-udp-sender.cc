@@ -57,6 +57,14 @@ TypeId PacketUdpSender::GetTypeId() {
             UintegerValue (2),
             MakeUintegerAccessor (&PacketUdpSender::m_measureWindow),
             MakeUintegerChecker<uint16_t> ())
+        .AddAttribute ("Pacing", "Pace packets over the frame deadline instead of sending them back to back",
+            BooleanValue (false),
+            MakeBooleanAccessor (&PacketUdpSender::m_pacing),
+            MakeBooleanChecker ())
+        .AddAttribute ("BurstPackets", "Number of packets sent per pacing tick (Pacing only)",
+            UintegerValue (1),
+            MakeUintegerAccessor (&PacketUdpSender::m_burstPkts),
+            MakeUintegerChecker<uint32_t> (1))
     ;
     return tid;
 };
@@ -93,6 +101,7 @@ PacketUdpSender::PacketUdpSender (void)
 , m_firstFeedback {true}
 , m_controller {NULL}
 , m_pacing {false}
+, m_burstPkts {1}
 , m_pacing_interval {MilliSeconds(0)}
 , m_pacingTimer {Timer::CANCEL_ON_DESTROY}
 , m_eventSend {}
@@ -108,6 +117,8 @@ PacketUdpSender::PacketUdpSender (void)
     // init frame index
     m_nextGroupId = 0;
     m_nextBatchId = 0;
+    m_rtxHistoryDirty = true;
+    m_rtxWakeTime = Time (0);
     this->fps = fps;
     this->send_group_cnt = 0;
 
@@ -241,7 +252,9 @@ void PacketUdpSender::StopRunning(){
     GetBandwidthLossRate();
     this->check_rtx_event.Cancel();
     PacketSender::StopRunning();
-    m_socket->Close();
+    if (m_socket) {
+        m_socket->Close();
+    }
 }
 
 void PacketUdpSender::SetController (std::string cca) {
@@ -410,7 +423,27 @@ void PacketUdpSender::StorePackets (std::vector<Ptr<VideoPacket>> pkts) {
       dataPkt->GetDataGlobalId (), dataPkt->GetGlobalId ());
     info->m_sendTime = Simulator::Now ();
     m_dataPktHistoryKey.push_back (info);
-    m_dataPktHistory[info->m_groupId][info->m_pktIdInGroup] = dataPkt;
+    m_dataPktHistory[info->m_groupId].Set (info->m_pktIdInGroup, dataPkt);
+    m_rtxHistoryDirty = true;
+  }
+};
+
+Ptr<DataPacket> PacketUdpSender::GroupDataPkts::Get (uint16_t pktId) const {
+  return pktId < m_pkts.size () ? m_pkts[pktId] : nullptr;
+};
+
+void PacketUdpSender::GroupDataPkts::Set (uint16_t pktId, Ptr<DataPacket> pkt) {
+  if (pktId >= m_pkts.size ())
+    m_pkts.resize (pktId + 1);
+  if (m_pkts[pktId] == nullptr)
+    m_cnt ++;
+  m_pkts[pktId] = pkt;
+};
+
+void PacketUdpSender::GroupDataPkts::Erase (uint16_t pktId) {
+  if (pktId < m_pkts.size () && m_pkts[pktId] != nullptr) {
+    m_pkts[pktId] = nullptr;
+    m_cnt --;
   }
 };
 
@@ -420,10 +453,13 @@ Time PacketUdpSender::GetDispersion (Ptr<DataPacket> pkt) {
 }
 
 bool PacketUdpSender::IsRtxTimeout (Ptr<DataPacket> pkt, Time rto) {
-  Time now = Simulator::Now ();
+  // Decide if the packet needs to be retransmitted
+  return Simulator::Now () > GetRtxDeadline (pkt, rto);
+};
+
+Time PacketUdpSender::GetRtxDeadline (Ptr<DataPacket> pkt, Time rto) {
   Time enqueueTime = pkt->GetEnqueueTime ();
   Time lastSendTime = pkt->GetSendTime ();
-  // Decide if the packet needs to be retransmitted
   if (rto == Time (0)) {
     /* rto = max (avg + 4 * stdev, 2 * avg) 
        basically following the pto plan from 
@@ -433,7 +469,7 @@ bool PacketUdpSender::IsRtxTimeout (Ptr<DataPacket> pkt, Time rto) {
     rto = Max (m_netStat->srtt + 4 * m_netStat->rttSd, 2 * m_netStat->srtt);
   }
   rto += GetDispersion (pkt) + MicroSeconds (500);
-  return (now > enqueueTime && (now - lastSendTime > rto));
+  return Max (enqueueTime, lastSendTime + rto);
 };
 
 
@@ -583,9 +619,11 @@ void PacketUdpSender::RetransmitGroup (uint32_t groupId) {
 
   std::deque<Ptr<DataPacket>> dataPktRtxQueue;
 
-  auto groupDataPkt = m_dataPktHistory[groupId];
+  auto groupDataPkt = m_dataPktHistory[groupId].Pkts ();
   // find all packets that belong to the same group and retransmit them
-  for (const auto& [pktId, dataPkt] : groupDataPkt) {
+  for (const auto& dataPkt : groupDataPkt) {
+    if (dataPkt == nullptr)
+      continue;
     if (txCnt == -1) 
       txCnt = dataPkt->GetTXCount () + 1;
     if (encodeTime == Time (0)) 
@@ -596,6 +634,8 @@ void PacketUdpSender::RetransmitGroup (uint32_t groupId) {
     dataPkt->ClearFECBatch ();
     dataPktRtxQueue.push_back (dataPkt);
   }
+  NS_LOG_INFO ("[Sender] At " << now.GetMicroSeconds () << " us rtx group " << groupId
+    << ", " << dataPktRtxQueue.size () << " packets, tx count " << txCnt);
   for (auto it = m_dataPktHistoryKey.begin (); it != m_dataPktHistoryKey.end ();) {
     Ptr<GroupPacketInfo> info = *it;
     if (info->m_groupId == groupId)
@@ -603,7 +643,7 @@ void PacketUdpSender::RetransmitGroup (uint32_t groupId) {
     else
       it ++;
   }
-  groupDataPkt.clear ();
+  m_rtxHistoryDirty = true;
 
   if (!dataPktRtxQueue.empty ()) {
     m_lossEstimator->RtxUpdate (dataPktRtxQueue.size (), Simulator::Now ());
@@ -618,18 +658,26 @@ void PacketUdpSender::CheckRetransmission () {
   this->check_rtx_event = Simulator::Schedule (this->check_rtx_interval, 
     &PacketUdpSender::CheckRetransmission, this);
 
+  /* The walks below only give a different answer than in the last tick if
+     the history changed (acks, new or retransmitted packets), the rtt
+     estimates changed, or some packet reached its minRtt / rto deadline.
+     Otherwise only the expired entries at the front and the expired
+     delayed rtx groups are touched.
+     Hairpin re-postpones the groups of received packets on every tick while
+     srtt > 2 * lastRtt, so that regime always takes the full walk. */
+  bool hairpinPostpone = m_netStat->srtt > 2 * m_lastRtt && m_fecPolicy->GetFecName () == "HairpinPolicy";
+  bool fullWalk = hairpinPostpone || m_rtxHistoryDirty || now >= m_rtxWakeTime ||
+    m_netStat->srtt != m_rtxSrtt || m_netStat->rttSd != m_rtxRttSd ||
+    m_netStat->minRtt != m_rtxMinRtt || m_netStat->oneWayDispersion != m_rtxDispersion;
+
   bool isFront = true;
   /* 1) check for packets that will definitely miss ddl */
   for (auto it = m_dataPktHistoryKey.begin (); it != m_dataPktHistoryKey.end ();) {
     Ptr<GroupPacketInfo> info = (*it);
     if (info->m_state != GroupPacketInfo::PacketState::RCVD_PREV_DATA) {
       // if we cannot find it in m_dataPktHistory, and it's not a fake hole (data rcvd)
-      if (m_dataPktHistory.find (info->m_groupId) == m_dataPktHistory.end ()) {
-        it = m_dataPktHistoryKey.erase (it);
-        continue;
-      }
-      auto groupDataPkt = &m_dataPktHistory[info->m_groupId];
-      if (groupDataPkt->find (info->m_pktIdInGroup) == groupDataPkt->end ()) {
+      auto groupIt = m_dataPktHistory.find (info->m_groupId);
+      if (groupIt == m_dataPktHistory.end () || groupIt->second.Get (info->m_pktIdInGroup) == nullptr) {
         it = m_dataPktHistoryKey.erase (it);
         continue;
       }
@@ -637,17 +685,25 @@ void PacketUdpSender::CheckRetransmission () {
 
     // we can find it in m_dataPktHistory, check if it's timed out
     if (isFront && (info->m_state == GroupPacketInfo::PacketState::RCVD_PREV_DATA || 
-        MissesDdl (m_dataPktHistory[info->m_groupId][info->m_pktIdInGroup]))) {
+        MissesDdl (m_dataPktHistory[info->m_groupId].Get (info->m_pktIdInGroup)))) {
       /* only remove pkts from begin ()! otherwise will create holes 
          remove it in m_dataPktHistory */
-      m_dataPktHistory[info->m_groupId].erase (info->m_pktIdInGroup);
-      if (m_dataPktHistory[info->m_groupId].empty ())
-        m_dataPktHistory.erase (info->m_groupId);
+      auto groupIt = m_dataPktHistory.find (info->m_groupId);
+      if (groupIt != m_dataPktHistory.end ()) {
+        groupIt->second.Erase (info->m_pktIdInGroup);
+        if (groupIt->second.Empty ())
+          m_dataPktHistory.erase (groupIt);
+      }
+      if (info->m_state == GroupPacketInfo::PacketState::RCVD_PREV_DATA)
+        fullWalk = true;
       it = m_dataPktHistoryKey.erase (it);
     } else {
       // it's not a FIFO queue -- rtx packets are put to the end
       // we need to check if packets behind the first non-timeout packet will timeout
       isFront = false;
+      // nothing behind the front can have changed since the last full walk
+      if (!fullWalk)
+        break;
       it ++;
     }
   }
@@ -655,8 +711,19 @@ void PacketUdpSender::CheckRetransmission () {
   /* 2) check for packets that exceeds rtx timer, needs to be retransmitted */
   std::unordered_set<uint32_t> rtxGroupId;
 
-  /* Check if there are delayed rtx that is exactly the time to retransmit */
-  for (auto it = m_delayedRtxGroup.begin (); it != m_delayedRtxGroup.end ();) {
+  /* Check if there are delayed rtx that is exactly the time to retransmit.
+     The heap only tells whether one is due: the due groups are then taken
+     in the order of m_delayedRtxGroup, which is the order they are sent in. */
+  bool delayedRtxDue = false;
+  while (!m_delayedRtxHeap.empty () && m_delayedRtxHeap.top ().first < now) {
+    auto delayedIt = m_delayedRtxGroup.find (m_delayedRtxHeap.top ().second);
+    if (delayedIt != m_delayedRtxGroup.end () && delayedIt->second == m_delayedRtxHeap.top ().first) {
+      delayedRtxDue = true;
+      break;
+    }
+    m_delayedRtxHeap.pop ();   /* stale: rescheduled or already retransmitted */
+  }
+  for (auto it = m_delayedRtxGroup.begin (); delayedRtxDue && it != m_delayedRtxGroup.end ();) {
     uint32_t groupId = (*it).first;
     Time rtxTime = (*it).second;
     if (rtxTime < now) {
@@ -675,8 +742,9 @@ void PacketUdpSender::CheckRetransmission () {
     return;
   }
 
-  bool isLoop = true;
+  bool isLoop = fullWalk;
   bool hasHole = false;    /* whether we have found the first rtx packet or not */
+  Time wakeTime = Time::Max ();
   for (auto it = m_dataPktHistoryKey.end () - 1; isLoop && !m_dataPktHistoryKey.empty (); ) {
     bool shouldRtx = false;
     Ptr<DataPacket> pkt;
@@ -688,17 +756,19 @@ void PacketUdpSender::CheckRetransmission () {
        this must be checked before the intialization of pkt = m_dataPktHistory, 
        otherwise there will be nullptr inside. */
     if (info->m_state == GroupPacketInfo::PacketState::RCVD_PREV_DATA) {
-      if (m_netStat->srtt > 2 * m_lastRtt && m_fecPolicy->GetFecName () == "HairpinPolicy") {
-        m_delayedRtxGroup[info->m_groupId] = now + m_lastRtt;
+      if (hairpinPostpone) {
+        SetDelayedRtx (info->m_groupId, now + m_lastRtt);
       }
       goto continueLoop;
     }
     
-    pkt = m_dataPktHistory[info->m_groupId][info->m_pktIdInGroup];
+    pkt = m_dataPktHistory[info->m_groupId].Get (info->m_pktIdInGroup);
 
     /* this packet is too early to retransmit */
-    if (now - pkt->GetEncodeTime () < m_netStat->minRtt)
+    if (now - pkt->GetEncodeTime () < m_netStat->minRtt) {
+      wakeTime = Min (wakeTime, pkt->GetEncodeTime () + m_netStat->minRtt);
       goto continueLoop;
+    }
 
     /* this group has just been retransmitted */
     if (rtxGroupId.find (pkt->GetGroupId ()) != rtxGroupId.end ())
@@ -724,20 +794,22 @@ void PacketUdpSender::CheckRetransmission () {
     if (hasHole) {
       /* If we detect a packet loss, be patient till dispersion */
       m_isRecovery = false; /* already found a hole, continue to find the next hole */
-      if (m_delayedRtxGroup.find (pkt->GetGroupId ()) == m_delayedRtxGroup.end ())
-        m_delayedRtxGroup[pkt->GetGroupId ()] = now + GetDispersion (pkt);
-      else
-        m_delayedRtxGroup[pkt->GetGroupId ()] = Min (m_delayedRtxGroup[pkt->GetGroupId ()], now + GetDispersion (pkt));
+      auto delayedIt = m_delayedRtxGroup.find (pkt->GetGroupId ());
+      if (delayedIt == m_delayedRtxGroup.end ())
+        SetDelayedRtx (pkt->GetGroupId (), now + GetDispersion (pkt));
+      else if (now + GetDispersion (pkt) < delayedIt->second)
+        SetDelayedRtx (pkt->GetGroupId (), now + GetDispersion (pkt));
     }
     
-    if (m_rtxPolicy == "pto") {
+    {
       /* For PTO, we can find it in m_dataPktHistory, check if it's timed out
          if this packet has not arrived at client
          do not retransmit it and all the packets behind 
-         Specifically, PTO first goes through dupack, and then pto. */
-      shouldRtx = IsRtxTimeout (pkt, Time (0));
-    } else {
-      shouldRtx = IsRtxTimeout (pkt, Seconds (1));   /* TCP RTO mechanism */
+         Specifically, PTO first goes through dupack, and then pto.
+         Otherwise follow the TCP RTO mechanism. */
+      Time rtxDeadline = GetRtxDeadline (pkt, m_rtxPolicy == "pto" ? Time (0) : Seconds (1));
+      shouldRtx = now > rtxDeadline;
+      wakeTime = Min (wakeTime, rtxDeadline);
     }
 
     if (shouldRtx) {
@@ -754,6 +826,15 @@ continueLoop:
     lastDataGlobalId = info->m_dataGlobalId;
   }
 
+  if (fullWalk) {
+    m_rtxHistoryDirty = false;
+    m_rtxWakeTime = wakeTime;
+    m_rtxSrtt = m_netStat->srtt;
+    m_rtxRttSd = m_netStat->rttSd;
+    m_rtxMinRtt = m_netStat->minRtt;
+    m_rtxDispersion = m_netStat->oneWayDispersion;
+  }
+
   /* Retransmit all the lost packets found in this round 
      We can only retransmit in the end because we're now iterating 
      from the newest to the oldest */
@@ -769,9 +850,15 @@ continueLoop:
   m_lastRtt = m_netStat->srtt;
 };
 
+void PacketUdpSender::SetDelayedRtx (uint32_t groupId, Time rtxTime) {
+  m_delayedRtxGroup[groupId] = rtxTime;
+  m_delayedRtxHeap.push (std::make_pair (rtxTime, groupId));
+};
+
 /* Remove packet history records when we receive an ACK packet */
 void PacketUdpSender::RcvACKPacket (Ptr<AckPacket> ackPkt) {
   std::vector<Ptr<GroupPacketInfo>> pktInfos = ackPkt->GetAckedPktInfos ();
+  m_rtxHistoryDirty = true;
 
   for (Ptr<GroupPacketInfo> pktInfo : pktInfos) {
    if (!m_isRecovery) {
@@ -782,15 +869,13 @@ void PacketUdpSender::RcvACKPacket (Ptr<AckPacket> ackPkt) {
     }
     m_curRxHighestGlobalId = pktInfo->m_globalId;
     // find the packet in m_dataPktHistory
-    if (m_dataPktHistory.find (pktInfo->m_groupId) != m_dataPktHistory.end ()) {
-      auto groupDataPkt = &m_dataPktHistory[pktInfo->m_groupId];
-      if (groupDataPkt->find (pktInfo->m_pktIdInGroup) != groupDataPkt->end ()) {
-        // erase pkt_id_in_frame
-        groupDataPkt->erase (pktInfo->m_pktIdInGroup);
-      }
+    auto groupIt = m_dataPktHistory.find (pktInfo->m_groupId);
+    if (groupIt != m_dataPktHistory.end ()) {
+      // erase pkt_id_in_frame
+      groupIt->second.Erase (pktInfo->m_pktIdInGroup);
       // erase frame_id if neccesary
-      if (m_dataPktHistory[pktInfo->m_groupId].empty ()) {
-        m_dataPktHistory.erase (pktInfo->m_groupId);
+      if (groupIt->second.Empty ()) {
+        m_dataPktHistory.erase (groupIt);
       }
     }
     for (auto it = m_dataPktHistoryKey.begin (); it != m_dataPktHistoryKey.end ();) {
@@ -812,6 +897,7 @@ void PacketUdpSender::RcvACKPacket (Ptr<AckPacket> ackPkt) {
 
 void PacketUdpSender::RcvFrameAckPacket (Ptr<FrameAckPacket> frameAckPkt) {
   uint32_t frameId = frameAckPkt->GetFrameId ();
+  m_rtxHistoryDirty = true;
   for (auto groupId : m_frameIdToGroupId[frameId]) {
     if (m_dataPktHistory.find (groupId) != m_dataPktHistory.end ()) {
       m_dataPktHistory.erase (groupId);
@@ -854,7 +940,7 @@ void PacketUdpSender::SendRtx (std::vector<Ptr<VideoPacket>> packets)
     NS_LOG_FUNCTION("At time " << Simulator::Now().GetMilliSeconds() << ", " << packets.size() << " RTX packets are enqueued");
     Ptr<PacketFrame> newFrame = Create<PacketFrame>(packets,true);
     newFrame->Frame_encode_time_ = packets[0]->GetEncodeTime();
-    m_queue.insert(m_queue.begin(),newFrame);
+    m_queue.push_front(newFrame);
     this->Calculate_pacing_rate();
     if(m_pacing){
         if(m_pacingTimer.IsExpired()){
@@ -870,6 +956,8 @@ void PacketUdpSender::Calculate_pacing_rate()
 {
     Time time_now = Simulator::Now();
     uint32_t num_packets_left = 0;
+    // the tightest interval over the queued frames, recomputed from scratch
+    m_pacing_interval = Time::Max ();
     for(uint32_t i=0;i<this->num_frame_in_queue();i++) {
         if(m_queue[i]->retransmission) {
             continue;
@@ -891,6 +979,9 @@ void PacketUdpSender::Calculate_pacing_rate()
             }
         }
     }
+    if (m_pacing_interval == Time::Max ()) {
+        m_pacing_interval = m_pacingTimer.GetDelay ();
+    }
 };
 
 void PacketUdpSender::OnSocketRecv_sender(Ptr<Socket> socket)
@@ -1156,60 +1247,65 @@ void PacketUdpSender::Resume()
 
 void PacketUdpSender::SockSendPacket ()
 {
-    Time time_now = Simulator::Now();
-    uint64_t NowUs = time_now.GetMicroSeconds();
-    if(this->num_frame_in_queue() > 0){
-        std::vector<Ptr<VideoPacket>>* current_frame = &m_queue[0]->packets_in_Frame;
-        std::vector<Ptr<VideoPacket>>::iterator firstPkt = current_frame->begin();
-        Ptr<VideoPacket> netPktToSend = *firstPkt;
-        PacketType pktType = netPktToSend->GetPacketType ();
-        netPktToSend->SetSendTime (time_now);
-        netPktToSend->SetGlobalId (m_netGlobalId);
-        if (pktType == PacketType::DATA_PKT) {
-            Ptr<DataPacket> dataPkt = DynamicCast<DataPacket, VideoPacket> (netPktToSend);
-            dataPkt->SetDataGlobalId (m_dataGlobalId);
-            m_dataGlobalId = (m_dataGlobalId + 1) % 65536;
-        }
-        bool is_goodput = (pktType == PacketType::DATA_PKT)
-                            && (netPktToSend->GetTXCount() == 0);
-
-        Ptr<Packet> pktToSend = netPktToSend->ToNetPacket ();
-        uint16_t pkt_size = pktToSend->GetSize();
-        if (m_ccEnabled) {
-            // handle pkt information to cc controller
-            m_controller->processSendPacket (NowUs, m_netGlobalId, pktToSend->GetSize());
-        }
-
-        // statistics
-        if (is_goodput) {
-            this->init_data_pkt_count ++;
-            this->init_data_pkt_size += pkt_size;
-            this->goodput_pkts_inwnd += pkt_size;
-        } else {
-            this->other_pkt_count ++;
-            this->other_pkt_size += pkt_size;
+    uint32_t budget = m_pacing ? m_burstPkts : UINT32_MAX;
+    uint32_t sent = 0;
+    while (sent < budget && this->num_frame_in_queue() > 0) {
+        Ptr<PacketFrame> current_frame = m_queue.front();
+        Ptr<VideoPacket> netPktToSend = current_frame->packets_in_Frame[current_frame->next_pkt_idx];
+        current_frame->packets_in_Frame[current_frame->next_pkt_idx] = NULL;
+        current_frame->next_pkt_idx ++;
+        SockSendOnePacket (netPktToSend);
+        sent ++;
+
+        if(current_frame->Frame_size_in_packet() == 0){
+            m_queue.pop_front();
+            this->Calculate_pacing_rate();
         }
-        this->total_pkts_inwnd += pkt_size;
+    }
+    if(m_pacing && sent > 0){
+        // keep the average rate at one packet per pacing interval
+        m_pacingTimer.Schedule(m_pacingTimer.GetDelay() * sent);
+    }
+};
 
-        DEBUG("[Sender] At " << Simulator::Now().GetMilliSeconds() << " Send packet " << netPktToSend->GetGlobalId() << ", Group id: " << netPktToSend->GetGroupId());
-        m_socket->Send(pktToSend);
+void PacketUdpSender::SockSendOnePacket (Ptr<VideoPacket> netPktToSend)
+{
+    Time time_now = Simulator::Now();
+    uint64_t NowUs = time_now.GetMicroSeconds();
+    PacketType pktType = netPktToSend->GetPacketType ();
+    netPktToSend->SetSendTime (time_now);
+    netPktToSend->SetGlobalId (m_netGlobalId);
+    if (pktType == PacketType::DATA_PKT) {
+        Ptr<DataPacket> dataPkt = DynamicCast<DataPacket, VideoPacket> (netPktToSend);
+        dataPkt->SetDataGlobalId (m_dataGlobalId);
+        m_dataGlobalId = (m_dataGlobalId + 1) % 65536;
+    }
+    bool is_goodput = (pktType == PacketType::DATA_PKT)
+                        && (netPktToSend->GetTXCount() == 0);
 
-        current_frame->erase (firstPkt);
+    Ptr<Packet> pktToSend = netPktToSend->ToNetPacket ();
+    uint16_t pkt_size = pktToSend->GetSize();
+    if (m_ccEnabled) {
+        // handle pkt information to cc controller
+        m_controller->processSendPacket (NowUs, m_netGlobalId, pktToSend->GetSize());
+    }
 
-        m_netGlobalId = (m_netGlobalId + 1) % 65536;
+    // statistics
+    if (is_goodput) {
+        this->init_data_pkt_count ++;
+        this->init_data_pkt_size += pkt_size;
+        this->goodput_pkts_inwnd += pkt_size;
+    } else {
+        this->other_pkt_count ++;
+        this->other_pkt_size += pkt_size;
+    }
+    this->total_pkts_inwnd += pkt_size;
 
-        if(current_frame->empty()){
-            m_queue.erase(m_queue.begin());
-            this->Calculate_pacing_rate();
-        }
-        if(m_pacing){
-            m_pacingTimer.Schedule();
-        }
-        else {
-            SockSendPacket ();
-        }
+    DEBUG("[Sender] At " << Simulator::Now().GetMilliSeconds() << " Send packet " << netPktToSend->GetGlobalId() << ", Group id: " << netPktToSend->GetGroupId());
+    TagPacket(pktToSend);
+    m_socket->Send(pktToSend);
 
-    }
+    m_netGlobalId = (m_netGlobalId + 1) % 65536;
 };
 
 uint32_t PacketUdpSender::num_frame_in_queue()
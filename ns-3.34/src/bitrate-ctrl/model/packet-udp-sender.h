@@ -111,10 +111,16 @@ protected:
 
 private:
     /**
-     * \brief Send a packet to the network
+     * \brief Send queued packets to the network: the whole queue without pacing,
+     * up to m_burstPkts packets per pacing tick otherwise
      */
     void SockSendPacket ();
 
+    /**
+     * \brief Send a packet to the network
+     */
+    void SockSendOnePacket (Ptr<VideoPacket> netPktToSend);
+
     /**
      * \brief Burstly send packets to the network
      */
@@ -133,7 +139,7 @@ private:
 
     Ptr<FECPolicy::NetStat> m_netStat; /* stats used for FEC para calculation */
 
-    std::vector<Ptr<PacketFrame>> m_queue; /* Queue storing packets by frames */
+    std::deque<Ptr<PacketFrame>> m_queue; /* Queue storing packets by frames, sent from the front */
 
     //std::vector<Ptr<VideoPacket>> pkts_sent;
 
@@ -179,6 +185,8 @@ private:
     /* pacing-related variables */
     bool m_pacing; // whether to turn on pacing
 
+    uint32_t m_burstPkts; // packets sent per pacing tick
+
     Time m_pacing_interval; /* the time interval before calling the next SendPacket() */
 
     Timer m_pacingTimer;
@@ -232,9 +240,22 @@ private:
     
     std::deque<Ptr<GroupPacketInfo>> m_dataPktHistoryKey;     /* in time order */
 
-    /* (GroupId, pkt_id_group) -> Packet */
-    std::unordered_map<
-        uint32_t, std::map<uint16_t, Ptr<DataPacket>>> m_dataPktHistory;    /* Packets sent in the past ddl, temporary */
+    /* Data packets of one group, in a flat array indexed by pkt_id_group */
+    class GroupDataPkts {
+    public:
+        Ptr<DataPacket> Get (uint16_t pktId) const;
+        void Set (uint16_t pktId, Ptr<DataPacket> pkt);
+        void Erase (uint16_t pktId);
+        bool Empty () const { return m_cnt == 0; };
+        /* in pkt_id_group order, nullptr for acked or expired slots */
+        const std::vector<Ptr<DataPacket>>& Pkts () const { return m_pkts; };
+    private:
+        std::vector<Ptr<DataPacket>> m_pkts;
+        uint16_t m_cnt = 0;
+    };
+
+    /* GroupId -> packets of the group */
+    std::unordered_map<uint32_t, GroupDataPkts> m_dataPktHistory;    /* Packets sent in the past ddl, temporary */
     std::unordered_map<
         uint32_t, std::deque<uint32_t>> m_frameIdToGroupId; /* frame_id -> group_id */
     /* Record how many data packets there are in a frame */
@@ -245,7 +266,16 @@ private:
     uint16_t m_curContRxHighestGlobalId;
     bool m_isRecovery;
     std::unordered_map<uint32_t, Time> m_delayedRtxGroup;
+    /* (rtx time, group id) ordered by rtx time. An entry whose time no longer
+       matches m_delayedRtxGroup is stale and dropped when it reaches the top */
+    std::priority_queue<std::pair<Time, uint32_t>, std::vector<std::pair<Time, uint32_t>>,
+        std::greater<std::pair<Time, uint32_t>>> m_delayedRtxHeap;
     Time m_lastRtt;
+    /* The dup-ack / rto walk over m_dataPktHistoryKey only needs to run when
+       the history or the rtt estimates changed, or a packet hits a deadline */
+    bool m_rtxHistoryDirty;
+    Time m_rtxWakeTime;         /* earliest minRtt / rto deadline seen in the last walk */
+    Time m_rtxSrtt, m_rtxRttSd, m_rtxMinRtt, m_rtxDispersion;  /* netStat used by the last walk */
     Time m_lastAckTime;
 
     uint32_t m_nextGroupId;  /* accumulated */
@@ -322,6 +352,14 @@ private:
 
     bool IsRtxTimeout (Ptr<DataPacket> packet, Time rto);
 
+    /**
+     * \brief Time after which IsRtxTimeout (packet, rto) becomes true,
+     * as long as the rtt estimates do not change
+     */
+    Time GetRtxDeadline (Ptr<DataPacket> packet, Time rto);
+
+    void SetDelayedRtx (uint32_t groupId, Time rtxTime);
+
 
     /**
      * \brief Store data packets for retransmission
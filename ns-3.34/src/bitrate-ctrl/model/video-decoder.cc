@@ -69,9 +69,16 @@ VideoDecoder::VideoDecoder(Time delay_ddl, uint16_t fps, GameClient * game_clien
     m_frameInterval = 1000 / fps;
     m_port = port;
     m_appTrStream = appTrStream;
+    m_lastDecodeTime = Time(-1);
+    m_stallCnt = 0;
+    m_discardCnt = 0;
 };
 
-VideoDecoder::VideoDecoder() {
+VideoDecoder::VideoDecoder()
+: m_lastDecodeTime{Time(-1)}
+, m_stallCnt{0}
+, m_discardCnt{0}
+{
 
 };
 
@@ -95,6 +102,7 @@ void VideoDecoder::DecodeDataPacket(std::vector<Ptr<DataPacket>> pkts) {
             this->unplayed_frames.erase(idx);
             *m_appTrStream->GetStream () << Simulator::Now().GetMilliSeconds() << 
                 " FlowId " << m_port << " Discard frame " << idx << std::endl;
+            m_discardCnt ++;
             m_lastPlayedFrameId = idx;
             for (uint32_t ith = idx + 1; ith <= this->max_frame_id; ith++){
                 if (this->unplayed_frames.find(ith) != this->unplayed_frames.end()){
@@ -102,6 +110,7 @@ void VideoDecoder::DecodeDataPacket(std::vector<Ptr<DataPacket>> pkts) {
                         this->played_frames[ith] = this->unplayed_frames[ith];
                         this->unplayed_frames.erase(ith);     
                         m_lastPlayedFrameId = ith;
+                        RecordDecodedFrame(this->played_frames[ith]);
                         Time time_now = Simulator::Now();
                         *m_appTrStream->GetStream () << Simulator::Now().GetMilliSeconds() << 
                             " FlowId " << m_port <<
@@ -130,6 +139,7 @@ void VideoDecoder::DecodeDataPacket(std::vector<Ptr<DataPacket>> pkts) {
                     this->played_frames[frame_id] = this->unplayed_frames[frame_id];
                     this->unplayed_frames.erase(frame_id);   
                     m_lastPlayedFrameId = 0;    
+                    RecordDecodedFrame(this->played_frames[frame_id]);
                     Time time_now = Simulator::Now();
                     *m_appTrStream->GetStream () << Simulator::Now().GetMilliSeconds() << 
                         " FlowId " << m_port << " Decode frame " << frame_id << std::endl;
@@ -141,6 +151,7 @@ void VideoDecoder::DecodeDataPacket(std::vector<Ptr<DataPacket>> pkts) {
                                 this->played_frames[idx] = this->unplayed_frames[idx];
                                 this->unplayed_frames.erase(idx);     
                                 m_lastPlayedFrameId = idx;
+                                RecordDecodedFrame(this->played_frames[idx]);
                                 Time time_now = Simulator::Now();
                                 *m_appTrStream->GetStream () << Simulator::Now().GetMilliSeconds() << 
                                     " FlowId " << m_port << " Decode frame " << idx << std::endl;                
@@ -172,6 +183,24 @@ void VideoDecoder::DecodeDataPacket(std::vector<Ptr<DataPacket>> pkts) {
     }
 };
 
+void VideoDecoder::RecordDecodedFrame(Ptr<VideoFrame> frame) {
+    Time now = Simulator::Now();
+    this->m_frameDelays.push_back(frame->GetFrameDelay());
+    if (m_lastDecodeTime >= Time(0) && now - m_lastDecodeTime > MilliSeconds(STALL_THRESHOLD_MS))
+        m_stallCnt ++;
+    m_lastDecodeTime = now;
+};
+
+const std::vector<Time> & VideoDecoder::GetFrameDelays() { return this->m_frameDelays; };
+
+uint32_t VideoDecoder::GetStallCount(Time end) {
+    if (m_lastDecodeTime >= Time(0) && end - m_lastDecodeTime > MilliSeconds(STALL_THRESHOLD_MS))
+        return m_stallCnt + 1;
+    return m_stallCnt;
+};
+
+uint32_t VideoDecoder::GetDiscardedFrameCount() { return m_discardCnt; };
+
 double_t VideoDecoder::GetDDLMissRate() {
     /* ddl miss rate = missed_frames / all_frames */
     uint64_t frame_rcvd_cnt = played_frames.size(),
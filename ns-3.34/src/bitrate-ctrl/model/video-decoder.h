@@ -50,6 +50,15 @@ private:
 
     std::set<uint32_t> exclude_ten_played_frames;
 
+    /* per-frame statistics kept in memory for end-of-run latency reports */
+    static const uint32_t STALL_THRESHOLD_MS = 200;  /* gap between decoded frames counted as a stall */
+    std::vector<Time> m_frameDelays;    /* GetFrameDelay() of every decoded frame */
+    Time m_lastDecodeTime;
+    uint32_t m_stallCnt;
+    uint32_t m_discardCnt;
+
+    void RecordDecodedFrame(Ptr<VideoFrame> frame);
+
     GameClient * game_client;
     uint16_t m_port;
     void (GameClient::*ReplyFrameAck)(uint32_t, Time);
@@ -58,6 +67,10 @@ private:
 public:
     void DecodeDataPacket(std::vector<Ptr<DataPacket>> pkts);
     double_t GetDDLMissRate();
+    const std::vector<Time> & GetFrameDelays();
+    /* stalls up to end, a gap still open at end (the stream stopped decoding) included */
+    uint32_t GetStallCount(Time end);
+    uint32_t GetDiscardedFrameCount();
 
 }; // class VideoDecoder
 
@@ -21,6 +21,7 @@
 
 #include "command-line.h"
 #include "des-metrics.h"
+#include "event-profiler.h"
 #include "log.h"
 #include "config.h"
 #include "global-value.h"
@@ -144,6 +145,13 @@ CommandLine::Parse (std::vector<std::string> args)
 
   m_nonOptionCount = 0;
 
+#ifdef ENABLE_EVENT_PROFILER
+  if (args.size () > 0)
+    {
+      EventProfiler::Get ()->Initialize (args[0]);
+    }
+#endif
+
   if (args.size () > 0)
     {
       args.erase (args.begin ());  // discard the program name
@@ -27,6 +27,8 @@
 #include "log.h"
 
 #include <sstream>
+#include <deque>
+#include <algorithm>
 
 /**
  * \file
@@ -320,6 +322,13 @@ public:
   void Resolve (Ptr<Object> root);
 
 private:
+  /**
+   * Handle an object the walk goes through to match the next path token.
+   *
+   * \param [in] object The object, or 0 for the root of the "/Names"
+   *                    namespace.
+   */
+  virtual void DoVisit (const Object *object);
   /** Ensure the Config path starts and ends with a '/'. */
   void Canonicalize (void);
   /**
@@ -415,6 +424,12 @@ Resolver::GetResolvedPath (void) const
   return fullPath;
 }
 
+void
+Resolver::DoVisit (const Object *object)
+{
+  NS_UNUSED (object);
+}
+
 void
 Resolver::DoResolveOne (Ptr<Object> object)
 {
@@ -449,6 +464,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     }
   std::string item = path.substr (1, next - 1);
   std::string pathLeft = path.substr (next, path.size () - next);
+  DoVisit (PeekPointer (root));
 
   //
   // If root is zero, we're beginning to see if we can use the object name
@@ -633,6 +649,12 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
+  /**
+   * \param [in] path The path to perform a match against
+   * \param [out] visited The objects the walk went through, sorted
+   * \returns A container which contains all the objects which match the path.
+   */
+  MatchContainer LookupMatches (std::string path, std::vector<const Object *> *visited);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -644,6 +666,21 @@ public:
   /** \copydoc Config::GetRootNamespaceObject() */
   Ptr<Object> GetRootNamespaceObject (std::size_t i) const;
 
+  /** \copydoc Config::NotifyNamespaceChanged(void) */
+  void NotifyNamespaceChanged (void);
+  /** \copydoc Config::NotifyNamespaceChanged(const Object*) */
+  void NotifyNamespaceChanged (const Object *container);
+  /**
+   * \returns The number of changes of the namespace so far.
+   */
+  uint64_t GetGeneration (void) const;
+  /**
+   * \param [in] generation The number of changes of the namespace at a walk
+   * \param [in] visited The objects the walk went through, sorted
+   * \returns \c true if a change since the walk may change its result.
+   */
+  bool ChangedSince (uint64_t generation, const std::vector<const Object *> &visited) const;
+
 private:
   /**
    * Break a Config path into the leading path and the last leaf token.
@@ -659,6 +696,14 @@ private:
 
   /** The list of Config path roots. */
   Roots m_roots;
+  /** The number of changes of the namespace so far. */
+  uint64_t m_generation {0};
+  /** The last change which concerns every path, or which was forgotten. */
+  uint64_t m_changedAll {0};
+  /** The recent changes, with the container each of them was made to. */
+  std::deque<std::pair<uint64_t, const Object *> > m_changes;
+  /** The number of recent changes kept. */
+  static const std::size_t MAX_CHANGES = 1024;
 
 };  // class ConfigImpl
 
@@ -751,11 +796,19 @@ MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  return LookupMatches (path, 0);
+}
+
+MatchContainer
+ConfigImpl::LookupMatches (std::string path, std::vector<const Object *> *visited)
+{
+  NS_LOG_FUNCTION (this << path << visited);
   class LookupMatchesResolver : public Resolver
   {
 public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (std::string path, std::vector<const Object *> *visited)
+      : Resolver (path),
+        m_visited (visited)
     {
     }
     virtual void DoOne (Ptr<Object> object, std::string path)
@@ -763,9 +816,17 @@ public:
       m_objects.push_back (object);
       m_contexts.push_back (path);
     }
+    virtual void DoVisit (const Object *object)
+    {
+      if (m_visited != 0)
+        {
+          m_visited->push_back (object);
+        }
+    }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+    std::vector<const Object *> *m_visited;
+  } resolver = LookupMatchesResolver (path, visited);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -778,6 +839,11 @@ public:
   //
   resolver.Resolve (0);
 
+  if (visited != 0)
+    {
+      std::sort (visited->begin (), visited->end ());
+      visited->erase (std::unique (visited->begin (), visited->end ()), visited->end ());
+    }
   return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
 }
 
@@ -786,6 +852,7 @@ ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (this << obj);
   m_roots.push_back (obj);
+  NotifyNamespaceChanged ();
 }
 
 void
@@ -798,6 +865,7 @@ ConfigImpl::UnregisterRootNamespaceObject (Ptr<Object> obj)
       if (*i == obj)
         {
           m_roots.erase (i);
+          NotifyNamespaceChanged ();
           return;
         }
     }
@@ -816,6 +884,274 @@ ConfigImpl::GetRootNamespaceObject (std::size_t i) const
   return m_roots[i];
 }
 
+void
+ConfigImpl::NotifyNamespaceChanged (void)
+{
+  ++m_generation;
+  m_changedAll = m_generation;
+}
+
+void
+ConfigImpl::NotifyNamespaceChanged (const Object *container)
+{
+  ++m_generation;
+  m_changes.push_back (std::make_pair (m_generation, container));
+  if (m_changes.size () > MAX_CHANGES)
+    {
+      m_changedAll = std::max (m_changedAll, m_changes.front ().first);
+      m_changes.pop_front ();
+    }
+}
+
+uint64_t
+ConfigImpl::GetGeneration (void) const
+{
+  return m_generation;
+}
+
+bool
+ConfigImpl::ChangedSince (uint64_t generation, const std::vector<const Object *> &visited) const
+{
+  if (generation < m_changedAll)
+    {
+      return true;
+    }
+  for (std::deque<std::pair<uint64_t, const Object *> >::const_reverse_iterator i = m_changes.rbegin ();
+       i != m_changes.rend () && i->first > generation; ++i)
+    {
+      if (std::binary_search (visited.begin (), visited.end (), i->second))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+
+CompiledPath::CompiledPath (std::string path)
+  : m_path (path),
+    m_resolved (false),
+    m_generation (0)
+{
+  NS_LOG_FUNCTION (this << path);
+  std::string::size_type slash = path.find_last_of ("/");
+  NS_ASSERT_MSG (slash != std::string::npos, "Invalid path " << path);
+  m_root = path.substr (0, slash);
+  m_leaf = path.substr (slash + 1);
+}
+
+std::string
+CompiledPath::GetPath (void) const
+{
+  return m_path;
+}
+
+void
+CompiledPath::Refresh (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_resolved = false;
+}
+
+void
+CompiledPath::Resolve (void)
+{
+  ConfigImpl *config = ConfigImpl::Get ();
+  uint64_t generation = config->GetGeneration ();
+  if (m_resolved && m_generation == generation)
+    {
+      return;
+    }
+  if (m_resolved && !config->ChangedSince (m_generation, m_visited))
+    {
+      // the changes were made to containers the walk did not go through
+      m_generation = generation;
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_path);
+  m_visited.clear ();
+  MatchContainer container = config->LookupMatches (m_root, &m_visited);
+  m_objects.assign (container.Begin (), container.End ());
+  m_contexts.clear ();
+  for (std::size_t i = 0; i < container.GetN (); ++i)
+    {
+      m_contexts.push_back (container.GetMatchedPath (i) + m_leaf);
+    }
+  m_resolved = true;
+  m_generation = generation;
+}
+
+const CompiledPath::Leaf &
+CompiledPath::GetLeaf (std::size_t i)
+{
+  TypeId tid = m_objects[i]->GetInstanceTypeId ();
+  std::map<TypeId, Leaf>::iterator found = m_leaves.find (tid);
+  if (found == m_leaves.end ())
+    {
+      Leaf leaf;
+      leaf.settable = tid.LookupAttributeByName (m_leaf, &leaf.attribute)
+        && (leaf.attribute.flags & TypeId::ATTR_SET)
+        && leaf.attribute.accessor->HasSetter ();
+      leaf.trace = tid.LookupTraceSourceByName (m_leaf);
+      found = m_leaves.insert (std::make_pair (tid, leaf)).first;
+    }
+  return found->second;
+}
+
+std::size_t
+CompiledPath::GetN (void)
+{
+  Resolve ();
+  return m_objects.size ();
+}
+
+Ptr<Object>
+CompiledPath::Get (std::size_t i)
+{
+  Resolve ();
+  return m_objects[i];
+}
+
+void
+CompiledPath::Set (const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << &value);
+  Resolve ();
+  // the value converted by the last checker, which most often checks the
+  // attribute of every object
+  Ptr<const AttributeChecker> checker;
+  Ptr<AttributeValue> valid;
+  for (std::size_t i = 0; i < m_objects.size (); ++i)
+    {
+      const Leaf &leaf = GetLeaf (i);
+      if (!leaf.settable)
+        {
+          NS_FATAL_ERROR ("Attribute name=" << m_leaf << " does not exist or is not settable for this object: tid="
+                          << m_objects[i]->GetInstanceTypeId ().GetName ());
+        }
+      if (leaf.attribute.checker != checker)
+        {
+          checker = leaf.attribute.checker;
+          valid = checker->CreateValidValue (value);
+        }
+      if (valid == 0 || !leaf.attribute.accessor->Set (PeekPointer (m_objects[i]), *valid))
+        {
+          NS_FATAL_ERROR ("Attribute name=" << m_leaf << " could not be set for this object: tid="
+                          << m_objects[i]->GetInstanceTypeId ().GetName ());
+        }
+    }
+}
+
+bool
+CompiledPath::SetFailSafe (const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << &value);
+  Resolve ();
+  Ptr<const AttributeChecker> checker;
+  Ptr<AttributeValue> valid;
+  bool ok = false;
+  for (std::size_t i = 0; i < m_objects.size (); ++i)
+    {
+      const Leaf &leaf = GetLeaf (i);
+      if (!leaf.settable)
+        {
+          continue;
+        }
+      if (leaf.attribute.checker != checker)
+        {
+          checker = leaf.attribute.checker;
+          valid = checker->CreateValidValue (value);
+        }
+      if (valid != 0)
+        {
+          ok |= leaf.attribute.accessor->Set (PeekPointer (m_objects[i]), *valid);
+        }
+    }
+  return ok;
+}
+
+void
+CompiledPath::Connect (const CallbackBase &cb)
+{
+  if (!ConnectFailSafe (cb))
+    {
+      NS_FATAL_ERROR ("Could not connect callback to " << m_path);
+    }
+}
+
+bool
+CompiledPath::ConnectFailSafe (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  Resolve ();
+  bool ok = false;
+  for (std::size_t i = 0; i < m_objects.size (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> trace = GetLeaf (i).trace;
+      if (trace != 0)
+        {
+          ok |= trace->Connect (PeekPointer (m_objects[i]), m_contexts[i], cb);
+        }
+    }
+  return ok;
+}
+
+void
+CompiledPath::ConnectWithoutContext (const CallbackBase &cb)
+{
+  if (!ConnectWithoutContextFailSafe (cb))
+    {
+      NS_FATAL_ERROR ("Could not connect callback to " << m_path);
+    }
+}
+
+bool
+CompiledPath::ConnectWithoutContextFailSafe (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  Resolve ();
+  bool ok = false;
+  for (std::size_t i = 0; i < m_objects.size (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> trace = GetLeaf (i).trace;
+      if (trace != 0)
+        {
+          ok |= trace->ConnectWithoutContext (PeekPointer (m_objects[i]), cb);
+        }
+    }
+  return ok;
+}
+
+void
+CompiledPath::Disconnect (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  Resolve ();
+  for (std::size_t i = 0; i < m_objects.size (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> trace = GetLeaf (i).trace;
+      if (trace != 0)
+        {
+          trace->Disconnect (PeekPointer (m_objects[i]), m_contexts[i], cb);
+        }
+    }
+}
+
+void
+CompiledPath::DisconnectWithoutContext (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  Resolve ();
+  for (std::size_t i = 0; i < m_objects.size (); ++i)
+    {
+      Ptr<const TraceSourceAccessor> trace = GetLeaf (i).trace;
+      if (trace != 0)
+        {
+          trace->DisconnectWithoutContext (PeekPointer (m_objects[i]), cb);
+        }
+    }
+}
+
 
 void Reset (void)
 {
@@ -967,6 +1303,16 @@ Ptr<Object> GetRootNamespaceObject (uint32_t i)
   return ConfigImpl::Get ()->GetRootNamespaceObject (i);
 }
 
+void NotifyNamespaceChanged (void)
+{
+  ConfigImpl::Get ()->NotifyNamespaceChanged ();
+}
+
+void NotifyNamespaceChanged (const Object *container)
+{
+  ConfigImpl::Get ()->NotifyNamespaceChanged (container);
+}
+
 } // namespace Config
 
 } // namespace ns3
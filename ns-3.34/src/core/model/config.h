@@ -21,8 +21,10 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "type-id.h"
 #include <string>
 #include <vector>
+#include <map>
 
 /**
  * \file
@@ -314,6 +316,152 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \brief A Config path resolved once, for repeated Sets and Connects.
+ *
+ * Config::Set and Config::Connect walk the object graph and match every
+ * path token against names on each call. A CompiledPath walks it once,
+ * on its first use, and keeps the matching objects with their contexts;
+ * the attribute or trace source named by the last token is looked up
+ * once per TypeId of the matching objects, and a value is checked and
+ * converted once per attribute checker. The following Sets and Connects
+ * only go through the kept objects.
+ *
+ * Resolving the path also keeps the objects the walk went through. The
+ * path is resolved again on its next use after
+ * Config::NotifyNamespaceChanged names one of these objects, or names no
+ * object. The root namespace objects, the object name service, the
+ * aggregation of objects and the containers of nodes, devices,
+ * applications and sockets call it when objects are added to them or
+ * removed from them. After changes to other containers, call Refresh.
+ */
+class CompiledPath
+{
+public:
+  /**
+   * \param [in] path The path, the last token of which names an
+   *   attribute or a trace source.
+   */
+  CompiledPath (std::string path);
+
+  /**
+   * \returns The path.
+   */
+  std::string GetPath (void) const;
+  /**
+   * \returns The number of objects matching the path, without its last token.
+   */
+  std::size_t GetN (void);
+  /**
+   * \param [in] i Index of the object ([0,n[)
+   * \returns The matching object.
+   */
+  Ptr<Object> Get (std::size_t i);
+  /**
+   * \brief Resolve the path again on its next use.
+   */
+  void Refresh (void);
+
+  /**
+   * \param [in] value The value to set to the attribute
+   *
+   * Raise a fatal error if the attribute of a matching object cannot be set.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value);
+  /**
+   * \param [in] value The value to set to the attribute
+   * \returns \c true if the attribute of any object could be set.
+   * \sa ns3::Config::SetFailSafe
+   */
+  bool SetFailSafe (const AttributeValue &value);
+  /**
+   * \param [in] cb The sink to connect to the trace source
+   *
+   * Raise a fatal error if no object could be connected.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb);
+  /**
+   * \param [in] cb The sink to connect to the trace source
+   * \returns \c true if any trace source could be connected.
+   * \sa ns3::Config::ConnectFailSafe
+   */
+  bool ConnectFailSafe (const CallbackBase &cb);
+  /**
+   * \param [in] cb The sink to connect to the trace source
+   *
+   * Raise a fatal error if no object could be connected.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb);
+  /**
+   * \param [in] cb The sink to connect to the trace source
+   * \returns \c true if any trace source could be connected.
+   * \sa ns3::Config::ConnectWithoutContextFailSafe
+   */
+  bool ConnectWithoutContextFailSafe (const CallbackBase &cb);
+  /**
+   * \param [in] cb The sink to disconnect from the trace source
+   * \sa ns3::Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb);
+  /**
+   * \param [in] cb The sink to disconnect from the trace source
+   * \sa ns3::Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb);
+
+private:
+  /** What the last token names in the objects of a TypeId. */
+  struct Leaf
+  {
+    bool settable;                                  //!< The attribute exists and can be set
+    struct TypeId::AttributeInformation attribute;  //!< The attribute
+    Ptr<const TraceSourceAccessor> trace;           //!< The trace source, or 0
+  };
+
+  /**
+   * \brief Walk the object graph if the namespace changed since the last
+   * walk, in an object the last walk went through.
+   */
+  void Resolve (void);
+  /**
+   * \param [in] i Index of a matching object
+   * \returns What the last token names in the object.
+   */
+  const Leaf &GetLeaf (std::size_t i);
+
+  std::string m_path;                   //!< The path
+  std::string m_root;                   //!< The path without its last token
+  std::string m_leaf;                   //!< The last token of the path
+  bool m_resolved;                      //!< The objects were matched
+  uint64_t m_generation;                //!< Generation of the namespace the objects were matched in
+  std::vector<Ptr<Object> > m_objects;  //!< The matching objects
+  std::vector<std::string> m_contexts;  //!< The trace contexts of the matching objects
+  std::vector<const Object *> m_visited;  //!< The objects the walk went through, sorted
+  std::map<TypeId, Leaf> m_leaves;      //!< What the last token names, by TypeId
+};
+
+/**
+ * \ingroup config
+ * Notify the Config system that objects were added to the namespace or
+ * removed from it, so that every CompiledPath is resolved again on its
+ * next use.
+ */
+void NotifyNamespaceChanged (void);
+/**
+ * \ingroup config
+ * \param [in] container The object the objects were added to or removed
+ *   from, or 0 for the root of the "/Names" namespace.
+ *
+ * Notify the Config system that the objects found through \pname{container}
+ * changed, so that the CompiledPaths which went through it are resolved
+ * again on their next use.
+ */
+void NotifyNamespaceChanged (const Object *container);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
@@ -22,6 +22,7 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
@@ -109,6 +110,9 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+#ifdef ENABLE_EVENT_PROFILER
+  EventProfiler::Get ()->Write ();
+#endif
 }
 
 void
@@ -148,7 +152,11 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
+#ifdef ENABLE_EVENT_PROFILER
+  EventProfiler::Get ()->Invoke (next.impl);
+#else
   next.impl->Invoke ();
+#endif
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
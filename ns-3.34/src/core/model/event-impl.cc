@@ -20,6 +20,9 @@
 
 #include "event-impl.h"
 #include "log.h"
+#ifdef ENABLE_EVENT_PROFILER
+#include "event-profiler.h"
+#endif
 
 /**
  * \file
@@ -38,6 +41,10 @@ EventImpl::~EventImpl ()
 
 EventImpl::EventImpl ()
   : m_cancel (false)
+#ifdef ENABLE_EVENT_PROFILER
+  , m_profileSite (0),
+    m_profileParent (EventProfiler::Get ()->GetCurrentSite ())
+#endif
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,4 +73,24 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+#ifdef ENABLE_EVENT_PROFILER
+void
+EventImpl::SetProfileSite (uint32_t site)
+{
+  m_profileSite = site;
+}
+
+uint32_t
+EventImpl::GetProfileSite (void) const
+{
+  return m_profileSite;
+}
+
+uint32_t
+EventImpl::GetProfileParent (void) const
+{
+  return m_profileParent;
+}
+#endif
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include "ns3/core-config.h"
 #include "simple-ref-count.h"
 
 /**
@@ -66,6 +67,19 @@ public:
    */
   bool IsCancelled (void);
 
+#ifdef ENABLE_EVENT_PROFILER
+  /**
+   * Set the EventProfiler site of this event.
+   *
+   * \param site [in] The site id.
+   */
+  void SetProfileSite (uint32_t site);
+  /** \returns The EventProfiler site, 0 if it was not set. */
+  uint32_t GetProfileSite (void) const;
+  /** \returns The EventProfiler site of the event that created this event. */
+  uint32_t GetProfileParent (void) const;
+#endif
+
 protected:
   /**
    * Implementation for Invoke().
@@ -77,6 +91,10 @@ protected:
 
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
+#ifdef ENABLE_EVENT_PROFILER
+  uint32_t m_profileSite;    /**< EventProfiler site. */
+  uint32_t m_profileParent;  /**< EventProfiler site of the creating event. */
+#endif
 };
 
 } // namespace ns3
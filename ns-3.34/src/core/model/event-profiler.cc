@@ -0,0 +1,253 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+#include "ns3/core-config.h"
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "system-path.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if defined (__GNUC__)
+#include <cxxabi.h>
+#endif
+#if defined (HAVE_DLFCN_H)
+#include <dlfcn.h>
+#endif
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \param mangled [in] A mangled C++ name.
+ * \return The demangled name, or \p mangled if it cannot be demangled.
+ */
+std::string
+Demangle (const char *mangled)
+{
+  std::string ret = mangled;
+#if defined (__GNUC__)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, NULL, NULL, &status);
+  if (status == 0)
+    {
+      ret = demangled;
+    }
+  std::free (demangled);
+#endif
+  return ret;
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler ()
+  : m_current (0),
+    m_events (0),
+    m_outputName ("eventProfile")
+{
+  m_sites.push_back ({0, 0, 0, 0, 0, 0});
+}
+
+void
+EventProfiler::Initialize (std::string program, std::string outDir /* = "" */)
+{
+  std::string name = SystemPath::Split (program).back ();
+  m_outputName = outDir != "" ? SystemPath::Append (outDir, name) : name;
+}
+
+uint32_t
+EventProfiler::GetSite (const void *function, const std::type_info &type)
+{
+  if (function != 0)
+    {
+      auto it = m_functionSites.find (function);
+      if (it != m_functionSites.end ())
+        {
+          return it->second;
+        }
+      uint32_t site = m_sites.size ();
+      m_sites.push_back ({function, &type, 0, 0, 0, 0});
+      m_functionSites[function] = site;
+      return site;
+    }
+  auto it = m_typeSites.find (std::type_index (type));
+  if (it != m_typeSites.end ())
+    {
+      return it->second;
+    }
+  uint32_t site = m_sites.size ();
+  m_sites.push_back ({0, &type, 0, 0, 0, 0});
+  m_typeSites[std::type_index (type)] = site;
+  return site;
+}
+
+uint32_t
+EventProfiler::GetCurrentSite (void) const
+{
+  return m_current;
+}
+
+void
+EventProfiler::Invoke (EventImpl *event)
+{
+  uint32_t site = event->GetProfileSite ();
+  if (site == 0)
+    {
+      // not created by MakeEvent: attribute it to its own class
+      site = GetSite (0, typeid (*event));
+    }
+  m_edges[(uint64_t) event->GetProfileParent () << 32 | site]++;
+  if (event->IsCancelled ())
+    {
+      m_sites[site].cancelled++;
+    }
+
+  m_current = site;
+  // m_sites may grow while the event runs, so it is indexed again afterwards
+  if (++m_events % SAMPLE_PERIOD == 0)
+    {
+      auto start = std::chrono::steady_clock::now ();
+      event->Invoke ();
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start).count ();
+      m_sites[site].sampled++;
+      m_sites[site].sampledNs += ns;
+    }
+  else
+    {
+      event->Invoke ();
+    }
+  m_sites[site].count++;
+  m_current = 0;
+}
+
+std::string
+EventProfiler::GetName (uint32_t site) const
+{
+  const Site &s = m_sites[site];
+  if (site == 0)
+    {
+      return "setup";
+    }
+  std::string name;
+  std::ostringstream where;
+#if defined (HAVE_DLFCN_H)
+  Dl_info info;
+  if (s.function != 0 && dladdr (s.function, &info) != 0)
+    {
+      if (info.dli_sname != 0 && info.dli_saddr == s.function)
+        {
+          name = Demangle (info.dli_sname);
+        }
+      else if (info.dli_fname != 0)
+        {
+          where << " at " << SystemPath::Split (info.dli_fname).back () << "+0x" << std::hex
+                << (reinterpret_cast<uintptr_t> (s.function) - reinterpret_cast<uintptr_t> (info.dli_fbase));
+        }
+    }
+#endif
+  if (name.empty ())
+    {
+      name = Demangle (s.type->name ()) + where.str ();
+    }
+  // ';' separates the frames of a collapsed stack
+  std::replace (name.begin (), name.end (), ';', ',');
+  return name;
+}
+
+void
+EventProfiler::Write (void)
+{
+  if (m_events == 0)
+    {
+      return;
+    }
+
+  std::vector<double> estNs (m_sites.size (), 0);
+  uint64_t sampled = 0;
+  double totalNs = 0;
+  for (uint32_t i = 0; i < m_sites.size (); ++i)
+    {
+      const Site &s = m_sites[i];
+      if (s.sampled > 0)
+        {
+          estNs[i] = (double) s.sampledNs / s.sampled * s.count;
+        }
+      sampled += s.sampled;
+      totalNs += estNs[i];
+    }
+
+  std::vector<uint32_t> order;
+  for (uint32_t i = 1; i < m_sites.size (); ++i)
+    {
+      if (m_sites[i].count > 0)
+        {
+          order.push_back (i);
+        }
+    }
+  std::sort (order.begin (), order.end (), [&] (uint32_t a, uint32_t b)
+    {
+      return estNs[a] != estNs[b] ? estNs[a] > estNs[b] : m_sites[a].count > m_sites[b].count;
+    });
+
+  std::ofstream report (m_outputName + "-events.txt");
+  report << "# " << m_events << " events, " << sampled << " timed (1 in " << SAMPLE_PERIOD << ")" << std::endl;
+  report << "estSec share% count cancelled meanNs site" << std::endl;
+  for (uint32_t i : order)
+    {
+      const Site &s = m_sites[i];
+      report << std::fixed << std::setprecision (4) << estNs[i] / 1e9
+             << " " << std::setprecision (2) << (totalNs > 0 ? 100 * estNs[i] / totalNs : 0)
+             << " " << s.count << " " << s.cancelled
+             << " " << std::setprecision (0) << (s.sampled > 0 ? (double) s.sampledNs / s.sampled : 0)
+             << " " << GetName (i) << std::endl;
+    }
+  report.close ();
+
+  std::ofstream folded (m_outputName + "-events.folded");
+  for (const auto &edge : m_edges)
+    {
+      uint32_t parent = edge.first >> 32;
+      uint32_t site = edge.first & 0xffffffff;
+      const Site &s = m_sites[site];
+      uint64_t us = s.count > 0 ? (uint64_t) (estNs[site] * edge.second / s.count / 1000) : 0;
+      if (us > 0)
+        {
+          folded << GetName (parent) << ";" << GetName (site) << " " << us << std::endl;
+        }
+    }
+  folded.close ();
+
+  for (Site &s : m_sites)
+    {
+      s.count = s.cancelled = s.sampled = s.sampledNs = 0;
+    }
+  m_edges.clear ();
+  m_events = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+#include "singleton.h"
+#include "ptr.h"
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * @ingroup simulator
+ *
+ * @brief Event counts and wall time by callback, for DefaultSimulatorImpl.
+ *
+ * Every event is attributed to a \em site: the function or member
+ * function bound by MakeEvent(), resolved when the event is created
+ * (virtual member functions are resolved against the bound object), or
+ * the EventImpl subclass for events that were not created by MakeEvent().
+ * The event that was executing when an event was created is recorded
+ * as its parent; events created outside of Simulator::Run() have the
+ * parent \c setup.
+ *
+ * DefaultSimulatorImpl::ProcessOneEvent() counts every event, and times
+ * one event in SAMPLE_PERIOD with the wall clock. The wall time of a site
+ * is estimated as its count times the mean of its sampled events.
+ *
+ * Simulator::Destroy() writes two files, named after the main program
+ * as for DesMetrics (or \c eventProfile if CommandLine was not used):
+ *
+ * \li \c <program>-events.txt lists the sites sorted by estimated wall time:
+ * \verbatim
+   # 251426 events, 15714 timed (1 in 16)
+   estSec share% count cancelled meanNs site
+   10.0421 93.00 65389 0 153576 ns3::PointToPointNetDevice::Receive(ns3::Ptr<ns3::Packet>)
+   ... \endverbatim
+ * \li \c <program>-events.folded holds one \c parent;site line per pair,
+ * weighted by the estimated wall time in microseconds, which is the
+ * collapsed-stack input of flamegraph.pl.
+ *
+ * Functions are named from the dynamic symbol table. Functions of the
+ * main program are only found there if it is linked with \c -rdynamic;
+ * otherwise the site is printed as its type and \c file+offset, which
+ * \c addr2line resolves.
+ *
+ * <b> Enabling the profiler </b>
+ *
+ * The profiler is compiled in only when configured with
+ * \verbatim
+   $ waf configure ... --enable-event-profiler \endverbatim
+ * Otherwise neither EventImpl nor MakeEvent() nor the event loop carry
+ * any profiling code.
+ */
+class EventProfiler : public Singleton<EventProfiler>
+{
+public:
+  /** Time one event out of this many. */
+  static const uint64_t SAMPLE_PERIOD = 16;
+
+  EventProfiler ();
+
+  /**
+   * Set the base name of the output files from the program name.
+   *
+   * \param program [in] Path of the main program (argv[0]).
+   * \param outDir [in] Directory where the output files should be written.
+   */
+  void Initialize (std::string program, std::string outDir = "");
+
+  /**
+   * Get the site id of a callback, creating it on first use.
+   *
+   * \param function [in] Address of the bound function, or 0 if unknown.
+   * \param type [in] Type of the callback.
+   * \return The site id, never 0 (0 is \c setup).
+   */
+  uint32_t GetSite (const void *function, const std::type_info &type);
+
+  /** \return The site of the event being executed, 0 outside of events. */
+  uint32_t GetCurrentSite (void) const;
+
+  /**
+   * Execute an event, accounting it to its site.
+   *
+   * \param event [in] The event.
+   */
+  void Invoke (EventImpl *event);
+
+  /** Write the report and the collapsed stacks, then clear the statistics. */
+  void Write (void);
+
+  /**
+   * Get the function a member function pointer calls on an object.
+   *
+   * \tparam MEM \deduced The member function pointer type.
+   * \tparam T \deduced The class type.
+   * \param mem [in] The member function pointer.
+   * \param obj [in] The object.
+   * \return The function address, or 0 if it cannot be resolved
+   * (including for a Callback data member).
+   */
+  template <typename MEM, typename T>
+  static const void * GetMemberFunction (MEM mem, T *obj);
+  /** \copydoc GetMemberFunction(MEM,T*) */
+  template <typename MEM, typename T>
+  static const void * GetMemberFunction (MEM mem, const Ptr<T> &obj);
+
+private:
+  /** \copydoc GetMemberFunction(MEM,T*) */
+  template <typename MEM, typename T>
+  static const void * DoGetMemberFunction (MEM mem, T *obj, std::true_type);
+  /** \copydoc GetMemberFunction(MEM,T*) */
+  template <typename MEM, typename T>
+  static const void * DoGetMemberFunction (MEM mem, T *obj, std::false_type);
+
+  /** A callback events are attributed to. */
+  struct Site
+  {
+    const void *function;        //!< Bound function, or 0.
+    const std::type_info *type;  //!< Callback type.
+    uint64_t count;              //!< Executed events.
+    uint64_t cancelled;          //!< Cancelled events.
+    uint64_t sampled;            //!< Timed events.
+    uint64_t sampledNs;          //!< Wall time of the timed events.
+  };
+
+  /**
+   * \param site [in] The site id.
+   * \return A printable name of the site.
+   */
+  std::string GetName (uint32_t site) const;
+
+  std::vector<Site> m_sites;                                   //!< Sites by id.
+  std::unordered_map<const void *, uint32_t> m_functionSites;  //!< Site ids by function.
+  std::unordered_map<std::type_index, uint32_t> m_typeSites;   //!< Site ids of unresolved callbacks.
+  std::unordered_map<uint64_t, uint64_t> m_edges;              //!< Event counts by (parent << 32 | site).
+  uint32_t m_current;                                          //!< Site being executed.
+  uint64_t m_events;                                           //!< Events since the last Write ().
+  std::string m_outputName;                                    //!< Output path without extension.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename MEM, typename T>
+const void *
+EventProfiler::GetMemberFunction (MEM mem, T *obj)
+{
+  return DoGetMemberFunction (mem, obj, std::is_member_function_pointer<MEM> ());
+}
+
+template <typename MEM, typename T>
+const void *
+EventProfiler::DoGetMemberFunction (MEM mem, T *obj, std::false_type)
+{
+  return 0;
+}
+
+template <typename MEM, typename T>
+const void *
+EventProfiler::DoGetMemberFunction (MEM mem, T *obj, std::true_type)
+{
+#if defined (__GNUC__) && !defined (__arm__) && !defined (__aarch64__)
+  // Itanium C++ ABI: {ptr, adj}, where ptr is the function address, or
+  // 1 + the vtable offset of a virtual function
+  struct
+  {
+    uintptr_t ptr;
+    ptrdiff_t adj;
+  } rep;
+  static_assert (sizeof (rep) == sizeof (MEM), "unexpected member function pointer layout");
+  std::memcpy (&rep, &mem, sizeof (rep));
+  if (rep.ptr & 1)
+    {
+      if (obj == 0)
+        {
+          return 0;
+        }
+      const char *self = reinterpret_cast<const char *> (obj) + rep.adj;
+      const void * const *vtable = *reinterpret_cast<const void * const * const *> (self);
+      return vtable[(rep.ptr - 1) / sizeof (void *)];
+    }
+  return reinterpret_cast<const void *> (rep.ptr);
+#else
+  return 0;
+#endif
+}
+
+template <typename MEM, typename T>
+const void *
+EventProfiler::GetMemberFunction (MEM mem, const Ptr<T> &obj)
+{
+  return GetMemberFunction (mem, PeekPointer (obj));
+}
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
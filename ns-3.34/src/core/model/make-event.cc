@@ -55,6 +55,7 @@ EventImpl * MakeEvent (void (*f)(void))
   private:
     F m_function;
   } *ev = new EventFunctionImpl0 (f);
+  NS_MAKE_EVENT_PROFILE (ev, reinterpret_cast<const void *> (f), f);
   return ev;
 }
 
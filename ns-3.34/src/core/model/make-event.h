@@ -317,6 +317,19 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
 #include "event-impl.h"
 #include "type-traits.h"
 
+#ifdef ENABLE_EVENT_PROFILER
+#include "event-profiler.h"
+/**
+ * \ingroup makeeventmemptr
+ * Attribute an event to its bound function for the EventProfiler.
+ * Expands to nothing unless configured with --enable-event-profiler.
+ */
+#define NS_MAKE_EVENT_PROFILE(ev, function, type) \
+  (ev)->SetProfileSite (EventProfiler::Get ()->GetSite (function, typeid (type)))
+#else
+#define NS_MAKE_EVENT_PROFILE(ev, function, type)
+#endif
+
 namespace ns3 {
 
 /**
@@ -377,6 +390,7 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
+  NS_MAKE_EVENT_PROFILE (ev, EventProfiler::GetMemberFunction (mem_ptr, obj), MEM);
   return ev;
 }
 
@@ -408,6 +422,7 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1)
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventMemberImpl1 (obj, mem_ptr, a1);
+  NS_MAKE_EVENT_PROFILE (ev, EventProfiler::GetMemberFunction (mem_ptr, obj), MEM);
   return ev;
 }
 
@@ -440,6 +455,7 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
   } *ev = new EventMemberImpl2 (obj, mem_ptr, a1, a2);
+  NS_MAKE_EVENT_PROFILE (ev, EventProfiler::GetMemberFunction (mem_ptr, obj), MEM);
   return ev;
 }
 
@@ -474,6 +490,7 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
     typename TypeTraits<T2>::ReferencedType m_a2;
     typename TypeTraits<T3>::ReferencedType m_a3;
   } *ev = new EventMemberImpl3 (obj, mem_ptr, a1, a2, a3);
+  NS_MAKE_EVENT_PROFILE (ev, EventProfiler::GetMemberFunction (mem_ptr, obj), MEM);
   return ev;
 }
 
@@ -510,6 +527,7 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
     typename TypeTraits<T3>::ReferencedType m_a3;
     typename TypeTraits<T4>::ReferencedType m_a4;
   } *ev = new EventMemberImpl4 (obj, mem_ptr, a1, a2, a3, a4);
+  NS_MAKE_EVENT_PROFILE (ev, EventProfiler::GetMemberFunction (mem_ptr, obj), MEM);
   return ev;
 }
 
@@ -549,6 +567,7 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     typename TypeTraits<T4>::ReferencedType m_a4;
     typename TypeTraits<T5>::ReferencedType m_a5;
   } *ev = new EventMemberImpl5 (obj, mem_ptr, a1, a2, a3, a4, a5);
+  NS_MAKE_EVENT_PROFILE (ev, EventProfiler::GetMemberFunction (mem_ptr, obj), MEM);
   return ev;
 }
 
@@ -590,6 +609,7 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     typename TypeTraits<T5>::ReferencedType m_a5;
     typename TypeTraits<T6>::ReferencedType m_a6;
   } *ev = new EventMemberImpl6 (obj, mem_ptr, a1, a2, a3, a4, a5, a6);
+  NS_MAKE_EVENT_PROFILE (ev, EventProfiler::GetMemberFunction (mem_ptr, obj), MEM);
   return ev;
 }
 
@@ -619,6 +639,7 @@ EventImpl * MakeEvent (void (*f)(U1), T1 a1)
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
+  NS_MAKE_EVENT_PROFILE (ev, reinterpret_cast<const void *> (f), f);
   return ev;
 }
 
@@ -650,6 +671,7 @@ EventImpl * MakeEvent (void (*f)(U1,U2), T1 a1, T2 a2)
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
   } *ev = new EventFunctionImpl2 (f, a1, a2);
+  NS_MAKE_EVENT_PROFILE (ev, reinterpret_cast<const void *> (f), f);
   return ev;
 }
 
@@ -684,6 +706,7 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3), T1 a1, T2 a2, T3 a3)
     typename TypeTraits<T2>::ReferencedType m_a2;
     typename TypeTraits<T3>::ReferencedType m_a3;
   } *ev = new EventFunctionImpl3 (f, a1, a2, a3);
+  NS_MAKE_EVENT_PROFILE (ev, reinterpret_cast<const void *> (f), f);
   return ev;
 }
 
@@ -720,6 +743,7 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4), T1 a1, T2 a2, T3 a3, T4 a4)
     typename TypeTraits<T3>::ReferencedType m_a3;
     typename TypeTraits<T4>::ReferencedType m_a4;
   } *ev = new EventFunctionImpl4 (f, a1, a2, a3, a4);
+  NS_MAKE_EVENT_PROFILE (ev, reinterpret_cast<const void *> (f), f);
   return ev;
 }
 
@@ -758,6 +782,7 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5), T1 a1, T2 a2, T3 a3, T4 a4, T5
     typename TypeTraits<T4>::ReferencedType m_a4;
     typename TypeTraits<T5>::ReferencedType m_a5;
   } *ev = new EventFunctionImpl5 (f, a1, a2, a3, a4, a5);
+  NS_MAKE_EVENT_PROFILE (ev, reinterpret_cast<const void *> (f), f);
   return ev;
 }
 
@@ -798,6 +823,7 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
     typename TypeTraits<T5>::ReferencedType m_a5;
     typename TypeTraits<T6>::ReferencedType m_a6;
   } *ev = new EventFunctionImpl6 (f, a1, a2, a3, a4, a5, a6);
+  NS_MAKE_EVENT_PROFILE (ev, reinterpret_cast<const void *> (f), f);
   return ev;
 }
 
@@ -22,6 +22,7 @@
 #include "assert.h"
 #include "abort.h"
 #include "names.h"
+#include "config.h"
 #include "singleton.h"
 
 /**
@@ -415,6 +416,7 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
   NameNode *newNode = new NameNode (node, name, object);
   node->m_nameMap[name] = newNode;
   m_objectMap[object] = newNode;
+  Config::NotifyNamespaceChanged (PeekPointer (context));
 
   return true;
 }
@@ -537,6 +539,7 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       node->m_nameMap.erase (i);
       changeNode->m_name = newname;
       node->m_nameMap[newname] = changeNode;
+      Config::NotifyNamespaceChanged (PeekPointer (context));
       return true;
     }
 }
@@ -831,7 +834,8 @@ void
 Names::Clear (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  return NamesPriv::Get ()->Clear ();
+  NamesPriv::Get ()->Clear ();
+  Config::NotifyNamespaceChanged ();
 }
 
 Ptr<Object>
@@ -25,6 +25,7 @@
 #include "attribute.h"
 #include "log.h"
 #include "string.h"
+#include "config.h"
 #include <vector>
 #include <sstream>
 #include <cstdlib>
@@ -316,6 +317,13 @@ Object::AggregateObject (Ptr<Object> o)
   // Now that we are done with them, we can free our old aggregate buffers
   std::free (a);
   std::free (b);
+
+  // the objects are now found by the paths with an $ns3:: token
+  // from any object of the aggregate
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Config::NotifyNamespaceChanged (aggregates->buffer[i]);
+    }
 }
 /**
  * This function must be implemented in the stack that needs to notify
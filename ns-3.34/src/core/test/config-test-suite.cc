@@ -20,6 +20,7 @@
 #include "ns3/config.h"
 #include "ns3/test.h"
 #include "ns3/integer.h"
+#include "ns3/string.h"
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/callback.h"
@@ -840,6 +841,140 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test for the ability to resolve a path once and set and connect through it.
+ */
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CompiledPathConfigTestCase ();
+  /** Destructor. */
+  virtual ~CompiledPathConfigTestCase ()
+  {}
+
+  /**
+   * Trace callback with context path.
+   * \param path The context path.
+   * \param oldValue The old value.
+   * \param newValue The new value.
+   */
+  void TraceWithPath (std::string path, int16_t oldValue, int16_t newValue)
+  {
+    NS_UNUSED (oldValue);
+    m_newValue = newValue;
+    m_path = path;
+  }
+
+private:
+  virtual void DoRun (void);
+
+  int16_t m_newValue;  //!< Flag to detect tracing result.
+  std::string m_path;  //!< The context path.
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check ability to set and connect through a path resolved once")
+{}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj0 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj1 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj0);
+  root->AddNodeA (obj1);
+  Names::Add ("CompiledPathRoot", root);
+
+  Config::CompiledPath a ("/Names/CompiledPathRoot/NodesA/*/A");
+  NS_TEST_ASSERT_MSG_EQ (a.GetN (), 2, "Wrong number of matching objects");
+  NS_TEST_ASSERT_MSG_EQ (a.Get (1), obj1, "Wrong matching object");
+
+  //
+  // Set through the path, repeatedly and with a value to convert.
+  //
+  a.Set (IntegerValue (3));
+  obj0->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 3, "Object Attribute \"A\" not set correctly");
+  a.Set (StringValue ("5"));
+  obj0->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 5, "Object Attribute \"A\" not set correctly");
+  obj1->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 5, "Object Attribute \"A\" not set correctly");
+
+  //
+  // An invalid value is not set, and a nonexistent attribute is not found.
+  //
+  NS_TEST_ASSERT_MSG_EQ (a.SetFailSafe (IntegerValue (1000)), false, "Out of range value unexpectedly set");
+  obj0->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 5, "Object Attribute \"A\" unexpectedly set");
+  Config::CompiledPath missing ("/Names/CompiledPathRoot/NodesA/*/Missing");
+  NS_TEST_ASSERT_MSG_EQ (missing.SetFailSafe (IntegerValue (1)), false, "Nonexistent attribute unexpectedly set");
+  NS_TEST_ASSERT_MSG_EQ (missing.ConnectFailSafe (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this)),
+                         false, "Nonexistent trace source unexpectedly connected");
+
+  //
+  // Connect with context, the same as Config::Connect.
+  //
+  Config::CompiledPath source ("/Names/CompiledPathRoot/NodesA/*/Source");
+  source.Connect (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  obj1->SetAttribute ("Source", IntegerValue (-2));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -2, "Trace 1 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/Names/CompiledPathRoot/NodesA/1/Source", "Trace 1 did not provide expected context");
+  source.Disconnect (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  obj1->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace 1 fired after Disconnect");
+
+  //
+  // An object added without notification is matched after Refresh, and
+  // one added with notification on the next use.
+  //
+  Ptr<ConfigTestObject> obj2 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj2);
+  NS_TEST_ASSERT_MSG_EQ (a.GetN (), 2, "Path unexpectedly resolved again");
+  a.Refresh ();
+  NS_TEST_ASSERT_MSG_EQ (a.GetN (), 3, "Path not resolved again after Refresh");
+  Ptr<ConfigTestObject> obj3 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj3);
+  Config::NotifyNamespaceChanged ();
+  a.Set (IntegerValue (7));
+  obj3->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 7, "Object Attribute \"A\" not set after the namespace changed");
+
+  //
+  // A change to a container the walk did not go through does not resolve
+  // the path again, a change to one it went through does.
+  //
+  Ptr<ConfigTestObject> other = CreateObject<ConfigTestObject> ();
+  Names::Add ("CompiledPathOther", other);
+  NS_TEST_ASSERT_MSG_EQ (a.GetN (), 4, "Wrong number of matching objects");
+  Ptr<ConfigTestObject> obj4 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj4);
+  other->AddNodeA (CreateObject<ConfigTestObject> ());
+  Config::NotifyNamespaceChanged (PeekPointer (other));
+  NS_TEST_ASSERT_MSG_EQ (a.GetN (), 4, "Path unexpectedly resolved again after a change elsewhere");
+  Config::NotifyNamespaceChanged (PeekPointer (root));
+  NS_TEST_ASSERT_MSG_EQ (a.GetN (), 5, "Path not resolved again after a change to its container");
+  NS_TEST_ASSERT_MSG_EQ (a.Get (4), obj4, "Wrong matching object");
+
+  //
+  // Aggregating an object to one the walk went through resolves it again.
+  //
+  Config::CompiledPath aggregated ("/Names/CompiledPathRoot/NodesA/0/$BaseConfigObject/X");
+  NS_TEST_ASSERT_MSG_EQ (aggregated.GetN (), 0, "Path unexpectedly matched");
+  Ptr<BaseConfigObject> base = CreateObject<BaseConfigObject> ();
+  obj0->AggregateObject (base);
+  NS_TEST_ASSERT_MSG_EQ (aggregated.GetN (), 1, "Path not resolved again after an aggregation");
+  NS_TEST_ASSERT_MSG_EQ (aggregated.Get (0), base, "Wrong matching object");
+
+  Names::Clear ();
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -858,6 +993,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new CompiledPathConfigTestCase);
 }
 
 /**
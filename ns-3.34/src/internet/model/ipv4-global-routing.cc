@@ -28,6 +28,7 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
 #include "ns3/node.h"
+#include "ns3/hash.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 
@@ -48,6 +49,11 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_randomEcmpRouting),
                    MakeBooleanChecker ())
+    .AddAttribute ("FlowEcmpRouting",
+                   "Set to true if packets are routed among ECMP by hashing their 5-tuple, so that all packets of a flow take the same route",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_flowEcmpRouting),
+                   MakeBooleanChecker ())
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -59,6 +65,7 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
+    m_flowEcmpRouting (false),
     m_respondToInterfaceEvents (false)
 {
   NS_LOG_FUNCTION (this);
@@ -136,10 +143,58 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
 }
 
 
+void
+Ipv4GlobalRouting::SetEcmpHashCallback (EcmpHashCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_ecmpHash = cb;
+}
+
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << p << header);
+  uint8_t prot = header.GetProtocol ();
+  uint16_t srcPort = 0;
+  uint16_t destPort = 0;
+  // TCP and UDP both start with the source and destination ports. Only an
+  // unfragmented datagram carries them: a non-first fragment has none, so
+  // all the fragments of a datagram (the first one included, hence the
+  // check of the MF flag) are hashed on the 3-tuple and take the same path.
+  bool fragment = !header.IsLastFragment () || header.GetFragmentOffset () != 0;
+  if ((prot == 6 || prot == 17) && !fragment && p != 0 && p->GetSize () >= 4)
+    {
+      uint8_t ports[4];
+      p->CopyData (ports, 4);
+      srcPort = (ports[0] << 8) | ports[1];
+      destPort = (ports[2] << 8) | ports[3];
+    }
+  if (!m_ecmpHash.IsNull ())
+    {
+      return m_ecmpHash (header.GetSource (), header.GetDestination (), prot, srcPort, destPort);
+    }
+
+  /* serialize the 5-tuple and the node id in buf */
+  uint32_t perturbation = m_ipv4->GetObject<Node> ()->GetId ();
+  uint8_t buf[17];
+  header.GetSource ().Serialize (buf);
+  header.GetDestination ().Serialize (buf + 4);
+  buf[8] = prot;
+  buf[9] = (srcPort >> 8) & 0xff;
+  buf[10] = srcPort & 0xff;
+  buf[11] = (destPort >> 8) & 0xff;
+  buf[12] = destPort & 0xff;
+  buf[13] = (perturbation >> 24) & 0xff;
+  buf[14] = (perturbation >> 16) & 0xff;
+  buf[15] = (perturbation >> 8) & 0xff;
+  buf[16] = perturbation & 0xff;
+  return Hash32 ((char*) buf, 17);
+}
+
 Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif, uint32_t flowHash)
 {
-  NS_LOG_FUNCTION (this << dest << oif);
+  NS_LOG_FUNCTION (this << dest << oif << flowHash);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
   // store all available routes that bring packets to their destination
@@ -217,13 +272,17 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
       // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
+      // ECMP routing is enabled, by flow hash if flow ECMP routing is
+      // enabled, or always select the first route consistently otherwise
       uint32_t selectIndex;
       if (m_randomEcmpRouting)
         {
           selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
         }
+      else if (m_flowEcmpRouting)
+        {
+          selectIndex = flowHash % allRoutes.size ();
+        }
       else 
         {
           selectIndex = 0;
@@ -475,7 +534,8 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif,
+                                         m_flowEcmpRouting ? GetFlowHash (p, header) : 0);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -524,7 +584,8 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), 0,
+                                         m_flowEcmpRouting ? GetFlowHash (p, header) : 0);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
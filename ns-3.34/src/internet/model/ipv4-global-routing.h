@@ -228,12 +228,32 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Callback computing the ECMP hash of a flow from its 5-tuple
+   * (source, destination, protocol, source port, destination port).
+   */
+  typedef Callback<uint32_t, Ipv4Address, Ipv4Address, uint8_t, uint16_t, uint16_t> EcmpHashCallback;
+
+  /**
+   * \brief Set the hash used to pick one of the ECMP routes when
+   * FlowEcmpRouting is enabled.
+   *
+   * If no callback is set, the 5-tuple and the node id are hashed with Hash32.
+   *
+   * \param cb the hash callback
+   */
+  void SetEcmpHashCallback (EcmpHashCallback cb);
+
 protected:
   void DoDispose (void);
 
 private:
   /// Set to true if packets are randomly routed among ECMP; set to false for using only one route consistently
   bool m_randomEcmpRouting;
+  /// Set to true if packets of the same flow are routed on the same ECMP route, chosen by hashing the 5-tuple
+  bool m_flowEcmpRouting;
+  /// Hash used by flow ECMP routing
+  EcmpHashCallback m_ecmpHash;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
@@ -264,9 +284,21 @@ private:
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
    * \param oif output interface if any (put 0 otherwise)
+   * \param flowHash hash of the flow, used to select among ECMP routes if FlowEcmpRouting is enabled
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0, uint32_t flowHash = 0);
+
+  /**
+   * \brief Compute the ECMP hash of the flow a packet belongs to.
+   *
+   * The ports of a fragmented datagram are left out (0), so that all
+   * its fragments hash alike.
+   * \param p the packet, starting with the L4 header (may be 0)
+   * \param header the IPv4 header of the packet
+   * \return the flow hash
+   */
+  uint32_t GetFlowHash (Ptr<const Packet> p, const Ipv4Header &header);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
@@ -513,4 +513,24 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+void
+HeaderCacheTraits<Ipv4Header>::Normalize (Ipv4Header &header)
+{
+  // the checksum written by Serialize is right, if it writes one
+  header.m_goodChecksum = true;
+}
+
+bool
+HeaderCacheTraits<Ipv4Header>::Load (Ipv4Header &header, const Ipv4Header &cached)
+{
+  if (header.m_calcChecksum && !cached.m_calcChecksum)
+    {
+      return false;
+    }
+  bool calcChecksum = header.m_calcChecksum;
+  header = cached;
+  header.m_calcChecksum = calcChecksum;
+  return true;
+}
+
 } // namespace ns3
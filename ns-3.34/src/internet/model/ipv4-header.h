@@ -247,6 +247,7 @@ public:
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
 private:
+  friend struct HeaderCacheTraits<Ipv4Header>;
 
   /// flags related to IP fragmentation
   enum FlagsE {
@@ -270,6 +271,25 @@ private:
   uint16_t m_headerSize; //!< IP header size
 };
 
+/**
+ * \brief Keep decoded Ipv4Header on packets, see Packet::EnableHeaderCache.
+ */
+template <>
+struct HeaderCacheTraits<Ipv4Header>
+{
+  static const bool cached = true;  //!< Ipv4Header is cached
+  /**
+   * \param header a header given to Packet::AddHeader
+   */
+  static void Normalize (Ipv4Header &header);
+  /**
+   * \param header the header to set
+   * \param cached the decoded header
+   * \returns false if header checks the checksum and cached did not
+   */
+  static bool Load (Ipv4Header &header, const Ipv4Header &cached);
+};
+
 } // namespace ns3
 
 
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-gro.h"
+#include "tcp-option-ts.h"
+#include "ipv4-end-point.h"
+#include "ipv4-interface.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpGro");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpGro);
+
+TypeId
+TcpGro::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpGro")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpGro> ()
+    .AddAttribute ("Timeout",
+                   "The time a data segment is held for, waiting for the "
+                   "next segments of its connection.",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&TcpGro::m_timeout),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("MaxSize",
+                   "The payload size a merged segment is forwarded up at.",
+                   UintegerValue (65535),
+                   MakeUintegerAccessor (&TcpGro::m_maxSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+TcpGro::TcpGro ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpGro::~TcpGro ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpGro::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_connections.clear ();
+  m_held.clear ();
+  Object::DoDispose ();
+}
+
+bool
+TcpGro::IsMergeable (const TcpHeader &tcpHeader, uint32_t payload)
+{
+  // data without SYN, FIN, RST, PSH, URG, ECE or CWR, and no option
+  // other than the timestamps
+  return payload > 0
+         && tcpHeader.GetFlags () == TcpHeader::ACK
+         && (tcpHeader.GetLength () == 5
+             || (tcpHeader.GetLength () == 8 && tcpHeader.HasOption (TcpOption::TS)));
+}
+
+bool
+TcpGro::CanAppend (const Held &held, const TcpHeader &tcpHeader,
+                   const Ipv4Header &ipHeader, Ptr<Ipv4Interface> incomingInterface,
+                   uint32_t payload) const
+{
+  const TcpHeader &first = held.tcpHeader;
+  if (tcpHeader.GetSequenceNumber () != held.nextSequence
+      || tcpHeader.GetAckNumber () != first.GetAckNumber ()
+      || tcpHeader.GetWindowSize () != first.GetWindowSize ()
+      || tcpHeader.GetLength () != first.GetLength ()
+      || ipHeader.GetTos () != held.ipHeader.GetTos ()
+      || incomingInterface != held.interface
+      || held.payload + payload > m_maxSize)
+    {
+      return false;
+    }
+  if (tcpHeader.GetLength () == 5)
+    {
+      return true;
+    }
+  Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
+  Ptr<const TcpOptionTS> firstTs = DynamicCast<const TcpOptionTS> (first.GetOption (TcpOption::TS));
+  return ts->GetTimestamp () == firstTs->GetTimestamp ()
+         && ts->GetEcho () == firstTs->GetEcho ();
+}
+
+void
+TcpGro::Receive (Ptr<Packet> packet, const TcpHeader &tcpHeader,
+                 const Ipv4Header &ipHeader, Ptr<Ipv4Interface> incomingInterface,
+                 Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << packet << tcpHeader << endPoint);
+  uint32_t headerSize = tcpHeader.GetSerializedSize ();
+  uint32_t payload = packet->GetSize () - headerSize;
+  bool mergeable = IsMergeable (tcpHeader, payload);
+
+  auto found = m_connections.find (endPoint);
+  if (found != m_connections.end () && found->second.held)
+    {
+      std::list<Held>::iterator it = found->second.it;
+      if (mergeable && CanAppend (*it, tcpHeader, ipHeader, incomingInterface, payload))
+        {
+          found->second.lastArrival = Simulator::Now ();
+          packet->RemoveAtStart (headerSize);
+          it->packet->AddAtEnd (packet);
+          it->nextSequence += payload;
+          it->payload += payload;
+          ++m_merged;
+          NS_LOG_LOGIC ("Merged seq " << tcpHeader.GetSequenceNumber () << ", " << it->payload << " bytes held");
+          if (it->payload >= m_maxSize)
+            {
+              Forward (it);
+            }
+          return;
+        }
+      // keep the order of the segments of the connection
+      Forward (it);
+      found = m_connections.find (endPoint);
+      if (found == m_connections.end ())
+        {
+          // the socket closed on the held segment and deallocated the
+          // end point: this segment has nowhere to go
+          NS_LOG_LOGIC ("End point deallocated, dropping seq " << tcpHeader.GetSequenceNumber ());
+          return;
+        }
+    }
+
+  // only the connected end points: a listening one forks the connection
+  if (mergeable && endPoint->GetPeerPort () != 0)
+    {
+      Time now = Simulator::Now ();
+      if (found == m_connections.end ())
+        {
+          found = m_connections.emplace (endPoint, Connection ()).first;
+          found->second.lastArrival = now - m_timeout;
+        }
+      Time previous = found->second.lastArrival;
+      found->second.lastArrival = now;
+      if (now - previous < m_timeout)
+        {
+          Held held;
+          held.endPoint = endPoint;
+          held.packet = packet;
+          held.tcpHeader = tcpHeader;
+          held.ipHeader = ipHeader;
+          held.interface = incomingInterface;
+          held.nextSequence = tcpHeader.GetSequenceNumber () + payload;
+          held.payload = payload;
+          held.deadline = now + m_timeout;
+          found->second.held = true;
+          found->second.it = m_held.insert (m_held.end (), held);
+          Arm ();
+          return;
+        }
+    }
+
+  ++m_forwarded;
+  endPoint->ForwardUp (packet, ipHeader, tcpHeader.GetSourcePort (), incomingInterface);
+}
+
+void
+TcpGro::Forward (std::list<Held>::iterator it)
+{
+  NS_LOG_FUNCTION (this << it->endPoint << it->payload);
+  // forget the segment first, the socket may send and receive in turn
+  Held held = *it;
+  m_connections[held.endPoint].held = false;
+  m_held.erase (it);
+  ++m_forwarded;
+  held.endPoint->ForwardUp (held.packet, held.ipHeader, held.tcpHeader.GetSourcePort (), held.interface);
+}
+
+void
+TcpGro::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  while (!m_held.empty () && m_held.front ().deadline <= now)
+    {
+      Forward (m_held.begin ());
+    }
+  Arm ();
+}
+
+void
+TcpGro::Arm (void)
+{
+  if (m_held.empty ())
+    {
+      m_event.Cancel ();
+      return;
+    }
+  Time next = m_held.front ().deadline;
+  if (m_event.IsRunning () && m_eventTime <= next)
+    {
+      // an earlier event rearms itself when it finds nothing to flush
+      return;
+    }
+  m_event.Cancel ();
+  m_eventTime = next;
+  m_event = Simulator::Schedule (next - Simulator::Now (), &TcpGro::Flush, this);
+}
+
+void
+TcpGro::DeAllocate (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  auto found = m_connections.find (endPoint);
+  if (found != m_connections.end ())
+    {
+      if (found->second.held)
+        {
+          m_held.erase (found->second.it);
+        }
+      m_connections.erase (found);
+    }
+}
+
+uint64_t
+TcpGro::GetNForwarded (void) const
+{
+  return m_forwarded;
+}
+
+uint64_t
+TcpGro::GetNMerged (void) const
+{
+  return m_merged;
+}
+
+} // namespace ns3
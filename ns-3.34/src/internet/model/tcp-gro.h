@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_GRO_H
+#define TCP_GRO_H
+
+#include <stdint.h>
+#include <list>
+#include <unordered_map>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/sequence-number.h"
+#include "ns3/tcp-header.h"
+
+namespace ns3 {
+
+class Ipv4EndPoint;
+class Ipv4Interface;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Receive-side coalescing of TCP segments (GRO)
+ *
+ * As GRO in Linux, this stage merges the in-order data segments of a
+ * connection into one segment before they are forwarded up to the
+ * socket, so that the socket processes them, and acknowledges them,
+ * once. A data segment is held for at most Timeout after it arrived,
+ * if the previous data segment of its connection arrived less than
+ * Timeout before it; otherwise no segment is likely to be appended to
+ * it, and holding it would only cost a flush event. The following
+ * segments of the connection are appended to the held one if they
+ * carry the next sequence number and the same flags (ACK only),
+ * acknowledgment number, window, timestamps and IPv4 TOS. The segment
+ * is forwarded up when Timeout is over, when MaxSize bytes of payload
+ * are held, or before a segment that cannot be appended to it, which
+ * is then forwarded up or held in turn.
+ *
+ * Only segments with equal timestamps are merged, so the timestamp the
+ * receiver echoes is the one of every merged segment, and the RTT the
+ * sender measures only includes the time the first segment was held.
+ * The merged segment keeps the packet tags of the first one.
+ *
+ * One simulator event flushes the segments whose time is over, for all
+ * the connections of the node. It is enabled with the attribute
+ * TcpL4Protocol::Gro.
+ */
+class TcpGro : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpGro ();
+  virtual ~TcpGro ();
+
+  /**
+   * \brief Receive a segment for a connection
+   *
+   * The segment is merged or held, or forwarded up to \p endPoint.
+   *
+   * \param packet the segment, with its TCP header
+   * \param tcpHeader the TCP header of the segment
+   * \param ipHeader the IPv4 header of the segment
+   * \param incomingInterface the interface the segment came from
+   * \param endPoint the end point of the connection
+   */
+  void Receive (Ptr<Packet> packet, const TcpHeader &tcpHeader,
+                const Ipv4Header &ipHeader, Ptr<Ipv4Interface> incomingInterface,
+                Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Forget the segment held for an end point that is deallocated
+   * \param endPoint the end point
+   */
+  void DeAllocate (Ipv4EndPoint *endPoint);
+
+  /** \return the number of segments forwarded up, merged or not */
+  uint64_t GetNForwarded (void) const;
+
+  /** \return the number of segments appended to a held segment */
+  uint64_t GetNMerged (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** A segment held for a connection */
+  struct Held
+  {
+    Ipv4EndPoint *endPoint;          //!< End point of the connection
+    Ptr<Packet> packet;              //!< First segment, followed by the payload of the merged ones
+    TcpHeader tcpHeader;             //!< TCP header of the first segment
+    Ipv4Header ipHeader;             //!< IPv4 header of the first segment
+    Ptr<Ipv4Interface> interface;    //!< Interface of the first segment
+    SequenceNumber32 nextSequence;   //!< Sequence number that can be appended
+    uint32_t payload;                //!< Bytes of payload held
+    Time deadline;                   //!< Time to forward the segment up
+  };
+
+  /** The state of a connection */
+  struct Connection
+  {
+    Time lastArrival;                //!< Arrival of the last data segment
+    bool held {false};               //!< A segment is held
+    std::list<Held>::iterator it;    //!< The held segment
+  };
+
+  /**
+   * \param tcpHeader the TCP header of a segment
+   * \param payload the payload size of the segment
+   * \return true if the segment can be held
+   */
+  static bool IsMergeable (const TcpHeader &tcpHeader, uint32_t payload);
+
+  /**
+   * \param held the held segment
+   * \param tcpHeader the TCP header of a mergeable segment
+   * \param ipHeader the IPv4 header of the segment
+   * \param incomingInterface the interface of the segment
+   * \param payload the payload size of the segment
+   * \return true if the segment can be appended to \p held
+   */
+  bool CanAppend (const Held &held, const TcpHeader &tcpHeader,
+                  const Ipv4Header &ipHeader, Ptr<Ipv4Interface> incomingInterface,
+                  uint32_t payload) const;
+
+  /**
+   * \brief Forward a held segment up and forget it
+   * \param it the held segment
+   */
+  void Forward (std::list<Held>::iterator it);
+
+  /** \brief Forward up the segments whose time is over, and rearm the event */
+  void Flush (void);
+
+  /** \brief Move the event to the earliest deadline */
+  void Arm (void);
+
+  Time m_timeout;          //!< Time a segment is held for
+  uint32_t m_maxSize;      //!< Payload bytes a merged segment is forwarded up at
+
+  std::list<Held> m_held;  //!< Held segments, by deadline
+  std::unordered_map<Ipv4EndPoint *, Connection> m_connections; //!< Connections, by end point
+  EventId m_event;         //!< Event of the earliest deadline
+  Time m_eventTime;        //!< Time of m_event
+  uint64_t m_forwarded {0}; //!< Segments forwarded up
+  uint64_t m_merged {0};    //!< Segments appended to a held segment
+};
+
+} // namespace ns3
+
+#endif /* TCP_GRO_H */
@@ -544,4 +544,38 @@ operator<< (std::ostream& os, TcpHeader const & tc)
   return os;
 }
 
+void
+HeaderCacheTraits<TcpHeader>::Normalize (TcpHeader &header)
+{
+  // Deserialize reads the padding of the options as an END option
+  if (header.m_optionsLen % 4)
+    {
+      static Ptr<const TcpOption> end = TcpOption::CreateOption (TcpOption::END);
+      header.m_options.push_back (end);
+      header.m_optionsLen = (header.m_length - 5) * 4;
+    }
+  // the checksum written by Serialize is right, if it writes one
+  header.m_goodChecksum = true;
+}
+
+bool
+HeaderCacheTraits<TcpHeader>::Load (TcpHeader &header, const TcpHeader &cached)
+{
+  if (header.m_calcChecksum && !cached.m_calcChecksum)
+    {
+      return false;
+    }
+  // keep the pseudo-header of the reader
+  Address source = header.m_source;
+  Address destination = header.m_destination;
+  uint8_t protocol = header.m_protocol;
+  bool calcChecksum = header.m_calcChecksum;
+  header = cached;
+  header.m_source = source;
+  header.m_destination = destination;
+  header.m_protocol = protocol;
+  header.m_calcChecksum = calcChecksum;
+  return true;
+}
+
 } // namespace ns3
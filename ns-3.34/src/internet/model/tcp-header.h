@@ -315,6 +315,8 @@ public:
   friend bool operator== (const TcpHeader &lhs, const TcpHeader &rhs);
 
 private:
+  friend struct HeaderCacheTraits<TcpHeader>;
+
   /**
    * \brief Calculate the header checksum
    * \param size packet size
@@ -353,6 +355,29 @@ private:
   uint8_t m_optionsLen;        //!< Tcp options length.
 };
 
+/**
+ * \brief Keep decoded TcpHeader on packets, see Packet::EnableHeaderCache.
+ *
+ * A cached header shares its options with the header it was decoded
+ * from, or added as, which saves creating the options of every segment
+ * again in each reader.
+ */
+template <>
+struct HeaderCacheTraits<TcpHeader>
+{
+  static const bool cached = true;  //!< TcpHeader is cached
+  /**
+   * \param header a header given to Packet::AddHeader
+   */
+  static void Normalize (TcpHeader &header);
+  /**
+   * \param header the header to set
+   * \param cached the decoded header
+   * \returns false if header checks the checksum and cached did not
+   */
+  static bool Load (TcpHeader &header, const TcpHeader &cached);
+};
+
 } // namespace ns3
 
 #endif /* TCP_HEADER */
@@ -23,6 +23,7 @@
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
 #include "ns3/object-vector.h"
+#include "ns3/config.h"
 
 #include "ns3/packet.h"
 #include "ns3/node.h"
@@ -45,6 +46,8 @@
 #include "tcp-cubic.h"
 #include "tcp-recovery-ops.h"
 #include "tcp-prr-recovery.h"
+#include "tcp-pacing-scheduler.h"
+#include "tcp-gro.h"
 #include "rtt-estimator.h"
 
 #include <vector>
@@ -88,6 +91,18 @@ TcpL4Protocol::GetTypeId (void)
                    TypeIdValue (TcpPrrRecovery::GetTypeId ()),
                    MakeTypeIdAccessor (&TcpL4Protocol::m_recoveryTypeId),
                    MakeTypeIdChecker ())
+    .AddAttribute ("SharedPacing",
+                   "Pace the sockets of the node with one TcpPacingScheduler "
+                   "instead of a timer per socket.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpL4Protocol::m_sharedPacing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Gro",
+                   "Coalesce the in-order data segments received over IPv4 "
+                   "with a TcpGro before forwarding them up to the sockets.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpL4Protocol::m_enableGro),
+                   MakeBooleanChecker ())
     .AddAttribute ("SocketList", "The list of sockets associated to this protocol.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
@@ -97,7 +112,9 @@ TcpL4Protocol::GetTypeId (void)
 }
 
 TcpL4Protocol::TcpL4Protocol ()
-  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ())
+  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ()),
+    m_sharedPacing (false),
+    m_enableGro (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -163,6 +180,18 @@ TcpL4Protocol::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_sockets.clear ();
 
+  if (m_pacingScheduler != nullptr)
+    {
+      m_pacingScheduler->Dispose ();
+      m_pacingScheduler = nullptr;
+    }
+
+  if (m_gro != nullptr)
+    {
+      m_gro->Dispose ();
+      m_gro = nullptr;
+    }
+
   if (m_endPoints != 0)
     {
       delete m_endPoints;
@@ -208,8 +237,17 @@ TcpL4Protocol::CreateSocket (TypeId congestionTypeId, TypeId recoveryTypeId)
   socket->SetRtt (rtt);
   socket->SetCongestionControlAlgorithm (algo);
   socket->SetRecoveryAlgorithm (recovery);
+  if (m_sharedPacing)
+    {
+      if (m_pacingScheduler == nullptr)
+        {
+          m_pacingScheduler = CreateObject<TcpPacingScheduler> ();
+        }
+      socket->SetPacingScheduler (m_pacingScheduler);
+    }
 
   m_sockets.push_back (socket);
+  Config::NotifyNamespaceChanged (this);
   return socket;
 }
 
@@ -262,6 +300,10 @@ void
 TcpL4Protocol::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
+  if (m_gro != nullptr)
+    {
+      m_gro->DeAllocate (endPoint);
+    }
   m_endPoints->DeAllocate (endPoint);
 }
 
@@ -491,6 +533,17 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
   NS_LOG_LOGIC ("TcpL4Protocol " << this << " received a packet and"
                 " now forwarding it up to endpoint/socket");
 
+  if (m_enableGro)
+    {
+      if (m_gro == nullptr)
+        {
+          m_gro = CreateObject<TcpGro> ();
+        }
+      m_gro->Receive (packet, incomingTcpHeader, incomingIpHeader,
+                      incomingInterface, *endPoints.begin ());
+      return IpL4Protocol::RX_OK;
+    }
+
   (*endPoints.begin ())->ForwardUp (packet, incomingIpHeader,
                                     incomingTcpHeader.GetSourcePort (),
                                     incomingInterface);
@@ -720,6 +773,7 @@ TcpL4Protocol::AddSocket (Ptr<TcpSocketBase> socket)
     }
 
   m_sockets.push_back (socket);
+  Config::NotifyNamespaceChanged (this);
 }
 
 bool
@@ -733,6 +787,7 @@ TcpL4Protocol::RemoveSocket (Ptr<TcpSocketBase> socket)
       if (*it == socket)
         {
           m_sockets.erase (it);
+          Config::NotifyNamespaceChanged (this);
           return true;
         }
 
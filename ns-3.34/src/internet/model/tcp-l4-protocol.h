@@ -38,6 +38,8 @@ class Ipv4EndPointDemux;
 class Ipv6EndPointDemux;
 class Ipv4Interface;
 class TcpSocketBase;
+class TcpPacingScheduler;
+class TcpGro;
 class Ipv4EndPoint;
 class Ipv6EndPoint;
 class NetDevice;
@@ -320,6 +322,10 @@ private:
   TypeId m_rttTypeId;              //!< The RTT Estimator TypeId
   TypeId m_congestionTypeId;       //!< The socket TypeId
   TypeId m_recoveryTypeId;         //!< The recovery TypeId
+  bool m_sharedPacing;             //!< Pace the sockets with one scheduler
+  Ptr<TcpPacingScheduler> m_pacingScheduler; //!< The pacing scheduler of the sockets, if shared
+  bool m_enableGro;                //!< Coalesce the received segments
+  Ptr<TcpGro> m_gro;               //!< The coalescing stage, if enabled
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
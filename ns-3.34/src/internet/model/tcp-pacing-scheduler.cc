@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-pacing-scheduler.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpPacingScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpPacingScheduler);
+
+TypeId
+TcpPacingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpPacingScheduler")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpPacingScheduler> ()
+    .AddAttribute ("TimerSlack",
+                   "The gaps ending within this time of the earliest one are "
+                   "released with it.",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&TcpPacingScheduler::m_timerSlack),
+                   MakeTimeChecker (Time (0)))
+  ;
+  return tid;
+}
+
+TcpPacingScheduler::TcpPacingScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpPacingScheduler::~TcpPacingScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpPacingScheduler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_calendar.clear ();
+  Object::DoDispose ();
+}
+
+TcpPacingScheduler::Key
+TcpPacingScheduler::Schedule (const Time &delay, const Callback<void> &release)
+{
+  NS_LOG_FUNCTION (this << delay);
+  Key key (Simulator::Now () + delay, m_nextSequence++);
+  m_calendar.emplace (key, release);
+  // a gap scheduled by a released socket is armed at the end of Release ()
+  if (!m_releasing)
+    {
+      Arm ();
+    }
+  return key;
+}
+
+void
+TcpPacingScheduler::Cancel (const Key &key)
+{
+  NS_LOG_FUNCTION (this << key.first << key.second);
+  // the event is left in place: if it was for this gap, it finds nothing
+  // to release and moves to the next one
+  m_calendar.erase (key);
+}
+
+bool
+TcpPacingScheduler::IsPending (const Key &key) const
+{
+  return key.second != 0 && m_calendar.find (key) != m_calendar.end ();
+}
+
+Time
+TcpPacingScheduler::GetDelayLeft (const Key &key) const
+{
+  if (!IsPending (key))
+    {
+      return Time (0);
+    }
+  return key.first - Simulator::Now ();
+}
+
+uint32_t
+TcpPacingScheduler::GetNPending (void) const
+{
+  return m_calendar.size ();
+}
+
+void
+TcpPacingScheduler::Release (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time horizon = Simulator::Now () + m_timerSlack;
+  m_releasing = true;
+  while (!m_calendar.empty () && m_calendar.begin ()->first.first <= horizon)
+    {
+      Callback<void> release = m_calendar.begin ()->second;
+      m_calendar.erase (m_calendar.begin ());
+      release ();
+    }
+  m_releasing = false;
+  Arm ();
+}
+
+void
+TcpPacingScheduler::Arm (void)
+{
+  if (m_calendar.empty ())
+    {
+      m_event.Cancel ();
+      return;
+    }
+  Time next = m_calendar.begin ()->first.first;
+  if (m_event.IsRunning () && m_eventTime <= next)
+    {
+      // an earlier event rearms itself when it finds nothing to release
+      return;
+    }
+  m_event.Cancel ();
+  m_eventTime = next;
+  m_event = Simulator::Schedule (next - Simulator::Now (), &TcpPacingScheduler::Release, this);
+}
+
+} // namespace ns3
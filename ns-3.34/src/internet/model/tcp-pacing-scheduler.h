@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_PACING_SCHEDULER_H
+#define TCP_PACING_SCHEDULER_H
+
+#include <stdint.h>
+#include <map>
+#include <utility>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Pacing calendar shared by the TCP sockets of a node
+ *
+ * With pacing, a socket that sends a segment waits for the time the
+ * segment takes at its pacing rate before it sends the next one. By
+ * default each socket waits on its own timer, which costs one
+ * simulator event per paced segment and per flow.
+ *
+ * As the fq queue discipline of Linux, this scheduler keeps the end of
+ * the pacing gap of every socket of the node in a calendar ordered by
+ * time, and runs one simulator event for the earliest of them. When it
+ * expires, every socket whose gap ends within TimerSlack is released,
+ * in the order of the ends of their gaps, and the event is moved to the
+ * next gap. A socket released early starts its next gap at the end of
+ * the previous one (see TcpSocketBase::StartPacingGap), so the gaps end
+ * at the same times as with the timers of the sockets and the pacing
+ * rate of each socket is honored exactly; a segment may only leave up
+ * to TimerSlack before its time. With a zero slack, only the gaps that
+ * end at the same time share an event.
+ *
+ * It is enabled with the attribute TcpL4Protocol::SharedPacing.
+ */
+class TcpPacingScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpPacingScheduler ();
+  virtual ~TcpPacingScheduler ();
+
+  /**
+   * \brief A gap in the calendar: its end and a sequence number, that
+   * keeps the gaps ending at the same time in the order they were
+   * scheduled. The default key is never in the calendar.
+   */
+  typedef std::pair<Time, uint64_t> Key;
+
+  /**
+   * \brief Schedule the end of a pacing gap
+   * \param delay the length of the gap
+   * \param release the function to call when the gap is over
+   * \return the key of the gap
+   */
+  Key Schedule (const Time &delay, const Callback<void> &release);
+
+  /**
+   * \brief Remove a gap from the calendar, if it is still there
+   * \param key the key of the gap
+   */
+  void Cancel (const Key &key);
+
+  /**
+   * \param key the key of a gap
+   * \return true if the gap is not over
+   */
+  bool IsPending (const Key &key) const;
+
+  /**
+   * \param key the key of a gap
+   * \return the time left before the end of the gap, zero if it is over
+   */
+  Time GetDelayLeft (const Key &key) const;
+
+  /** \return the number of gaps in the calendar */
+  uint32_t GetNPending (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** \brief Release the sockets whose gap is over, and rearm the event */
+  void Release (void);
+
+  /** \brief Move the event to the earliest gap of the calendar */
+  void Arm (void);
+
+  std::map<Key, Callback<void> > m_calendar; //!< Gaps, by end and sequence number
+  uint64_t m_nextSequence {1};               //!< Sequence number of the next gap
+  EventId m_event;                           //!< Event of the earliest gap
+  Time m_timerSlack;                         //!< Gaps ending within this time are released together
+  Time m_eventTime;                          //!< Time of m_event
+  bool m_releasing {false};                  //!< Release () is running
+};
+
+} // namespace ns3
+
+#endif /* TCP_PACING_SCHEDULER_H */
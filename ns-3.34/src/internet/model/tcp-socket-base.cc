@@ -375,6 +375,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
     m_pacingTimer (Timer::CANCEL_ON_DESTROY),
+    m_pacingScheduler (sock.m_pacingScheduler),
     m_ecnEchoSeq (sock.m_ecnEchoSeq),
     m_ecnCESeq (sock.m_ecnCESeq),
     m_ecnCWRSeq (sock.m_ecnCWRSeq)
@@ -3234,11 +3235,11 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   if (IsPacingEnabled ())
     {
       NS_LOG_INFO ("Pacing is enabled");
-      if (m_pacingTimer.IsExpired ())
+      if (!IsPacingGapRunning ())
         {
           NS_LOG_DEBUG ("Current Pacing Rate " << m_tcb->m_pacingRate);
           NS_LOG_DEBUG ("Timer is in expired state, activate it " << m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
-          m_pacingTimer.Schedule (m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
+          StartPacingGap (m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
         }
       else
         {
@@ -3418,9 +3419,9 @@ TcpSocketBase::SendPendingData (bool withAck)
       if (IsPacingEnabled ())
         {
           NS_LOG_INFO ("Pacing is enabled");
-          if (m_pacingTimer.IsRunning ())
+          if (IsPacingGapRunning ())
             {
-              NS_LOG_INFO ("Skipping Packet due to pacing" << m_pacingTimer.GetDelayLeft ());
+              NS_LOG_INFO ("Skipping Packet due to pacing" << GetPacingGapLeft ());
               break;
             }
           NS_LOG_INFO ("Timer is not running");
@@ -3527,11 +3528,11 @@ TcpSocketBase::SendPendingData (bool withAck)
           if (IsPacingEnabled ())
             {
               NS_LOG_INFO ("Pacing is enabled");
-              if (m_pacingTimer.IsExpired ())
+              if (!IsPacingGapRunning ())
                 {
                   NS_LOG_DEBUG ("Current Pacing Rate " << m_tcb->m_pacingRate);
                   NS_LOG_DEBUG ("Timer is in expired state, activate it " << m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
-                  m_pacingTimer.Schedule (m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
+                  StartPacingGap (m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
                   break;
                 }
             }
@@ -4007,7 +4008,7 @@ TcpSocketBase::ReTxTimeout ()
   m_tcb->m_cWnd = m_tcb->m_segmentSize;
   m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
-  m_pacingTimer.Cancel ();
+  CancelPacingGap ();
 
   /*Modification*/
   wien_pacingTimer.Cancel();
@@ -4166,7 +4167,7 @@ TcpSocketBase::CancelAllTimers ()
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
-  m_pacingTimer.Cancel ();
+  CancelPacingGap ();
   /*Modification*/
   wien_pacingTimer.Cancel();
   /*Modification*/
@@ -4733,6 +4734,54 @@ TcpSocketBase::NotifyPacingPerformed (void)
   SendPendingData (m_connected);
 }
 
+void
+TcpSocketBase::StartPacingGap (const Time &delay)
+{
+  if (m_pacingScheduler == nullptr)
+    {
+      m_pacingTimer.Schedule (delay);
+      return;
+    }
+  // a gap released early by the slack of the scheduler is followed by
+  // a gap starting at its end, so that the pacing rate is kept
+  Time now = Simulator::Now ();
+  Time start = std::max (now, m_pacingKey.first);
+  m_pacingKey = m_pacingScheduler->Schedule (start - now + delay,
+                                             MakeCallback (&TcpSocketBase::NotifyPacingPerformed, this));
+}
+
+bool
+TcpSocketBase::IsPacingGapRunning (void) const
+{
+  if (m_pacingScheduler == nullptr)
+    {
+      return m_pacingTimer.IsRunning ();
+    }
+  return m_pacingScheduler->IsPending (m_pacingKey);
+}
+
+Time
+TcpSocketBase::GetPacingGapLeft (void) const
+{
+  if (m_pacingScheduler == nullptr)
+    {
+      return m_pacingTimer.GetDelayLeft ();
+    }
+  return m_pacingScheduler->GetDelayLeft (m_pacingKey);
+}
+
+void
+TcpSocketBase::CancelPacingGap (void)
+{
+  if (m_pacingScheduler == nullptr)
+    {
+      m_pacingTimer.Cancel ();
+      return;
+    }
+  m_pacingScheduler->Cancel (m_pacingKey);
+  m_pacingKey = TcpPacingScheduler::Key ();
+}
+
 bool
 TcpSocketBase::IsPacingEnabled (void) const
 {
@@ -4802,6 +4851,13 @@ TcpSocketBase::UpdatePacingRate (void)
     }
 }
 
+void
+TcpSocketBase::SetPacingScheduler (Ptr<TcpPacingScheduler> scheduler)
+{
+  NS_LOG_FUNCTION (this << scheduler);
+  m_pacingScheduler = scheduler;
+}
+
 void
 TcpSocketBase::SetPacingStatus (bool pacing)
 {
@@ -32,6 +32,7 @@
 #include "ns3/data-rate.h"
 #include "ns3/node.h"
 #include "ns3/tcp-socket-state.h"
+#include "ns3/tcp-pacing-scheduler.h"
 
 namespace ns3 {
 
@@ -596,6 +597,13 @@ public:
    */
   void SetPaceInitialWindow (bool paceWindow);
 
+  /**
+   * \brief Pace this socket with the scheduler shared by the sockets of
+   * the node, instead of its own timer
+   * \param scheduler the pacing scheduler of the node
+   */
+  void SetPacingScheduler (Ptr<TcpPacingScheduler> scheduler);
+
   // Necessary implementations of null functions from ns3::Socket
   virtual enum SocketErrno GetErrno (void) const;    // returns m_errno
   virtual enum SocketType GetSocketType (void) const; // returns socket type
@@ -1244,6 +1252,29 @@ protected:
    */
   bool IsPacingEnabled (void) const;
 
+  /**
+   * \brief Start the pacing gap after a segment, on the pacing timer or
+   * on the pacing scheduler of the node. On the scheduler, a gap that
+   * follows a gap released before its end starts at that end.
+   * \param delay the time the segment takes at the pacing rate
+   */
+  void StartPacingGap (const Time &delay);
+
+  /**
+   * \return true if the pacing gap of the last segment is not over
+   */
+  bool IsPacingGapRunning (void) const;
+
+  /**
+   * \return the time left in the pacing gap of the last segment
+   */
+  Time GetPacingGapLeft (void) const;
+
+  /**
+   * \brief Cancel the pacing gap of the last segment
+   */
+  void CancelPacingGap (void);
+
   /**
    * \brief Dynamically update the pacing rate
    */
@@ -1372,6 +1403,8 @@ protected:
 
   // Pacing related variable
   Timer m_pacingTimer {Timer::CANCEL_ON_DESTROY}; //!< Pacing Event
+  Ptr<TcpPacingScheduler> m_pacingScheduler;       //!< Pacing scheduler of the node, if shared
+  TcpPacingScheduler::Key m_pacingKey;             //!< Pacing gap in m_pacingScheduler
 
   /*Modification*/
   Timer wien_pacingTimer {Timer::CANCEL_ON_DESTROY};
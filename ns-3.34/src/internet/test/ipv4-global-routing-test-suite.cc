@@ -42,6 +42,8 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
 
 using namespace ns3;
 
@@ -1244,6 +1246,197 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting flow ECMP test
+ */
+class Ipv4GlobalRoutingFlowEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFlowEcmpTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Route a UDP packet of a flow out of a node.
+   * \param routing The routing protocol of the node.
+   * \param src The source address of the flow.
+   * \param dst The destination address of the flow.
+   * \param srcPort The source port of the flow.
+   * \param dstPort The destination port of the flow.
+   * \param moreFragments Whether the MF flag of the packet is set.
+   * \param fragmentOffset The fragment offset of the packet.
+   * \return The gateway of the route.
+   */
+  Ipv4Address RouteFlow (Ptr<Ipv4RoutingProtocol> routing, Ipv4Address src, Ipv4Address dst,
+                         uint16_t srcPort, uint16_t dstPort,
+                         bool moreFragments = false, uint16_t fragmentOffset = 0);
+  /**
+   * \brief ECMP hash returning the source port.
+   * \param src The source address.
+   * \param dst The destination address.
+   * \param prot The protocol.
+   * \param srcPort The source port.
+   * \param dstPort The destination port.
+   * \return The source port.
+   */
+  static uint32_t SourcePortHash (Ipv4Address src, Ipv4Address dst, uint8_t prot,
+                                  uint16_t srcPort, uint16_t dstPort);
+};
+
+Ipv4GlobalRoutingFlowEcmpTestCase::Ipv4GlobalRoutingFlowEcmpTestCase ()
+  : TestCase ("Flow ECMP keeps each flow on one route and spreads flows over equal-cost routes")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingFlowEcmpTestCase::RouteFlow (Ptr<Ipv4RoutingProtocol> routing, Ipv4Address src, Ipv4Address dst,
+                                              uint16_t srcPort, uint16_t dstPort,
+                                              bool moreFragments, uint16_t fragmentOffset)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (srcPort);
+  udp.SetDestinationPort (dstPort);
+  p->AddHeader (udp);
+  Ipv4Header header;
+  header.SetSource (src);
+  header.SetDestination (dst);
+  header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  if (moreFragments)
+    {
+      header.SetMoreFragments ();
+    }
+  header.SetFragmentOffset (fragmentOffset);
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = routing->RouteOutput (p, header, 0, err);
+  NS_ASSERT_MSG (route != 0, "No route to " << dst);
+  return route->GetGateway ();
+}
+
+uint32_t
+Ipv4GlobalRoutingFlowEcmpTestCase::SourcePortHash (Ipv4Address src, Ipv4Address dst, uint8_t prot,
+                                                   uint16_t srcPort, uint16_t dstPort)
+{
+  return srcPort;
+}
+
+// Diamond with two equal-cost paths from n0 to the /32 address of n3
+//
+//        /--10.1.1.0/30--n1--10.1.3.0/30--\
+//      n0                                   n3(192.168.1.1/32)
+//        \--10.1.2.0/30--n2--10.1.4.0/30--/
+//
+void
+Ipv4GlobalRoutingFlowEcmpTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  InternetStackHelper internet;
+  // only global routing, so that its ECMP routes are the ones used
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  uint32_t links[4][2] = {{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+  const char *bases[4] = {"10.1.1.0", "10.1.2.0", "10.1.3.0", "10.1.4.0"};
+  for (uint32_t l = 0; l < 4; l++)
+    {
+      NetDeviceContainer devices = devHelper.Install (NodeContainer (nodes.Get (links[l][0]), nodes.Get (links[l][1])));
+      ipv4.SetBase (bases[l], "255.255.255.252");
+      ipv4.Assign (devices);
+    }
+
+  Ptr<SimpleNetDevice> deviceDst = CreateObject<SimpleNetDevice> ();
+  deviceDst->SetAddress (Mac48Address::Allocate ());
+  nodes.Get (3)->AddDevice (deviceDst);
+  Ptr<Ipv4> ipv4Dst = nodes.Get (3)->GetObject<Ipv4> ();
+  int32_t ifIndexDst = ipv4Dst->AddInterface (deviceDst);
+  ipv4Dst->AddAddress (ifIndexDst, Ipv4InterfaceAddress (Ipv4Address ("192.168.1.1"), Ipv4Mask ("/32")));
+  ipv4Dst->SetMetric (ifIndexDst, 1);
+  ipv4Dst->SetUp (ifIndexDst);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Ipv4RoutingProtocol> routing = nodes.Get (0)->GetObject<Ipv4> ()->GetRoutingProtocol ();
+  Ptr<Ipv4GlobalRouting> globalRouting = routing->GetObject<Ipv4GlobalRouting> ();
+  NS_TEST_ASSERT_MSG_NE (globalRouting, 0, "Error-- no Ipv4GlobalRouting object");
+  globalRouting->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+
+  Ipv4Address src ("10.1.1.1");
+  Ipv4Address dst ("192.168.1.1");
+  Ipv4Address viaN1 ("10.1.1.2");
+  Ipv4Address viaN2 ("10.1.2.2");
+
+  // every packet of a flow takes the route its first packet took, and
+  // the flows are spread over both routes
+  const uint16_t numFlows = 200;
+  std::vector<Ipv4Address> gateways;
+  uint32_t numViaN1 = 0;
+  for (uint16_t f = 0; f < numFlows; f++)
+    {
+      Ipv4Address gw = RouteFlow (routing, src, dst, 49153 + f, 5000);
+      NS_TEST_ASSERT_MSG_EQ ((gw == viaN1 || gw == viaN2), true, "Flow " << f << " routed via " << gw);
+      numViaN1 += (gw == viaN1);
+      gateways.push_back (gw);
+    }
+  for (uint32_t round = 0; round < 5; round++)
+    {
+      for (uint16_t f = 0; f < numFlows; f++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (RouteFlow (routing, src, dst, 49153 + f, 5000), gateways[f],
+                                 "Flow " << f << " changed route");
+        }
+    }
+  // with a uniform hash each route gets 100 +- 3 standard deviations of ~7 flows
+  NS_TEST_EXPECT_MSG_GT (numViaN1, 70, "Too few flows via n1");
+  NS_TEST_EXPECT_MSG_LT (numViaN1, 130, "Too many flows via n1");
+
+  // a flow differing only in the destination port may take the other route
+  bool otherRoute = false;
+  for (uint16_t dstPort = 5001; dstPort < 5100 && !otherRoute; dstPort++)
+    {
+      otherRoute = RouteFlow (routing, src, dst, 49153, dstPort) != gateways[0];
+    }
+  NS_TEST_EXPECT_MSG_EQ (otherRoute, true, "The destination port is not part of the hash");
+
+  // a custom hash picks the route by the hash modulo the number of routes
+  globalRouting->SetEcmpHashCallback (MakeCallback (&Ipv4GlobalRoutingFlowEcmpTestCase::SourcePortHash));
+  Ipv4Address evenRoute = RouteFlow (routing, src, dst, 2, 5000);
+  Ipv4Address oddRoute = RouteFlow (routing, src, dst, 3, 5000);
+  NS_TEST_EXPECT_MSG_NE (evenRoute, oddRoute, "Hashes 2 and 3 took the same route");
+  for (uint16_t port = 4; port < 40; port++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (RouteFlow (routing, src, dst, port, 5000), (port % 2 ? oddRoute : evenRoute),
+                             "Hash " << port << " took the wrong route");
+    }
+
+  // the fragments of a datagram are hashed without the ports (as port 0),
+  // the first one included, so that they all take the same route
+  NS_TEST_EXPECT_MSG_EQ (RouteFlow (routing, src, dst, 3, 5000, true, 0), evenRoute,
+                         "The first fragment was hashed on its ports");
+  NS_TEST_EXPECT_MSG_EQ (RouteFlow (routing, src, dst, 3, 5000, true, 1480), evenRoute,
+                         "A middle fragment was hashed on its payload");
+  NS_TEST_EXPECT_MSG_EQ (RouteFlow (routing, src, dst, 3, 5000, false, 2960), evenRoute,
+                         "The last fragment was hashed on its payload");
+
+  // without flow ECMP, all the flows take the first route
+  globalRouting->SetAttribute ("FlowEcmpRouting", BooleanValue (false));
+  Ipv4Address firstRoute = RouteFlow (routing, src, dst, 2, 5000);
+  for (uint16_t port = 3; port < 40; port++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (RouteFlow (routing, src, dst, port, 5000), firstRoute,
+                             "Flow ECMP disabled but flow " << port << " took another route");
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1460,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingFlowEcmpTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+#include "ns3/tcp-gro.h"
+#include "ns3/tcp-option-ts.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpGroTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief Check which segments TcpGro merges, and when it forwards them up
+ */
+class TcpGroTestCase : public TestCase
+{
+public:
+  TcpGroTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive a data segment of 1000 bytes
+   * \param seq the sequence number
+   * \param flags the TCP flags
+   * \param tsValue the timestamp
+   */
+  void Send (uint32_t seq, uint8_t flags, uint32_t tsValue);
+
+  /**
+   * \brief Record a segment forwarded up
+   * \param p the segment
+   * \param header the IPv4 header
+   * \param sport the source port
+   * \param incomingInterface the interface
+   */
+  void ForwardUp (Ptr<Packet> p, Ipv4Header header, uint16_t sport,
+                  Ptr<Ipv4Interface> incomingInterface);
+
+  /** A segment forwarded up */
+  struct Forwarded
+  {
+    Time time;     //!< Time it was forwarded up
+    uint32_t seq;  //!< Sequence number
+    uint32_t size; //!< Payload size
+  };
+
+  Ptr<TcpGro> m_gro;                   //!< The tested GRO
+  Ipv4EndPoint *m_endPoint;            //!< The end point of the connection
+  uint32_t m_closeAt;                  //!< Deallocate the end point when this segment is forwarded up
+  std::vector<Forwarded> m_forwarded;  //!< The segments forwarded up
+};
+
+TcpGroTestCase::TcpGroTestCase ()
+  : TestCase ("Merge in-order data segments and forward them up in order"),
+    m_closeAt (0)
+{
+}
+
+void
+TcpGroTestCase::Send (uint32_t seq, uint8_t flags, uint32_t tsValue)
+{
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (2000);
+  tcpHeader.SetDestinationPort (1000);
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (seq));
+  tcpHeader.SetAckNumber (SequenceNumber32 (1));
+  tcpHeader.SetFlags (flags);
+  Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+  ts->SetTimestamp (tsValue);
+  ts->SetEcho (7);
+  tcpHeader.AppendOption (ts);
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddHeader (tcpHeader);
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.1"));
+  m_gro->Receive (p, tcpHeader, ipHeader, 0, m_endPoint);
+}
+
+void
+TcpGroTestCase::ForwardUp (Ptr<Packet> p, Ipv4Header header, uint16_t sport,
+                           Ptr<Ipv4Interface> incomingInterface)
+{
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+  NS_TEST_EXPECT_MSG_EQ (sport, 2000, "Wrong source port");
+  m_forwarded.push_back ({Simulator::Now (), tcpHeader.GetSequenceNumber ().GetValue (), p->GetSize ()});
+  if (tcpHeader.GetSequenceNumber ().GetValue () == m_closeAt)
+    {
+      // as a socket that closes on this segment
+      m_gro->DeAllocate (m_endPoint);
+    }
+}
+
+void
+TcpGroTestCase::DoRun (void)
+{
+  m_gro = CreateObject<TcpGro> ();
+  m_gro->SetAttribute ("Timeout", TimeValue (MicroSeconds (100)));
+  m_endPoint = new Ipv4EndPoint (Ipv4Address ("10.0.0.1"), 1000);
+  m_endPoint->SetPeer (Ipv4Address ("10.0.0.2"), 2000);
+  m_endPoint->SetRxCallback (MakeCallback (&TcpGroTestCase::ForwardUp, this));
+
+  uint8_t ack = TcpHeader::ACK;
+  // first segment of the connection: nothing to merge it with yet
+  Simulator::Schedule (MicroSeconds (0), &TcpGroTestCase::Send, this, 1, ack, 1);
+  // held, then two segments are appended to it
+  Simulator::Schedule (MicroSeconds (10), &TcpGroTestCase::Send, this, 1001, ack, 1);
+  Simulator::Schedule (MicroSeconds (20), &TcpGroTestCase::Send, this, 2001, ack, 1);
+  Simulator::Schedule (MicroSeconds (25), &TcpGroTestCase::Send, this, 3001, ack, 1);
+  // a hole: the merged segment is forwarded up, this one is held
+  Simulator::Schedule (MicroSeconds (30), &TcpGroTestCase::Send, this, 5001, ack, 1);
+  // another timestamp: the held segment is forwarded up, this one is held
+  Simulator::Schedule (MicroSeconds (35), &TcpGroTestCase::Send, this, 6001, ack, 2);
+  // a FIN: forwarded up after the held segment
+  Simulator::Schedule (MicroSeconds (40), &TcpGroTestCase::Send, this, 7001, ack | TcpHeader::FIN, 2);
+  // too long after the previous segment to be held
+  Simulator::Schedule (MicroSeconds (200), &TcpGroTestCase::Send, this, 8001, ack, 2);
+  // held, and forwarded up when its time is over
+  Simulator::Schedule (MicroSeconds (250), &TcpGroTestCase::Send, this, 9001, ack, 2);
+  Simulator::Run ();
+
+  Forwarded expected[] = {
+    {MicroSeconds (0), 1, 1000},
+    {MicroSeconds (30), 1001, 3000},
+    {MicroSeconds (35), 5001, 1000},
+    {MicroSeconds (40), 6001, 1000},
+    {MicroSeconds (40), 7001, 1000},
+    {MicroSeconds (200), 8001, 1000},
+    {MicroSeconds (350), 9001, 1000},
+  };
+  uint32_t n = sizeof (expected) / sizeof (expected[0]);
+  NS_TEST_ASSERT_MSG_EQ (m_forwarded.size (), n, "Wrong number of segments forwarded up");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_forwarded[i].time, expected[i].time, "Segment " << i << " forwarded up at the wrong time");
+      NS_TEST_EXPECT_MSG_EQ (m_forwarded[i].seq, expected[i].seq, "Segment " << i << " has the wrong sequence number");
+      NS_TEST_EXPECT_MSG_EQ (m_forwarded[i].size, expected[i].size, "Segment " << i << " has the wrong size");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_gro->GetNMerged (), 2, "Wrong number of merged segments");
+
+  // a segment held for a deallocated end point is forgotten
+  Simulator::Schedule (MicroSeconds (10), &TcpGroTestCase::Send, this, 10001, ack, 2);
+  Simulator::Schedule (MicroSeconds (20), &TcpGroTestCase::Send, this, 11001, ack, 2);
+  Simulator::Stop (MicroSeconds (30));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded.size (), n + 1, "The last segment was not held");
+  m_gro->DeAllocate (m_endPoint);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded.size (), n + 1, "A segment was forwarded up after DeAllocate");
+
+  // the end point is deallocated while forwarding up the held segment:
+  // the segment that made it go is not forwarded up nor held
+  m_closeAt = 13001;
+  Simulator::Schedule (MicroSeconds (10), &TcpGroTestCase::Send, this, 12001, ack, 3);
+  Simulator::Schedule (MicroSeconds (20), &TcpGroTestCase::Send, this, 13001, ack, 3);
+  Simulator::Schedule (MicroSeconds (30), &TcpGroTestCase::Send, this, 15001, ack, 3);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_forwarded.size (), n + 3, "Wrong number of segments forwarded up");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded.back ().seq, 13001, "A segment was forwarded up after its end point was deallocated");
+
+  delete m_endPoint;
+  m_gro->Dispose ();
+  m_gro = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief TcpGro TestSuite
+ */
+class TcpGroTestSuite : public TestSuite
+{
+public:
+  TcpGroTestSuite ()
+    : TestSuite ("tcp-gro", UNIT)
+  {
+    AddTestCase (new TcpGroTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpGroTestSuite g_tcpGroTestSuite; //!< Static variable for test initialization
@@ -24,6 +24,9 @@
 #include "ns3/tcp-header.h"
 #include "ns3/buffer.h"
 #include "ns3/tcp-option-rfc793.h"
+#include "ns3/tcp-option-ts.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -421,6 +424,114 @@ TcpHeaderFlagsToString::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the headers kept decoded on a packet read as the
+ * serialized ones (Packet::EnableHeaderCache).
+ */
+class TcpHeaderCacheTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param name Test description.
+   */
+  TcpHeaderCacheTestCase (std::string name);
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+TcpHeaderCacheTestCase::TcpHeaderCacheTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+TcpHeaderCacheTestCase::DoRun (void)
+{
+  Packet::EnableHeaderCache ();
+
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (1000);
+  tcpHeader.SetDestinationPort (2000);
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (1448));
+  tcpHeader.SetFlags (TcpHeader::ACK);
+  Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+  ts->SetTimestamp (10);
+  ts->SetEcho (20);
+  tcpHeader.AppendOption (ts);
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.1.1.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.2.1.1"));
+  ipHeader.SetProtocol (6);
+  ipHeader.SetTtl (64);
+
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (tcpHeader);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  p->AddHeader (ipHeader);
+
+  // the reference: the same bytes, without any kept header
+  uint32_t size = p->GetSerializedSize ();
+  std::vector<uint8_t> bytes (size);
+  p->Serialize (bytes.data (), size);
+  Ptr<Packet> raw = Create<Packet> (bytes.data (), size, true);
+
+  Ptr<Packet> copy = p->Copy ();
+  Ipv4Header ip, rawIp;
+  copy->RemoveHeader (ip);
+  raw->RemoveHeader (rawIp);
+  NS_TEST_ASSERT_MSG_EQ (ip.GetSource (), rawIp.GetSource (), "Kept IPv4 header differs");
+  NS_TEST_ASSERT_MSG_EQ (ip.GetDestination (), rawIp.GetDestination (), "Kept IPv4 header differs");
+  NS_TEST_ASSERT_MSG_EQ (ip.GetPayloadSize (), rawIp.GetPayloadSize (), "Kept IPv4 header differs");
+  NS_TEST_ASSERT_MSG_EQ (ip.GetTtl (), 64, "Wrong TTL");
+
+  TcpHeader peek, rawPeek;
+  copy->PeekHeader (peek);
+  raw->PeekHeader (rawPeek);
+  NS_TEST_ASSERT_MSG_EQ (peek, rawPeek, "Kept TCP header differs");
+  NS_TEST_ASSERT_MSG_EQ (peek.GetSequenceNumber (), SequenceNumber32 (1448), "Wrong sequence number");
+  NS_TEST_ASSERT_MSG_EQ (peek.HasOption (TcpOption::TS), true, "TS option lost");
+  NS_TEST_ASSERT_MSG_EQ (peek.GetSerializedSize (), rawPeek.GetSerializedSize (), "Wrong size");
+
+  // a header with the checksum computed is not taken from a kept one
+  TcpHeader checked;
+  checked.EnableChecksums ();
+  checked.InitializeChecksum (ip.GetSource (), ip.GetDestination (), 6);
+  copy->PeekHeader (checked);
+  NS_TEST_ASSERT_MSG_EQ (checked.GetSequenceNumber (), SequenceNumber32 (1448), "Wrong sequence number");
+
+  // the kept headers are dropped when the end of the packet changes
+  copy->RemoveAtEnd (50);
+  raw->RemoveAtEnd (50);
+  TcpHeader removed, rawRemoved;
+  copy->RemoveHeader (removed);
+  raw->RemoveHeader (rawRemoved);
+  NS_TEST_ASSERT_MSG_EQ (removed, rawRemoved, "TCP header differs after RemoveAtEnd");
+  NS_TEST_ASSERT_MSG_EQ (copy->GetSize (), 50, "Wrong payload size");
+
+  // the original packet still reads its own headers
+  Ipv4Header origIp;
+  p->RemoveHeader (origIp);
+  NS_TEST_ASSERT_MSG_EQ (origIp.GetPayloadSize (), rawIp.GetPayloadSize (), "IPv4 header of the original differs");
+  TcpHeader origTcp;
+  p->RemoveHeader (origTcp);
+  NS_TEST_ASSERT_MSG_EQ (origTcp, rawPeek, "TCP header of the original differs");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 100, "Wrong payload size");
+}
+
+void
+TcpHeaderCacheTestCase::DoTeardown (void)
+{
+  // the cache is process-global, do not leave it on for the next tests
+  Packet::DisableHeaderCache ();
+}
+
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -436,6 +547,7 @@ public:
     AddTestCase (new TcpHeaderGetSetTestCase ("GetSet test cases"), TestCase::QUICK);
     AddTestCase (new TcpHeaderWithRFC793OptionTestCase ("Test for options in RFC 793"), TestCase::QUICK);
     AddTestCase (new TcpHeaderFlagsToString ("Test flags to string function"), TestCase::QUICK);
+    AddTestCase (new TcpHeaderCacheTestCase ("Test headers kept decoded on packets"), TestCase::QUICK);
   }
 
 };
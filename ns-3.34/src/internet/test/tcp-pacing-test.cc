@@ -23,6 +23,7 @@
 #include "ns3/config.h"
 #include "ns3/test.h"
 #include "tcp-general-test.h"
+#include "ns3/tcp-pacing-scheduler.h"
 
 using namespace ns3;
 
@@ -103,11 +104,13 @@ public:
    * \param delAckMaxCount Delayed ACK max count parameter
    * \param congControl Type of congestion control.
    * \param desc The test description.
+   * \param sharedPacing whether to pace the sender with a TcpPacingScheduler
    */
   TcpPacingTest (uint32_t segmentSize, uint32_t packetSize,
                  uint32_t packets, uint16_t pacingSsRatio, uint16_t pacingCaRatio,
                  uint32_t ssThresh, bool paceInitialWindow, uint32_t delAckMaxCount,
-                 const TypeId& congControl, const std::string &desc);
+                 const TypeId& congControl, const std::string &desc,
+                 bool sharedPacing = false);
 
 protected:
   virtual void CWndTrace (uint32_t oldValue, uint32_t newValue);
@@ -149,6 +152,7 @@ private:
   uint32_t m_packetsSent;             //!< Number of packets sent by sender so far
   Time     m_nextPacketInterval;      //!< Time maintained by Tx () trace about interval at which next packet will be sent
   Time     m_tracedRtt;               //!< Traced value of RTT, which may be different from the environment RTT in case of delayed ACKs
+  bool     m_sharedPacing;            //!< True if the sender is paced by a TcpPacingScheduler
 };
 
 
@@ -161,7 +165,8 @@ TcpPacingTest::TcpPacingTest (uint32_t segmentSize,
                               bool paceInitialWindow,
                               uint32_t delAckMaxCount,
                               const TypeId &typeId,
-                              const std::string &desc)
+                              const std::string &desc,
+                              bool sharedPacing)
   : TcpGeneralTest (desc),
     m_segmentSize (segmentSize),
     m_packetSize (packetSize),
@@ -182,7 +187,8 @@ TcpPacingTest::TcpPacingTest (uint32_t segmentSize,
     m_expectedInterval (Seconds (0)),
     m_packetsSent (0),
     m_nextPacketInterval (Seconds (0)),
-    m_tracedRtt (Seconds (0))
+    m_tracedRtt (Seconds (0)),
+    m_sharedPacing (sharedPacing)
 {
   m_congControlTypeId = typeId;
 }
@@ -208,6 +214,10 @@ void TcpPacingTest::ConfigureProperties ()
   SetPacingStatus (SENDER, true);
   SetPaceInitialWindow (SENDER, m_paceInitialWindow);
   SetDelAckMaxCount (RECEIVER, m_delAckMaxCount);
+  if (m_sharedPacing)
+    {
+      GetSenderSocket ()->SetPacingScheduler (CreateObject<TcpPacingScheduler> ());
+    }
   NS_LOG_DEBUG ("segSize: " << m_segmentSize << " ssthresh: " << m_ssThresh <<
                 " paceInitialWindow: " << m_paceInitialWindow << " delAckMaxCount " << m_delAckMaxCount);
 }
@@ -407,6 +417,21 @@ public:
     ssThresh = 40;
     numPackets = 60;
     AddTestCase (new TcpPacingTest (segmentSize, packetSize, numPackets, pacingSsRatio, pacingCaRatio, ssThresh, paceInitialWindow, delAckMaxCount, tid, description), TestCase::QUICK);
+
+    // Repeat cases 2 and 6 with the pacing scheduler shared by the sockets of the node
+    delAckMaxCount = 1;
+    paceInitialWindow = true;
+    ssThresh = 1e9;
+    numPackets = 40;
+    description = std::string ("Pacing case 7: Slow start only, initial pacing, shared pacing scheduler");
+    AddTestCase (new TcpPacingTest (segmentSize, packetSize, numPackets, pacingSsRatio, pacingCaRatio, ssThresh, paceInitialWindow, delAckMaxCount, tid, description, true), TestCase::QUICK);
+
+    description = std::string ("Pacing case 8: Slow start, followed by transition to Congestion avoidance, no initial pacing, delayed ACKs, shared pacing scheduler");
+    delAckMaxCount = 2;
+    paceInitialWindow = false;
+    ssThresh = 40;
+    numPackets = 60;
+    AddTestCase (new TcpPacingTest (segmentSize, packetSize, numPackets, pacingSsRatio, pacingCaRatio, ssThresh, paceInitialWindow, delAckMaxCount, tid, description, true), TestCase::QUICK);
   }
 };
 
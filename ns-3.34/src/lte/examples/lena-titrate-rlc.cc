@@ -0,0 +1,180 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/flow-monitor-module.h"
+
+using namespace ns3;
+
+/**
+ * LTE bottleneck for the Titrate RLC buffer mode.
+ *
+ * A remote host sends bulk TCP downloads to UEs attached to one eNB. The
+ * eNB RLC transmit buffer is the bottleneck queue. Run it once with a large
+ * MaxTxBufferSize (the default unbounded-looking RLC queue) and once with
+ * --titrate to let Titrate adapt the admission threshold below it, starting
+ * from startProbeBuffer, then compare the per-flow delay, which is dominated
+ * by RLC queuing:
+ *
+ *   ./waf --run "lena-titrate-rlc"
+ *   ./waf --run "lena-titrate-rlc --titrate=1"
+ *   ./waf --run "lena-titrate-rlc --titrate=1 --rlcAm=1"
+ */
+
+NS_LOG_COMPONENT_DEFINE ("LenaTitrateRlc");
+
+int
+main (int argc, char *argv[])
+{
+  uint16_t numUes = 1;
+  Time simTime = Seconds (20);
+  double distance = 500.0;
+  uint32_t maxTxBufferSize = 10 * 1024 * 1024;
+  bool titrate = false;
+  bool rlcAm = false;
+  uint16_t monitorInterval = 500;
+  uint32_t startProbeBuffer = 15000;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("numUes", "Number of UEs attached to the eNB", numUes);
+  cmd.AddValue ("simTime", "Total duration of the simulation", simTime);
+  cmd.AddValue ("distance", "Distance between the eNB and the UEs [m]", distance);
+  cmd.AddValue ("maxTxBufferSize", "RLC transmit buffer size in bytes", maxTxBufferSize);
+  cmd.AddValue ("titrate", "Let Titrate adapt the RLC admission threshold", titrate);
+  cmd.AddValue ("rlcAm", "Use RLC AM instead of RLC UM", rlcAm);
+  cmd.AddValue ("monitorInterval", "Titrate monitoring window after a drop [ms]", monitorInterval);
+  cmd.AddValue ("startProbeBuffer", "Titrate starting threshold in bytes, 0 to start at maxTxBufferSize", startProbeBuffer);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::LteEnbRrc::EpsBearerToRlcMapping",
+                      EnumValue (rlcAm ? LteEnbRrc::RLC_AM_ALWAYS : LteEnbRrc::RLC_UM_ALWAYS));
+  Config::SetDefault ("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue (maxTxBufferSize));
+  Config::SetDefault ("ns3::LteRlcAm::MaxTxBufferSize", UintegerValue (maxTxBufferSize));
+  Config::SetDefault ("ns3::LteRlcUm::EnableTitrate", BooleanValue (titrate));
+  Config::SetDefault ("ns3::LteRlcAm::EnableTitrate", BooleanValue (titrate));
+  Config::SetDefault ("ns3::TitrateBufferController::MonitorInterval", UintegerValue (monitorInterval));
+  Config::SetDefault ("ns3::TitrateBufferController::InitialThreshold", UintegerValue (startProbeBuffer));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (maxTxBufferSize));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (maxTxBufferSize));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper> ();
+  lteHelper->SetEpcHelper (epcHelper);
+
+  Ptr<Node> pgw = epcHelper->GetPgwNode ();
+
+  // Create a single RemoteHost behind a fast link, so that the radio is the bottleneck
+  NodeContainer remoteHostContainer;
+  remoteHostContainer.Create (1);
+  Ptr<Node> remoteHost = remoteHostContainer.Get (0);
+  InternetStackHelper internet;
+  internet.Install (remoteHostContainer);
+
+  PointToPointHelper p2ph;
+  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+  p2ph.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  p2ph.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  NetDeviceContainer internetDevices = p2ph.Install (pgw, remoteHost);
+  Ipv4AddressHelper ipv4h;
+  ipv4h.SetBase ("1.0.0.0", "255.0.0.0");
+  ipv4h.Assign (internetDevices);
+
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> remoteHostStaticRouting = ipv4RoutingHelper.GetStaticRouting (remoteHost->GetObject<Ipv4> ());
+  remoteHostStaticRouting->AddNetworkRouteTo (Ipv4Address ("7.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+
+  NodeContainer enbNodes;
+  NodeContainer ueNodes;
+  enbNodes.Create (1);
+  ueNodes.Create (numUes);
+
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0, 0, 0));
+  for (uint16_t i = 0; i < numUes; i++)
+    {
+      positionAlloc->Add (Vector (distance, 0, 0));
+    }
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+
+  NetDeviceContainer enbLteDevs = lteHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueLteDevs = lteHelper->InstallUeDevice (ueNodes);
+
+  internet.Install (ueNodes);
+  Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address (NetDeviceContainer (ueLteDevs));
+  for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+    {
+      Ptr<Ipv4StaticRouting> ueStaticRouting = ipv4RoutingHelper.GetStaticRouting (ueNodes.Get (u)->GetObject<Ipv4> ());
+      ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1);
+    }
+  lteHelper->Attach (ueLteDevs, enbLteDevs.Get (0));
+
+  // One bulk TCP download per UE
+  uint16_t dlPort = 1100;
+  ApplicationContainer clientApps;
+  ApplicationContainer serverApps;
+  for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+    {
+      PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), dlPort));
+      serverApps.Add (sink.Install (ueNodes.Get (u)));
+
+      BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (ueIpIface.GetAddress (u), dlPort));
+      source.SetAttribute ("MaxBytes", UintegerValue (0));
+      clientApps.Add (source.Install (remoteHost));
+    }
+  serverApps.Start (MilliSeconds (500));
+  clientApps.Start (MilliSeconds (500));
+
+  FlowMonitorHelper flowHelper;
+  Ptr<FlowMonitor> flowMonitor = flowHelper.Install (NodeContainer (remoteHost, ueNodes));
+
+  Simulator::Stop (simTime);
+  Simulator::Run ();
+
+  flowMonitor->CheckForLostPackets ();
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
+  std::cout << "RLC " << (rlcAm ? "AM" : "UM")
+            << ", MaxTxBufferSize " << maxTxBufferSize << " B"
+            << (titrate ? ", Titrate" : ", no Titrate") << std::endl;
+  for (const auto& flow : flowMonitor->GetFlowStats ())
+    {
+      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (flow.first);
+      if (t.sourceAddress != remoteHost->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ()
+          || flow.second.rxPackets == 0)
+        {
+          continue; // only report the downlink data direction
+        }
+      const FlowMonitor::FlowStats& st = flow.second;
+      double duration = (st.timeLastRxPacket - st.timeFirstTxPacket).GetSeconds ();
+      std::cout << "Flow " << flow.first << " (" << t.sourceAddress << " -> " << t.destinationAddress << ")"
+                << "  throughput " << st.rxBytes * 8.0 / duration / 1e6 << " Mbps"
+                << "  mean delay " << st.delaySum.GetMilliSeconds () / (double) st.rxPackets << " ms"
+                << "  lost " << st.lostPackets << "/" << st.txPackets
+                << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
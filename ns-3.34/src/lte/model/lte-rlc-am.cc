@@ -41,6 +41,7 @@ LteRlcAm::LteRlcAm ()
 
   // Buffers
   m_txonBufferSize = 0;
+  m_enableTitrate = false;
   m_retxBuffer.resize (1024);
   m_retxBufferSize = 0;
   m_txedBuffer.resize (1024);
@@ -124,6 +125,12 @@ LteRlcAm::GetTypeId (void)
                    UintegerValue (10 * 1024),
                    MakeUintegerAccessor (&LteRlcAm::m_maxTxBufferSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EnableTitrate",
+                   "Admit SDUs against a Titrate threshold that adapts below MaxTxBufferSize.  "
+                   "Ignored if the buffer is unlimited.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LteRlcAm::m_enableTitrate),
+                   MakeBooleanChecker ())
     ;
   return tid;
 }
@@ -138,6 +145,11 @@ LteRlcAm::DoDispose ()
   m_rbsTimer.Cancel ();
 
   m_maxTxBufferSize = 0;
+  if (m_titrate)
+    {
+      m_titrate->Dispose ();
+      m_titrate = 0;
+    }
   m_txonBuffer.clear ();
   m_txonBufferSize = 0;
   m_txedBuffer.clear ();
@@ -162,7 +174,14 @@ LteRlcAm::DoTransmitPdcpPdu (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << m_rnti << (uint32_t) m_lcid << p->GetSize ());
 
-  if (m_txonBufferSize + p->GetSize () <= m_maxTxBufferSize || (m_maxTxBufferSize == 0))
+  if (m_enableTitrate && !m_titrate && m_maxTxBufferSize > 0)
+    {
+      m_titrate = CreateObject<TitrateBufferController> ();
+      m_titrate->SetMaxThreshold (m_maxTxBufferSize);
+    }
+
+  if (m_titrate ? m_titrate->CanEnqueue (m_txonBufferSize, p->GetSize ())
+                : m_txonBufferSize + p->GetSize () <= m_maxTxBufferSize || (m_maxTxBufferSize == 0))
     {
       /** Store PDCP PDU */
       LteRlcSduStatusTag tag;
@@ -174,6 +193,10 @@ LteRlcAm::DoTransmitPdcpPdu (Ptr<Packet> p)
       m_txonBufferSize += p->GetSize ();
       NS_LOG_LOGIC ("NumOfBuffers = " << m_txonBuffer.size() );
       NS_LOG_LOGIC ("txonBufferSize = " << m_txonBufferSize);
+      if (m_titrate)
+        {
+          m_titrate->NotifyEnqueue (m_txonBufferSize);
+        }
     }
   else
     {
@@ -182,6 +205,10 @@ LteRlcAm::DoTransmitPdcpPdu (Ptr<Packet> p)
       NS_LOG_LOGIC ("MaxTxBufferSize = " << m_maxTxBufferSize);
       NS_LOG_LOGIC ("txonBufferSize    = " << m_txonBufferSize);
       NS_LOG_LOGIC ("packet size     = " << p->GetSize ());
+      if (m_titrate)
+        {
+          m_titrate->NotifyDrop (m_txonBufferSize, p->GetSize ());
+        }
       m_txDropTrace (p);
     }
 
@@ -459,11 +486,12 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
   NS_LOG_LOGIC ("First SDU size    = " << m_txonBuffer.begin ()->m_pdu->GetSize ());
   NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
   NS_LOG_LOGIC ("Remove SDU from TxBuffer");
+  uint32_t txonBufferSizeBefore = m_txonBufferSize;
   Time firstSegmentTime = m_txonBuffer.begin ()->m_waitingSince;
   Ptr<Packet> firstSegment = m_txonBuffer.begin ()->m_pdu->Copy ();
   m_txonBufferSize -= m_txonBuffer.begin ()->m_pdu->GetSize ();
   NS_LOG_LOGIC ("txBufferSize      = " << m_txonBufferSize );
-  m_txonBuffer.erase (m_txonBuffer.begin ());
+  m_txonBuffer.pop_front ();
 
   while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
     {
@@ -511,7 +539,7 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
             {
               firstSegment->AddPacketTag (oldTag);
 
-              m_txonBuffer.insert (m_txonBuffer.begin (), TxPdu (firstSegment, firstSegmentTime));
+              m_txonBuffer.push_front (TxPdu (firstSegment, firstSegmentTime));
               m_txonBufferSize += m_txonBuffer.begin ()->m_pdu->GetSize ();
 
               NS_LOG_LOGIC ("    Txon buffer: Give back the remaining segment");
@@ -618,12 +646,17 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
           firstSegment = m_txonBuffer.begin ()->m_pdu->Copy ();
           firstSegmentTime = m_txonBuffer.begin ()->m_waitingSince;
           m_txonBufferSize -= m_txonBuffer.begin ()->m_pdu->GetSize ();
-          m_txonBuffer.erase (m_txonBuffer.begin ());
+          m_txonBuffer.pop_front ();
           NS_LOG_LOGIC ("        txBufferSize = " << m_txonBufferSize );
         }
 
     }
 
+  if (m_titrate && txonBufferSizeBefore > m_txonBufferSize)
+    {
+      m_titrate->NotifyDequeue (m_txonBufferSize, txonBufferSizeBefore - m_txonBufferSize);
+    }
+
   //
   // Build RLC header
   //
@@ -24,9 +24,11 @@
 #include <ns3/event-id.h>
 #include <ns3/lte-rlc-sequence-number.h>
 #include <ns3/lte-rlc.h>
+#include <ns3/titrate-buffer-controller.h>
 
 #include <vector>
 #include <map>
+#include <deque>
 
 namespace ns3 {
 
@@ -128,7 +130,7 @@ private:
     Time        m_waitingSince;  ///< Layer arrival time
   };
 
-  std::vector < TxPdu > m_txonBuffer; ///< Transmission buffer
+  std::deque < TxPdu > m_txonBuffer; ///< Transmission buffer
 
   /// RetxPdu structure
   struct RetxPdu
@@ -215,7 +217,9 @@ private:
   uint16_t m_pollPdu; ///< poll PDU
   uint16_t m_pollByte; ///< poll byte
   
-  bool m_txOpportunityForRetxAlwaysBigEnough; ///< transmit opportunity for retransmit? 
+  bool m_txOpportunityForRetxAlwaysBigEnough; ///< transmit opportunity for retransmit?
+  bool m_enableTitrate; ///< whether Titrate adapts the admission threshold below m_maxTxBufferSize
+  Ptr<TitrateBufferController> m_titrate; ///< Titrate threshold, created on the first PDCP PDU
   bool m_pollRetransmitTimerJustExpired; ///< poll retransmit timer just expired?
 
   /**
@@ -20,6 +20,7 @@
 
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 #include "ns3/lte-rlc-header.h"
 #include "ns3/lte-rlc-um.h"
@@ -35,6 +36,7 @@ NS_OBJECT_ENSURE_REGISTERED (LteRlcUm);
 LteRlcUm::LteRlcUm ()
   : m_maxTxBufferSize (10 * 1024),
     m_txBufferSize (0),
+    m_enableTitrate (false),
     m_sequenceNumber (0),
     m_vrUr (0),
     m_vrUx (0),
@@ -63,6 +65,11 @@ LteRlcUm::GetTypeId (void)
                    UintegerValue (10 * 1024),
                    MakeUintegerAccessor (&LteRlcUm::m_maxTxBufferSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EnableTitrate",
+                   "Admit SDUs against a Titrate threshold that adapts below MaxTxBufferSize",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LteRlcUm::m_enableTitrate),
+                   MakeBooleanChecker ())
     .AddAttribute ("ReorderingTimer",
                    "Value of the t-Reordering timer (See section 7.3 of 3GPP TS 36.322)",
                    TimeValue (MilliSeconds (100)),
@@ -78,6 +85,11 @@ LteRlcUm::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_reorderingTimer.Cancel ();
   m_rbsTimer.Cancel ();
+  if (m_titrate)
+    {
+      m_titrate->Dispose ();
+      m_titrate = 0;
+    }
 
   LteRlc::DoDispose ();
 }
@@ -91,7 +103,14 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << m_rnti << (uint32_t) m_lcid << p->GetSize ());
 
-  if (m_txBufferSize + p->GetSize () <= m_maxTxBufferSize)
+  if (m_enableTitrate && !m_titrate && m_maxTxBufferSize > 0)
+    {
+      m_titrate = CreateObject<TitrateBufferController> ();
+      m_titrate->SetMaxThreshold (m_maxTxBufferSize);
+    }
+
+  if (m_titrate ? m_titrate->CanEnqueue (m_txBufferSize, p->GetSize ())
+                : m_txBufferSize + p->GetSize () <= m_maxTxBufferSize)
     {
       /** Store PDCP PDU */
       LteRlcSduStatusTag tag;
@@ -103,6 +122,10 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
       m_txBufferSize += p->GetSize ();
       NS_LOG_LOGIC ("NumOfBuffers = " << m_txBuffer.size() );
       NS_LOG_LOGIC ("txBufferSize = " << m_txBufferSize);
+      if (m_titrate)
+        {
+          m_titrate->NotifyEnqueue (m_txBufferSize);
+        }
     }
   else
     {
@@ -111,6 +134,10 @@ LteRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
       NS_LOG_LOGIC ("MaxTxBufferSize = " << m_maxTxBufferSize);
       NS_LOG_LOGIC ("txBufferSize    = " << m_txBufferSize);
       NS_LOG_LOGIC ("packet size     = " << p->GetSize ());
+      if (m_titrate)
+        {
+          m_titrate->NotifyDrop (m_txBufferSize, p->GetSize ());
+        }
       m_txDropTrace (p);
     }
 
@@ -154,6 +181,7 @@ LteRlcUm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
       return;
     }
 
+  uint32_t txBufferSizeBefore = m_txBufferSize;
   Ptr<Packet> firstSegment = m_txBuffer.begin ()->m_pdu->Copy ();
   Time firstSegmentTime = m_txBuffer.begin ()->m_waitingSince;
 
@@ -164,7 +192,7 @@ LteRlcUm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
   NS_LOG_LOGIC ("Remove SDU from TxBuffer");
   m_txBufferSize -= firstSegment->GetSize ();
   NS_LOG_LOGIC ("txBufferSize      = " << m_txBufferSize );
-  m_txBuffer.erase (m_txBuffer.begin ());
+  m_txBuffer.pop_front ();
 
   while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
     {
@@ -212,7 +240,7 @@ LteRlcUm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
             {
               firstSegment->AddPacketTag (oldTag);
 
-              m_txBuffer.insert (m_txBuffer.begin (), TxPdu (firstSegment, firstSegmentTime));
+              m_txBuffer.push_front (TxPdu (firstSegment, firstSegmentTime));
               m_txBufferSize += m_txBuffer.begin()->m_pdu->GetSize ();
 
               NS_LOG_LOGIC ("    TX buffer: Give back the remaining segment");
@@ -318,12 +346,17 @@ LteRlcUm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
           firstSegment = m_txBuffer.begin ()->m_pdu->Copy ();
           firstSegmentTime = m_txBuffer.begin ()->m_waitingSince;
           m_txBufferSize -= firstSegment->GetSize ();
-          m_txBuffer.erase (m_txBuffer.begin ());
+          m_txBuffer.pop_front ();
           NS_LOG_LOGIC ("        txBufferSize = " << m_txBufferSize );
         }
 
     }
 
+  if (m_titrate && txBufferSizeBefore > m_txBufferSize)
+    {
+      m_titrate->NotifyDequeue (m_txBufferSize, txBufferSizeBefore - m_txBufferSize);
+    }
+
   // Build RLC header
   rlcHeader.SetSequenceNumber (m_sequenceNumber++);
 
@@ -25,7 +25,9 @@
 #include "ns3/lte-rlc.h"
 
 #include <ns3/event-id.h>
+#include <ns3/titrate-buffer-controller.h>
 #include <map>
+#include <deque>
 
 namespace ns3 {
 
@@ -97,6 +99,8 @@ private:
 private:
   uint32_t m_maxTxBufferSize; ///< maximum transmit buffer status
   uint32_t m_txBufferSize; ///< transmit buffer size
+  bool m_enableTitrate; ///< whether Titrate adapts the admission threshold below m_maxTxBufferSize
+  Ptr<TitrateBufferController> m_titrate; ///< Titrate threshold, created on the first PDCP PDU
   /**
    * \brief Store an incoming (from layer above us) PDU, waiting to transmit it
    */
@@ -118,7 +122,7 @@ private:
     Time        m_waitingSince;  ///< Layer arrival time
   };
 
-  std::vector < TxPdu > m_txBuffer; ///< Transmission buffer
+  std::deque < TxPdu > m_txBuffer; ///< Transmission buffer
   std::map <uint16_t, Ptr<Packet> > m_rxBuffer; ///< Reception buffer
   std::vector < Ptr<Packet> > m_reasBuffer;     ///< Reassembling buffer
 
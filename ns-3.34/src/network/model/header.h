@@ -113,6 +113,34 @@ public:
  */
 std::ostream & operator << (std::ostream &os, const Header &header);
 
+/**
+ * \ingroup packet
+ * \brief Opt a header type in the decoded-header cache of Packet.
+ *
+ * The primary template leaves T out of the cache. A specialization
+ * with \c cached set to true, declared next to T, selects the T
+ * overloads of Packet::AddHeader, Packet::RemoveHeader and
+ * Packet::PeekHeader, which keep a decoded copy of the header on the
+ * packet when Packet::EnableHeaderCache has been called. It must
+ * provide:
+ * \code
+ *   // Turn a header given to AddHeader into what Deserialize would
+ *   // make of its serialization.
+ *   static void Normalize (T &header);
+ *   // Set header to cached, as Deserialize into header would. Return
+ *   // false if it cannot, eg, if header has to check a checksum that
+ *   // cached did not.
+ *   static bool Load (T &header, const T &cached);
+ * \endcode
+ *
+ * \tparam T \explicit The header type.
+ */
+template <typename T>
+struct HeaderCacheTraits
+{
+  static const bool cached = false;  //!< Whether T is cached
+};
+
 } // namespace ns3
 
 #endif /* HEADER_H */
@@ -19,6 +19,7 @@
  */
 #include <utility>
 #include <list>
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -34,6 +35,9 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
+bool PacketMetadata::m_selective = false;
+uint16_t PacketMetadata::m_selectiveTypes[PACKET_METADATA_SELECTIVE_TYPES];
+uint8_t PacketMetadata::m_selectiveNTypes = 0;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
@@ -59,6 +63,9 @@ PacketMetadata::Enable (void)
                  "after sending any packets.  One way to fix this problem is "
                  "to call ns3::PacketMetadata::Enable () near the beginning of"
                  " the program, before any packets are sent.");
+  NS_ASSERT_MSG (!m_selective,
+                 "Error: the packet metadata subsystem cannot be fully enabled "
+                 "once selective packet metadata is in use.");
   m_enable = true;
 }
 
@@ -70,6 +77,28 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableSelective (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  NS_ASSERT_MSG (!m_enable,
+                 "Error: selective packet metadata cannot be combined with "
+                 "Packet::EnablePrinting or Packet::EnableChecking.");
+  NS_ASSERT_MSG (tid.IsChildOf (Header::GetTypeId ()),
+                 "Error: only headers can be recorded by selective packet metadata.");
+  for (uint8_t i = 0; i < m_selectiveNTypes; i++)
+    {
+      if (m_selectiveTypes[i] == tid.GetUid ())
+        {
+          return;
+        }
+    }
+  NS_ASSERT_MSG (m_selectiveNTypes < PACKET_METADATA_SELECTIVE_TYPES,
+                 "Error: too many header types registered for selective packet metadata.");
+  m_selectiveTypes[m_selectiveNTypes++] = tid.GetUid ();
+  m_selective = true;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -133,6 +162,11 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_data == 0)
+    {
+      // selective mode
+      return m_head == 0xffff && m_tail == 0xffff;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -665,6 +699,10 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
   NS_LOG_FUNCTION (this << uid << size);
   if (!m_enable)
     {
+      if (m_selective)
+        {
+          SelectiveAddAtStart (uid, size);
+        }
       m_metadataSkipped = true;
       return;
     }
@@ -687,6 +725,10 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
+      if (m_selective)
+        {
+          SelectiveRemoveAtStart (size);
+        }
       m_metadataSkipped = true;
       return;
     }
@@ -735,6 +777,7 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   NS_ASSERT (IsStateOk ());
   if (!m_enable)
     {
+      m_selectiveSize += size;
       m_metadataSkipped = true;
       return;
     }
@@ -757,6 +800,10 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
+      if (m_selective)
+        {
+          SelectiveRemoveAtEnd (size);
+        }
       m_metadataSkipped = true;
       return;
     }
@@ -804,6 +851,10 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
+      if (m_selective)
+        {
+          SelectiveAddAtEnd (o);
+        }
       m_metadataSkipped = true;
       return;
     }
@@ -881,6 +932,7 @@ PacketMetadata::AddPaddingAtEnd (uint32_t end)
   NS_LOG_FUNCTION (this << end);
   if (!m_enable)
     {
+      m_selectiveSize += end;
       m_metadataSkipped = true;
       return;
     }
@@ -892,6 +944,10 @@ PacketMetadata::RemoveAtStart (uint32_t start)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
+      if (m_selective)
+        {
+          SelectiveRemoveAtStart (start);
+        }
       m_metadataSkipped = true;
       return;
     }
@@ -955,6 +1011,10 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
+      if (m_selective)
+        {
+          SelectiveRemoveAtEnd (end);
+        }
       m_metadataSkipped = true;
       return;
     }
@@ -1013,6 +1073,105 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
   NS_ASSERT (leftToRemove == 0);
   NS_ASSERT (IsStateOk ());
 }
+void
+PacketMetadata::SelectiveAddAtStart (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
+  m_selectiveSize += size;
+  // shift the recorded headers, forgetting those which do not fit
+  // in 16 bits anymore
+  uint8_t kept = 0;
+  while (kept < m_selectiveCount)
+    {
+      uint32_t offset = m_selectiveItems[kept].offset + size;
+      if (offset + m_selectiveItems[kept].size > 0xffff)
+        {
+          break;
+        }
+      m_selectiveItems[kept].offset = offset;
+      kept++;
+    }
+  m_selectiveCount = kept;
+  uint16_t typeUid = uid >> 1;
+  if (typeUid == 0 || size > 0xffff)
+    {
+      return;
+    }
+  for (uint8_t t = 0; t < m_selectiveNTypes; t++)
+    {
+      if (m_selectiveTypes[t] != typeUid)
+        {
+          continue;
+        }
+      if (m_selectiveCount == PACKET_METADATA_SELECTIVE_ITEMS)
+        {
+          // forget the innermost header
+          m_selectiveCount--;
+        }
+      for (uint8_t i = m_selectiveCount; i > 0; i--)
+        {
+          m_selectiveItems[i] = m_selectiveItems[i - 1];
+        }
+      m_selectiveItems[0].typeUid = typeUid;
+      m_selectiveItems[0].offset = 0;
+      m_selectiveItems[0].size = size;
+      m_selectiveCount++;
+      return;
+    }
+}
+void
+PacketMetadata::SelectiveRemoveAtStart (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  size = std::min (size, m_selectiveSize);
+  m_selectiveSize -= size;
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < m_selectiveCount; i++)
+    {
+      if (m_selectiveItems[i].offset < size)
+        {
+          // removed, or partly removed
+          continue;
+        }
+      m_selectiveItems[kept] = m_selectiveItems[i];
+      m_selectiveItems[kept].offset -= size;
+      kept++;
+    }
+  m_selectiveCount = kept;
+}
+void
+PacketMetadata::SelectiveRemoveAtEnd (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_selectiveSize -= std::min (size, m_selectiveSize);
+  while (m_selectiveCount > 0)
+    {
+      const SelectiveItem &last = m_selectiveItems[m_selectiveCount - 1];
+      if (uint32_t (last.offset) + last.size <= m_selectiveSize)
+        {
+          break;
+        }
+      m_selectiveCount--;
+    }
+}
+void
+PacketMetadata::SelectiveAddAtEnd (PacketMetadata const &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  for (uint8_t i = 0; i < o.m_selectiveCount && m_selectiveCount < PACKET_METADATA_SELECTIVE_ITEMS; i++)
+    {
+      uint32_t offset = m_selectiveSize + o.m_selectiveItems[i].offset;
+      if (offset + o.m_selectiveItems[i].size > 0xffff)
+        {
+          break;
+        }
+      m_selectiveItems[m_selectiveCount] = o.m_selectiveItems[i];
+      m_selectiveItems[m_selectiveCount].offset = offset;
+      m_selectiveCount++;
+    }
+  m_selectiveSize += o.m_selectiveSize;
+}
+
 uint32_t
 PacketMetadata::GetTotalSize (void) const
 {
@@ -1053,14 +1212,34 @@ PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buff
     m_buffer (buffer),
     m_current (metadata->m_head),
     m_offset (0),
-    m_hasReadTail (false)
+    m_hasReadTail (false),
+    m_selectiveCount (0)
 {
   NS_LOG_FUNCTION (this << metadata << &buffer);
+  if (metadata->m_data == 0)
+    {
+      // selective mode: only report the headers which are still
+      // entirely within the buffer
+      m_current = 0;
+      while (m_selectiveCount < metadata->m_selectiveCount)
+        {
+          const SelectiveItem &item = metadata->m_selectiveItems[m_selectiveCount];
+          if (uint32_t (item.offset) + item.size > m_buffer.GetSize ())
+            {
+              break;
+            }
+          m_selectiveCount++;
+        }
+    }
 }
 bool
 PacketMetadata::ItemIterator::HasNext (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_metadata->m_data == 0)
+    {
+      return m_current < m_selectiveCount || m_offset < m_buffer.GetSize ();
+    }
   if (m_current == 0xffff)
     {
       return false;
@@ -1076,6 +1255,33 @@ PacketMetadata::ItemIterator::Next (void)
 {
   NS_LOG_FUNCTION (this);
   struct PacketMetadata::Item item;
+  if (m_metadata->m_data == 0)
+    {
+      // selective mode: the recorded headers, and payload in between
+      item.isFragment = false;
+      item.currentTrimedFromStart = 0;
+      item.currentTrimedFromEnd = 0;
+      uint32_t nextOffset = m_buffer.GetSize ();
+      if (m_current < m_selectiveCount)
+        {
+          nextOffset = m_metadata->m_selectiveItems[m_current].offset;
+        }
+      if (m_offset < nextOffset)
+        {
+          item.type = PacketMetadata::Item::PAYLOAD;
+          item.currentSize = nextOffset - m_offset;
+          m_offset = nextOffset;
+          return item;
+        }
+      const SelectiveItem &selectiveItem = m_metadata->m_selectiveItems[m_current++];
+      item.type = PacketMetadata::Item::HEADER;
+      item.tid.SetUid (selectiveItem.typeUid);
+      item.currentSize = selectiveItem.size;
+      item.current = m_buffer.Begin ();
+      item.current.Next (m_offset);
+      m_offset += selectiveItem.size;
+      return item;
+    }
   struct PacketMetadata::SmallItem smallItem;
   struct PacketMetadata::ExtraItem extraItem;
   m_metadata->ReadItems (m_current, &smallItem, &extraItem);
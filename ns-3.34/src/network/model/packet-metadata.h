@@ -74,6 +74,14 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * In selective mode (see EnableSelective), none of the above is used:
+ * the linked list and its shared data buffer are never allocated.
+ * Instead, each packet records the offset and size of up to
+ * PACKET_METADATA_SELECTIVE_ITEMS headers of the registered types in
+ * a small array stored inline in the PacketMetadata object. The
+ * ItemIterator reports these headers, and reports the bytes between
+ * and after them as payload.
  */
 class PacketMetadata 
 {
@@ -150,6 +158,7 @@ private:
     uint16_t m_current; //!< current position
     uint32_t m_offset; //!< offset
     bool m_hasReadTail; //!< true if the metadata tail has been read
+    uint8_t m_selectiveCount; //!< number of selective items within the buffer
   };
 
   /**
@@ -160,6 +169,18 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable selective packet metadata and register a header type
+   *
+   * Only headers of the registered types are recorded, at most
+   * PACKET_METADATA_SELECTIVE_ITEMS per packet, closest to the start of
+   * the packet first. Can be called once per type, up to
+   * PACKET_METADATA_SELECTIVE_TYPES types. Selective mode cannot be
+   * combined with Enable.
+   *
+   * \param tid the TypeId of a Header to record
+   */
+  static void EnableSelective (TypeId tid);
 
   /**
    * \brief Constructor
@@ -407,6 +428,10 @@ private:
    * of PacketMetadata::Data is 16 bytes
    */ 
 #define PACKET_METADATA_DATA_M_DATA_SIZE 8
+  /// maximum number of headers recorded per packet in selective mode
+#define PACKET_METADATA_SELECTIVE_ITEMS 4
+  /// maximum number of header types registered for selective mode
+#define PACKET_METADATA_SELECTIVE_TYPES 8
   
   /**
    * Data structure
@@ -503,6 +528,15 @@ public:
     ~DataFreeList ();
   };
 
+  /**
+   * \brief A header recorded in selective mode.
+   */
+  struct SelectiveItem {
+    uint16_t typeUid; //!< TypeId uid of the header
+    uint16_t offset;  //!< offset of the header from the start of the packet
+    uint16_t size;    //!< size of the header
+  };
+
   friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
@@ -620,6 +654,27 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Record size bytes added at the start, in selective mode.
+   * \param uid the TypeId uid of the header (shifted left by one), or 0
+   * \param size the number of bytes added
+   */
+  void SelectiveAddAtStart (uint32_t uid, uint32_t size);
+  /**
+   * \brief Drop size bytes from the start, in selective mode.
+   * \param size the number of bytes removed
+   */
+  void SelectiveRemoveAtStart (uint32_t size);
+  /**
+   * \brief Drop size bytes from the end, in selective mode.
+   * \param size the number of bytes removed
+   */
+  void SelectiveRemoveAtEnd (uint32_t size);
+  /**
+   * \brief Copy the items of another packet appended to this one, in selective mode.
+   * \param o the metadata of the appended packet
+   */
+  void SelectiveAddAtEnd (PacketMetadata const &o);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -664,6 +719,9 @@ public:
   static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_selective; //!< Record only the registered header types
+  static uint16_t m_selectiveTypes[PACKET_METADATA_SELECTIVE_TYPES]; //!< registered TypeId uids
+  static uint8_t m_selectiveNTypes; //!< number of registered TypeId uids
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -685,6 +743,9 @@ public:
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
   uint64_t m_packetUid; //!< packet Uid
+  uint32_t m_selectiveSize; //!< packet size, tracked in selective mode only
+  uint8_t m_selectiveCount; //!< number of valid entries in m_selectiveItems
+  SelectiveItem m_selectiveItems[PACKET_METADATA_SELECTIVE_ITEMS]; //!< recorded headers, by increasing offset
 };
 
 } // namespace ns3
@@ -692,12 +753,19 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (m_selective ? 0 : PacketMetadata::Create (10)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
-    m_packetUid (uid)
+    m_packetUid (uid),
+    m_selectiveSize (size),
+    m_selectiveCount (0)
 {
+  if (m_data == 0)
+    {
+      // selective mode does not use the shared data buffer
+      return;
+    }
   memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
@@ -709,9 +777,18 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
-    m_packetUid (o.m_packetUid)
+    m_packetUid (o.m_packetUid),
+    m_selectiveSize (o.m_selectiveSize),
+    m_selectiveCount (o.m_selectiveCount)
 {
-  NS_ASSERT (m_data != 0);
+  for (uint8_t i = 0; i < m_selectiveCount; i++)
+    {
+      m_selectiveItems[i] = o.m_selectiveItems[i];
+    }
+  if (m_data == 0)
+    {
+      return;
+    }
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
   m_data->m_count++;
 }
@@ -721,25 +798,38 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
   m_packetUid = o.m_packetUid;
+  m_selectiveSize = o.m_selectiveSize;
+  m_selectiveCount = o.m_selectiveCount;
+  for (uint8_t i = 0; i < m_selectiveCount; i++)
+    {
+      m_selectiveItems[i] = o.m_selectiveItems[i];
+    }
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
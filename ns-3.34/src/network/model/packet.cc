@@ -29,6 +29,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
 uint32_t Packet::m_globalUid = 0;
+bool Packet::m_enableHeaderCache = false;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -146,7 +147,8 @@ Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_headerCache (o.m_headerCache)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
@@ -165,6 +167,7 @@ Packet::operator = (const Packet &o)
   m_metadata = o.m_metadata;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
+  m_headerCache = o.m_headerCache;
   return *this;
 }
 
@@ -274,6 +277,7 @@ Packet::RemoveHeader (Header &header, uint32_t size)
   m_buffer.RemoveAtStart (deserialized);
   m_byteTagList.Adjust (-deserialized);
   m_metadata.RemoveHeader (header, deserialized);
+  TrimHeaderCache (GetSize ());
   return deserialized;
 }
 uint32_t
@@ -284,6 +288,7 @@ Packet::RemoveHeader (Header &header)
   m_buffer.RemoveAtStart (deserialized);
   m_byteTagList.Adjust (-deserialized);
   m_metadata.RemoveHeader (header, deserialized);
+  TrimHeaderCache (GetSize ());
   return deserialized;
 }
 uint32_t
@@ -303,6 +308,82 @@ Packet::PeekHeader (Header &header, uint32_t size) const
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
 }
+
+Packet::CachedHeader::CachedHeader (TypeId tid)
+  : tid (tid)
+{
+}
+
+Packet::CachedHeader::~CachedHeader ()
+{
+}
+
+void
+Packet::CacheHeader (Ptr<const CachedHeader> header) const
+{
+  uint32_t end = GetSize ();
+  // replace a header at the same place, else a free slot, else the
+  // innermost header
+  HeaderCacheSlot *slot = &m_headerCache[0];
+  for (HeaderCacheSlot &s : m_headerCache)
+    {
+      if (s.header == 0 || s.end == end)
+        {
+          slot = &s;
+          break;
+        }
+      if (s.end < slot->end)
+        {
+          slot = &s;
+        }
+    }
+  slot->header = header;
+  slot->end = end;
+}
+
+const Packet::CachedHeader *
+Packet::FindCachedHeader (TypeId tid) const
+{
+  if (!m_enableHeaderCache)
+    {
+      return 0;
+    }
+  uint32_t end = GetSize ();
+  for (const HeaderCacheSlot &s : m_headerCache)
+    {
+      if (s.header != 0 && s.end == end && s.header->tid == tid)
+        {
+          return PeekPointer (s.header);
+        }
+    }
+  return 0;
+}
+
+void
+Packet::TrimHeaderCache (uint32_t end)
+{
+  // trim even when the cache is disabled, the headers kept before must
+  // not be read if it is enabled again
+  for (HeaderCacheSlot &s : m_headerCache)
+    {
+      if (s.end > end)
+        {
+          s.header = 0;
+          s.end = 0;
+        }
+    }
+}
+
+void
+Packet::RemoveDecodedHeader (const Header &header, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  m_buffer.RemoveAtStart (size);
+  m_byteTagList.Adjust (-size);
+  m_metadata.RemoveHeader (header, size);
+  TrimHeaderCache (GetSize ());
+}
+
 void
 Packet::AddTrailer (const Trailer &trailer)
 {
@@ -313,6 +394,7 @@ Packet::AddTrailer (const Trailer &trailer)
   Buffer::Iterator end = m_buffer.End ();
   trailer.Serialize (end);
   m_metadata.AddTrailer (trailer, size);
+  TrimHeaderCache (0);
 }
 uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
@@ -321,6 +403,7 @@ Packet::RemoveTrailer (Trailer &trailer)
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
   m_metadata.RemoveTrailer (trailer, deserialized);
+  TrimHeaderCache (0);
   return deserialized;
 }
 uint32_t
@@ -342,6 +425,7 @@ Packet::AddAtEnd (Ptr<const Packet> packet)
   m_byteTagList.Add (copy);
   m_buffer.AddAtEnd (packet->m_buffer);
   m_metadata.AddAtEnd (packet->m_metadata);
+  TrimHeaderCache (0);
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
@@ -350,6 +434,7 @@ Packet::AddPaddingAtEnd (uint32_t size)
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
   m_metadata.AddPaddingAtEnd (size);
+  TrimHeaderCache (0);
 }
 void 
 Packet::RemoveAtEnd (uint32_t size)
@@ -357,6 +442,19 @@ Packet::RemoveAtEnd (uint32_t size)
   NS_LOG_FUNCTION (this << size);
   m_buffer.RemoveAtEnd (size);
   m_metadata.RemoveAtEnd (size);
+  TrimHeaderCache (0);
+}
+uint32_t
+Packet::TruncatePayload (uint32_t headerSize)
+{
+  NS_LOG_FUNCTION (this << headerSize);
+  uint32_t size = GetSize ();
+  if (size <= headerSize)
+    {
+      return 0;
+    }
+  RemoveAtEnd (size - headerSize);
+  return size - headerSize;
 }
 void 
 Packet::RemoveAtStart (uint32_t size)
@@ -365,6 +463,7 @@ Packet::RemoveAtStart (uint32_t size)
   m_buffer.RemoveAtStart (size);
   m_byteTagList.Adjust (-size);
   m_metadata.RemoveAtStart (size);
+  TrimHeaderCache (GetSize ());
 }
 
 void 
@@ -582,6 +681,27 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableSelectivePrinting (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  PacketMetadata::EnableSelective (tid);
+}
+
+void
+Packet::EnableHeaderCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enableHeaderCache = true;
+}
+
+void
+Packet::DisableHeaderCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enableHeaderCache = false;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -21,6 +21,8 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <array>
+#include <type_traits>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -356,6 +358,45 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header, uint32_t size) const;
+  /**
+   * \brief Add a header of a cached type to this packet.
+   *
+   * As AddHeader (const Header &), and keeps a decoded copy of the
+   * header if the header cache is enabled.
+   *
+   * \tparam T \deduced The header type, see HeaderCacheTraits.
+   * \param header a reference to the header to add to this packet.
+   */
+  template <typename T>
+  typename std::enable_if<HeaderCacheTraits<T>::cached>::type
+  AddHeader (const T &header);
+  /**
+   * \brief Remove a header of a cached type from the internal buffer.
+   *
+   * As RemoveHeader (Header &), but a decoded copy of the header kept
+   * on the packet is used rather than deserializing it again.
+   *
+   * \tparam T \deduced The header type, see HeaderCacheTraits.
+   * \param header a reference to the header to remove from the internal buffer.
+   * \returns the number of bytes removed from the packet.
+   */
+  template <typename T>
+  typename std::enable_if<HeaderCacheTraits<T>::cached, uint32_t>::type
+  RemoveHeader (T &header);
+  /**
+   * \brief Read a header of a cached type from the internal buffer.
+   *
+   * As PeekHeader (Header &), but a decoded copy of the header kept on
+   * the packet is used rather than deserializing it again. Otherwise
+   * the decoded header is kept for the next reader.
+   *
+   * \tparam T \deduced The header type, see HeaderCacheTraits.
+   * \param header a reference to the header to read from the internal buffer.
+   * \returns the number of bytes read from the packet.
+   */
+  template <typename T>
+  typename std::enable_if<HeaderCacheTraits<T>::cached, uint32_t>::type
+  PeekHeader (T &header) const;
   /**
    * \brief Add trailer to this packet.
    *
@@ -419,6 +460,21 @@ public:
    * \param size number of bytes from remove
    */
   void RemoveAtStart (uint32_t size);
+  /**
+   * \brief Drop the payload behind the first headerSize bytes of the packet.
+   *
+   * The headers in front of the payload, the metadata describing them
+   * and all packet tags are kept as they are. Byte tags are not moved;
+   * they are clipped to the new end of the packet. Nothing is copied: like
+   * RemoveAtEnd, this only moves the end of the underlying buffer, so
+   * it is cheap enough to call for every packet, eg, to trim packets
+   * NDP-style in a queue disc.
+   *
+   * \param headerSize number of bytes to keep at the start of the packet
+   * \returns the number of payload bytes removed (0 if the packet is not
+   *          larger than headerSize)
+   */
+  uint32_t TruncatePayload (uint32_t headerSize);
 
   /**
    * \brief Copy the packet contents to a byte buffer.
@@ -500,12 +556,12 @@ public:
    * stored in this buffer.
    *
    * Note that this iterator will point
-   * to an empty array of items if you don't call EnablePrinting
-   * or EnableChecking before.
+   * to an empty array of items if you don't call EnablePrinting,
+   * EnableChecking or EnableSelectivePrinting before.
    *
    * \returns an iterator
    *
-   * \sa EnablePrinting EnableChecking
+   * \sa EnablePrinting EnableChecking EnableSelectivePrinting
    */
   PacketMetadata::ItemIterator BeginItem (void) const;
 
@@ -530,6 +586,40 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Record the metadata of headers of the given type only.
+   *
+   * A cheaper alternative to EnablePrinting when only a few header types
+   * need to be found through BeginItem, eg, the TcpHeader of a packet in
+   * a queue disc. Each packet records up to a handful of such headers in
+   * a fixed-size array and allocates no metadata buffer. Other headers
+   * and trailers are reported as payload. Call it once per header type,
+   * before any packet is created; it cannot be combined with
+   * EnablePrinting or EnableChecking.
+   *
+   * \param tid the TypeId of the header to record
+   */
+  static void EnableSelectivePrinting (TypeId tid);
+  /**
+   * \brief Keep decoded headers on packets.
+   *
+   * Headers of the types opted in by HeaderCacheTraits are then kept
+   * decoded on the packet when they are added or first read, and
+   * later reads of the same header, eg, in the next node, copy the
+   * decoded header instead of deserializing it. A kept header is
+   * dropped when it is removed, and all of them are dropped when the
+   * end of the packet changes. Call it once, before any packet is
+   * created.
+   */
+  static void EnableHeaderCache (void);
+  /**
+   * \brief Stop reading kept headers, eg, at the end of a test that
+   * called EnableHeaderCache.
+   *
+   * Headers kept by existing packets are no longer read, and all
+   * headers are deserialized again.
+   */
+  static void DisableHeaderCache (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -779,6 +869,61 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /** A decoded header kept on the packet. */
+  class CachedHeader : public SimpleRefCount<CachedHeader>
+  {
+  public:
+    /** \param tid the type of the header */
+    CachedHeader (TypeId tid);
+    virtual ~CachedHeader ();
+    TypeId tid;  //!< The type of the header
+  };
+
+  /**
+   * A decoded header of type T.
+   * \tparam T \explicit The header type.
+   */
+  template <typename T>
+  class CachedHeaderOf : public CachedHeader
+  {
+  public:
+    /** \param h the decoded header */
+    CachedHeaderOf (const T &h);
+    T header;  //!< The decoded header
+  };
+
+  /** A slot of the header cache. */
+  struct HeaderCacheSlot
+  {
+    /** Create an empty slot */
+    HeaderCacheSlot () : end (0) {}
+    Ptr<const CachedHeader> header;  //!< The decoded header, or 0
+    uint32_t end;                    //!< Bytes from the start of the header to the end of the packet
+  };
+
+  /**
+   * \brief Keep a decoded header of the front of the packet.
+   * \param header the decoded header
+   */
+  void CacheHeader (Ptr<const CachedHeader> header) const;
+  /**
+   * \param tid the type of the header
+   * \returns the decoded header of the front of the packet, or 0
+   */
+  const CachedHeader * FindCachedHeader (TypeId tid) const;
+  /**
+   * \brief Drop the decoded headers that start beyond \p end bytes
+   * from the end of the packet.
+   * \param end bytes from the end of the packet, 0 to drop all of them
+   */
+  void TrimHeaderCache (uint32_t end);
+  /**
+   * \brief Remove a header whose decoded copy has been read.
+   * \param header the header
+   * \param size the serialized size of the header
+   */
+  void RemoveDecodedHeader (const Header &header, uint32_t size);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -787,7 +932,11 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+  /** The decoded headers, see EnableHeaderCache */
+  mutable std::array<HeaderCacheSlot, 2> m_headerCache;
+
   static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static bool m_enableHeaderCache; //!< Enable the header cache
 };
 
 /**
@@ -831,6 +980,7 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  *   - ns3::Packet::CreateFragment
  *   - ns3::Packet::RemoveAtStart
  *   - ns3::Packet::RemoveAtEnd
+ *   - ns3::Packet::TruncatePayload
  *   - ns3::Packet::CopyData
  *
  * Dirty operations will always be slower than non-dirty operations,
@@ -854,6 +1004,59 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+template <typename T>
+Packet::CachedHeaderOf<T>::CachedHeaderOf (const T &h)
+  : CachedHeader (T::GetTypeId ()),
+    header (h)
+{
+}
+
+template <typename T>
+typename std::enable_if<HeaderCacheTraits<T>::cached>::type
+Packet::AddHeader (const T &header)
+{
+  AddHeader (static_cast<const Header &> (header));
+  if (m_enableHeaderCache)
+    {
+      Ptr<CachedHeaderOf<T> > cached = Create<CachedHeaderOf<T> > (header);
+      HeaderCacheTraits<T>::Normalize (cached->header);
+      CacheHeader (cached);
+    }
+}
+
+template <typename T>
+typename std::enable_if<HeaderCacheTraits<T>::cached, uint32_t>::type
+Packet::RemoveHeader (T &header)
+{
+  const CachedHeader *cached = FindCachedHeader (T::GetTypeId ());
+  if (cached != 0
+      && HeaderCacheTraits<T>::Load (header, static_cast<const CachedHeaderOf<T> *> (cached)->header))
+    {
+      uint32_t size = header.GetSerializedSize ();
+      RemoveDecodedHeader (header, size);
+      return size;
+    }
+  return RemoveHeader (static_cast<Header &> (header));
+}
+
+template <typename T>
+typename std::enable_if<HeaderCacheTraits<T>::cached, uint32_t>::type
+Packet::PeekHeader (T &header) const
+{
+  const CachedHeader *cached = FindCachedHeader (T::GetTypeId ());
+  if (cached != 0
+      && HeaderCacheTraits<T>::Load (header, static_cast<const CachedHeaderOf<T> *> (cached)->header))
+    {
+      return header.GetSerializedSize ();
+    }
+  uint32_t deserialized = PeekHeader (static_cast<Header &> (header));
+  if (m_enableHeaderCache)
+    {
+      CacheHeader (Create<CachedHeaderOf<T> > (header));
+    }
+  return deserialized;
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
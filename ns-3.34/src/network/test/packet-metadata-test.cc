@@ -330,6 +330,12 @@ public:
    */
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
+protected:
+  /**
+   * Constructor
+   * \param name The test case name
+   */
+  PacketMetadataTest (std::string name);
 private:
   /**
    * Adds an header to the packet
@@ -344,6 +350,11 @@ PacketMetadataTest::PacketMetadataTest ()
 {
 }
 
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
+{
+}
+
 PacketMetadataTest::~PacketMetadataTest ()
 {
 }
@@ -903,6 +914,111 @@ PacketMetadataTest::DoRun (void)
 }
 
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Selective packet metadata unit tests.
+ *
+ * Selective mode cannot be combined with PacketMetadata::Enable, so
+ * these tests live in their own test suite.
+ */
+class PacketMetadataSelectiveTest : public PacketMetadataTest {
+public:
+  PacketMetadataSelectiveTest ();
+  virtual void DoRun (void);
+};
+
+PacketMetadataSelectiveTest::PacketMetadataSelectiveTest ()
+  : PacketMetadataTest ("Selective packet metadata")
+{
+}
+
+void
+PacketMetadataSelectiveTest::DoRun (void)
+{
+  PacketMetadata::EnableSelective (HistoryHeader<2>::GetTypeId ());
+  PacketMetadata::EnableSelective (HistoryHeader<5>::GetTypeId ());
+
+  // unregistered headers are reported as payload
+  Ptr<Packet> p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  CheckHistory (p, __FILE__, __LINE__, 3,
+                3, 2, 11);
+  ADD_HEADER (p, 5);
+  CheckHistory (p, __FILE__, __LINE__, 4,
+                5, 3, 2, 11);
+  REM_HEADER (p, 5);
+  REM_HEADER (p, 3);
+  CheckHistory (p, __FILE__, __LINE__, 2,
+                2, 11);
+  p->RemoveAtEnd (11);
+  CheckHistory (p, __FILE__, __LINE__, 1,
+                2);
+  p->RemoveAtEnd (1);
+  CheckHistory (p, __FILE__, __LINE__, 1,
+                1);
+
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 2);
+  Ptr<Packet> p1 = p->CreateFragment (0, 2);
+  Ptr<Packet> p2 = p->CreateFragment (1, 11);
+  CheckHistory (p1, __FILE__, __LINE__, 1,
+                2);
+  CheckHistory (p2, __FILE__, __LINE__, 1,
+                11);
+  p2->AddAtEnd (p1);
+  ADD_TRAILER (p2, 100);
+  CheckHistory (p2, __FILE__, __LINE__, 3,
+                11, 2, 100);
+  p2->RemoveAtStart (11);
+  CheckHistory (p2, __FILE__, __LINE__, 2,
+                2, 100);
+
+  // only the outermost PACKET_METADATA_SELECTIVE_ITEMS headers are kept,
+  // the innermost one becomes payload
+  p = Create<Packet> (10);
+  for (uint32_t i = 0; i < PACKET_METADATA_SELECTIVE_ITEMS; i++)
+    {
+      ADD_HEADER (p, 2);
+    }
+  ADD_HEADER (p, 5);
+  uint32_t headers = 0;
+  PacketMetadata::ItemIterator k = p->BeginItem ();
+  while (k.HasNext ())
+    {
+      if (k.Next ().type == PacketMetadata::Item::HEADER)
+        {
+          headers++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (headers, PACKET_METADATA_SELECTIVE_ITEMS, "wrong number of recorded headers");
+  CheckHistory (p, __FILE__, __LINE__, 5,
+                5, 2, 2, 2, 12);
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Selective Packet Metadata TestSuite
+ */
+class PacketMetadataSelectiveTestSuite : public TestSuite
+{
+public:
+  PacketMetadataSelectiveTestSuite ();
+};
+
+PacketMetadataSelectiveTestSuite::PacketMetadataSelectiveTestSuite ()
+  : TestSuite ("packet-metadata-selective", UNIT)
+{
+  AddTestCase (new PacketMetadataSelectiveTest, TestCase::QUICK);
+}
+
+static PacketMetadataSelectiveTestSuite g_packetMetadataSelectiveTest; //!< Static variable for test initialization
+
 /**
  * \ingroup network-test
  * \ingroup tests
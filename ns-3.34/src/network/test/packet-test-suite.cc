@@ -854,6 +854,24 @@ PacketTest::DoRun (void)
     CHECK (tmp, 1, E (25, 0, 50));
   }
 
+  /* Test TruncatePayload keeps headers and tags. */
+  {
+    Ptr<Packet> tmp = Create<Packet> (1000);
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddByteTag (ATestTag<25> ());
+    tmp->AddPacketTag (ATestTag<11> (66));
+    NS_TEST_EXPECT_MSG_EQ (tmp->TruncatePayload (10), 1000, "payload not removed");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 10, "wrong size after truncation");
+    CHECK (tmp, 1, E (25, 0, 10));
+    ATestTag<11> t;
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (t), true, "packet tag lost");
+    NS_TEST_EXPECT_MSG_EQ (t.GetData (), 66, "packet tag changed");
+    ATestHeader<10> h;
+    NS_TEST_EXPECT_MSG_EQ (tmp->RemoveHeader (h), 10, "header lost");
+    NS_TEST_EXPECT_MSG_EQ (h.m_error, false, "header corrupted");
+    NS_TEST_EXPECT_MSG_EQ (tmp->TruncatePayload (10), 0, "nothing to truncate");
+  }
+
   /* Test ALargeTestTag */
   {
     Ptr<Packet> tmp = Create<Packet> (0);
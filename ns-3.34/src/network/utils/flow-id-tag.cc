@@ -72,14 +72,17 @@ FlowIdTag::Print (std::ostream &os) const
   os << "FlowId=" << m_flowId;
 }
 FlowIdTag::FlowIdTag ()
-  : Tag () 
+  : Tag (),
+    m_flowId (0),
+    m_trim (0)
 {
   NS_LOG_FUNCTION (this);
 }
 
 FlowIdTag::FlowIdTag (uint32_t id)
   : Tag (),
-    m_flowId (id)
+    m_flowId (id),
+    m_trim (0)
 {
   NS_LOG_FUNCTION (this << id);
 }
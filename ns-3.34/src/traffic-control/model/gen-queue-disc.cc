@@ -28,6 +28,7 @@
 #include "ns3/object-factory.h"
 #include "ns3/socket.h"
 #include "gen-queue-disc.h"
+#include "titrate-buffer-controller.h"
 #include <algorithm>
 #include <iterator>
 #include <deque>
@@ -45,6 +46,7 @@
 #include "ns3/unsched-tag.h"
 #include "ns3/homa-header.h"
 #include "ns3/int-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
 
 # define DT 101
 # define FAB 102
@@ -126,7 +128,7 @@ TypeId GenQueueDisc::GetTypeId (void)
                     MakeDoubleAccessor (&GenQueueDisc::RTTms),
                     MakeDoubleChecker<double> ())
 
-    .AddAttribute ("updateInterval","NANOSECONDS update interval for dequeue rate and N in ActiveBufferManagement", UintegerValue(30000),
+    .AddAttribute ("updateInterval","NANOSECONDS window of the dequeue rate in ActiveBufferManagement", UintegerValue(30000),
                   MakeUintegerAccessor(&GenQueueDisc::updateInterval),
                   MakeUintegerChecker<uint64_t>())
     .AddAttribute ("staticBuffer","static buffer",
@@ -141,6 +143,29 @@ TypeId GenQueueDisc::GetTypeId (void)
                               UintegerValue (0),
                               MakeUintegerAccessor (&GenQueueDisc::strict_priority),
                               MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EnableHistograms","record per-class sojourn time (ns) and queue occupancy at enqueue (bytes) histograms",
+                              BooleanValue (false),
+                              MakeBooleanAccessor (&GenQueueDisc::enableHistograms),
+                              MakeBooleanChecker())
+    .AddAttribute ("UseEcn","(MY) CE-mark ECN-capable packets above currMaxSizeAllowed instead of dropping them",
+                              BooleanValue (false),
+                              MakeBooleanAccessor (&GenQueueDisc::useEcn),
+                              MakeBooleanChecker())
+    .AddAttribute ("EcnHardDropRatio","(MY, UseEcn) packets are still dropped once the queue would exceed this multiple of currMaxSizeAllowed",
+                              DoubleValue (2),
+                              MakeDoubleAccessor (&GenQueueDisc::ecnHardDropRatio),
+                              MakeDoubleChecker<double> (1))
+    .AddAttribute ("EcnMarkRatio","(MY, UseEcn) ECN-capable packets are also marked once the queue would exceed this fraction of currMaxSizeAllowed, without opening a monitoring window",
+                              DoubleValue (0.5),
+                              MakeDoubleAccessor (&GenQueueDisc::ecnMarkRatio),
+                              MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("TrimOnDrop","NDP-style trimming: a packet the buffer management rejects is cut to its headers, which go to queue 0 if they fit in the buffer",
+                              BooleanValue (false),
+                              MakeBooleanAccessor (&GenQueueDisc::trimOnDrop),
+                              MakeBooleanChecker())
+    .AddTraceSource ("Trim","a packet was trimmed to its headers by TrimPacket",
+                     MakeTraceSourceAccessor (&GenQueueDisc::m_trimTrace),
+                     "ns3::GenQueueDisc::TrimTracedCallback")
   ;
   return tid;
 }
@@ -158,11 +183,12 @@ GenQueueDisc::GenQueueDisc ()
     lastAcceptedQueue[i]=ns3::Simulator::Now();
     numBytesSentQueue[i]=0;
     droppedBytes[i]=0;
+    markedBytes[i]=0;
     DeqRate[i]=1;
     Deq[i]=0;
+    DeqWindowStart[i]=0;
     MFair[i]=1000*1000*4;
     QRefAfd[i]=1000*15;
-    nofP[i] = 0;
     DPPQueue = 1;
   }
 }
@@ -195,6 +221,13 @@ GenQueueDisc::GetDroppedBytes(uint32_t p){
   return droppedB;
 }
 
+uint64_t
+GenQueueDisc::GetMarkedBytes(uint32_t p){
+  uint64_t markedB = markedBytes[p];
+  markedBytes[p]=0;
+  return markedB;
+}
+
 double GenQueueDisc::GetAlpha(uint32_t p){
   return alphas[p];
 }
@@ -253,48 +286,25 @@ bool GenQueueDisc::DynamicThresholds(uint32_t priority, Ptr<Packet> packet){
 
 }
 
-void
-GenQueueDisc::UpdateDequeueRate(double nanodelay){ // delay in NANOSECONDS. Pay attention here.
-  double num=0;
-  /* This is because of round-robin scheduling. More to be added soon. In general, its better to measure dequeue rate like PIE */
-  // for (uint32_t p=0;p<nPrior;p++){
-  //   if (GetQueueDiscClass (p)->GetQueueDisc ()->GetNBytes()>sat){
-  //     num++;
-  //   }
-  // }
-
-  // if (num==0)
-  //   num=1;
-
-  // for (uint32_t p=0;p<nPrior;p++){
-  //   if (GetQueueDiscClass (p)->GetQueueDisc ()->GetNBytes()>sat){
-  //     DeqRate[p] = double(1.0/num);
-  //   }
-  //   else{
-  //     DeqRate[p]=1;
-  //   }
-  // }
-  for (uint32_t p=0;p<nPrior;p++){
-    double th = 8*Deq[p]/nanodelay/portBW; // portBW should be in Gbps
-    if (th < 1.0/double(nPrior) || th > 1){
-      th = 1;
-    }
-    DeqRate[p] = th;
-    Deq[p] = 0;
-  }
-}
-
-void GenQueueDisc::UpdateNofP(){
-  for (uint32_t i=0; i< nPrior; i++){
-    nofP[i] = sharedMemory->GetNofP(i);
+// AnnC: the windows of the dequeue rate are rolled over when a queue dequeues or ABM reads its rate,
+// instead of by a periodic event on every port
+void GenQueueDisc::rollDequeueWindow(uint32_t p){
+  int64_t now = Simulator::Now().GetNanoSeconds();
+  if (firstTimeUpdate || now < DeqWindowStart[p] + (int64_t)updateInterval) return;
+  int64_t windows = (now - DeqWindowStart[p]) / updateInterval;
+  // nothing was dequeued in the last full window if more than one has passed
+  double th = windows == 1 ? 8*Deq[p]/updateInterval/portBW : 0; // portBW should be in Gbps
+  if (th < 1.0/double(nPrior) || th > 1){
+    th = 1;
   }
+  DeqRate[p] = th;
+  Deq[p] = 0;
+  DeqWindowStart[p] += windows*updateInterval;
 }
 
-
-void GenQueueDisc::InvokeUpdates(double nanodelay){
-  UpdateDequeueRate(nanodelay);
-  UpdateNofP();
-  Simulator::Schedule(NanoSeconds(nanodelay),&GenQueueDisc::InvokeUpdates,this,nanodelay);
+void GenQueueDisc::addDequeuedBytes(uint32_t p, double bytes){
+  rollDequeueWindow(p);
+  Deq[p] += bytes;
 }
 
 bool GenQueueDisc::ActiveBufferManagement(uint32_t priority, Ptr<Packet> packet){
@@ -329,13 +339,17 @@ bool GenQueueDisc::ActiveBufferManagement(uint32_t priority, Ptr<Packet> packet)
   sharedMemory->setSaturated(portId,priority,satLevel);
 
   if (firstTimeUpdate){
+    // the first window holds everything dequeued so far
     firstTimeUpdate=false;
-    InvokeUpdates(updateInterval);
+    for (uint32_t p=0; p<nPrior; p++){
+      DeqWindowStart[p] = Simulator::Now().GetNanoSeconds() - updateInterval;
+    }
   }
+  rollDequeueWindow(priority);
 
   double remaining = sharedMemory->GetRemainingBuffer();
-  // std::cout << "alpha " << alpha << " n " << nofP[priority] << " deq " << DeqRate[priority] << std::endl;
-  uint64_t maxSize = double(alpha*(remaining)/nofP[priority])*DeqRate[priority];
+  // std::cout << "alpha " << alpha << " n " << sharedMemory->GetNofP(priority) << " deq " << DeqRate[priority] << std::endl;
+  uint64_t maxSize = double(alpha*(remaining)/sharedMemory->GetNofP(priority))*DeqRate[priority];
 
   if (maxSize> UINT32_MAX)
     maxSize = UINT32_MAX-1500;
@@ -548,28 +562,49 @@ bool GenQueueDisc::AcceptPacket(uint32_t priority, Ptr<Packet> packet){
   return accept;
 }
 
-void
+uint32_t
+GenQueueDisc::GetHeadersSize(Ptr<const Packet> packet){
+  // AnnC: the headers in front of the payload, found through the packet metadata
+  uint32_t headerSize = 0;
+  PacketMetadata::ItemIterator mdit = packet->BeginItem();
+  while (mdit.HasNext()) {
+    PacketMetadata::Item mdItem = mdit.Next();
+    if (mdItem.type != PacketMetadata::Item::HEADER) break;
+    headerSize += mdItem.currentSize;
+  }
+  if (headerSize == 0) { // metadata disabled
+    TcpHeader th; HomaHeader hh;
+    headerSize = is_homa ? packet->PeekHeader(hh) : packet->PeekHeader(th);
+  }
+  return headerSize;
+}
+
+uint32_t
 GenQueueDisc::TrimPacket(Ptr<Packet> packetCopy){
-  TcpHeader th; Ipv4Header ih; PppHeader ph; IntHeader inth; HomaHeader hh; FlowIdTag ft; MyPriorityTag mt;
-  uint32_t trimsize = 0;
-  uint32_t thremoved = packetCopy->RemoveHeader(th);
-  uint32_t ihremoved = packetCopy->RemoveHeader(ih);
-  uint32_t phremoved = packetCopy->RemoveHeader(ph);
-  uint32_t hhremoved = packetCopy->RemoveHeader(hh);
-  bool intremoved = packetCopy->RemovePacketTag(inth);
-  bool ftremoved = packetCopy->RemovePacketTag(ft);
-  bool mtremoved = packetCopy->RemovePacketTag(mt);
-  packetCopy->RemoveAtEnd(packetCopy->GetSize());
-  ft.SetTrim(1);
-  if(intremoved){packetCopy->AddPacketTag(inth);}
-  if(ftremoved){packetCopy->AddPacketTag(ft);}
-  if(mtremoved){packetCopy->AddPacketTag(mt);}
-  if(thremoved){packetCopy->AddHeader(th);}
-  if(hhremoved){packetCopy->AddHeader(hh);}
-  if(ihremoved){packetCopy->AddHeader(ih);}
-  if(phremoved){packetCopy->AddHeader(ph);}
-
-  std::cout << packetCopy->GetSize() << std::endl;
+  // AnnC: keep the headers and all tags, and drop the payload in place; no header or tag is removed and re-added.
+  uint32_t trimmedBytes = packetCopy->TruncatePayload(GetHeadersSize(packetCopy));
+
+  FlowIdTag ft;
+  if (packetCopy->PeekPacketTag(ft)) {
+    ft.SetTrim(1);
+    packetCopy->ReplacePacketTag(ft);
+  }
+  m_trimTrace(packetCopy, trimmedBytes);
+  return trimmedBytes;
+}
+
+bool
+GenQueueDisc::EnqueueTrimmed(Ptr<QueueDiscItem> item){
+  // AnnC: the caller already took the trimmed size from the shared buffer
+  TrimBeforeEnqueue(item, TrimPacket(item->GetPacket()));
+  sharedMemory->PerPriorityStatEnq(item->GetSize(),0);
+  if (GetQueueDiscClass (0)->GetQueueDisc ()->Enqueue (item)) {
+    return true;
+  }
+  // the child queue disc recorded the drop
+  sharedMemory->DequeueBuffer(item->GetSize());
+  sharedMemory->PerPriorityStatDeq(item->GetSize(),0);
+  return false;
 }
 
 bool
@@ -599,6 +634,10 @@ GenQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   if (uint32_t(p)>=nPrior)
     p = uint32_t(nPrior-1);
 
+  if (mainRoomQueueScheme==FQ || mainRoomQueueScheme==CCA || mainRoomQueueScheme==RTT) {
+    p = classifyMRQueue(item, p);
+  }
+
   // bool foundFid;
   // uint32_t flowId = 0;
   // FlowIdTag tag;
@@ -712,6 +751,29 @@ GenQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
   /*Check if the packet can be put in the shared buffer*/
   bool enqueue = AcceptPacket(p,packet);
+  // AnnC: only mark a packet the shared buffer is going to take (same test as EnqueueBuffer below),
+  // otherwise it is counted as marked and as dropped, and opens the monitoring window twice
+  bool admitted = enqueue && sharedMemory->GetRemainingBuffer() > item->GetSize();
+  if (admitted && shouldEarlyMark) {
+    // AnnC: below currMaxSizeAllowed the mark only tells the sender to slow down, it is not a
+    // drop for the control loop
+    if (Mark(item, THRESHOLD_EXCEEDED_MARK)) {
+      markedBytes[p]+=item->GetSize();
+    }
+  }
+  shouldEarlyMark = false;
+  if (admitted && shouldMark) {
+    // AnnC: MyBM asked for a mark instead of a drop. A mark is a congestion signal just like a drop,
+    // so it opens the same monitoring window and is counted in probeMinTotalDropBytes.
+    if (Mark(item, THRESHOLD_EXCEEDED_MARK)) {
+      markedBytes[p]+=item->GetSize();
+      startWindowAfterDrop(p);
+      sharedMemory->probeMinTotalDropBytes[proberId] += item->GetSize();
+    } else {
+      enqueue = false; // not ECN-capable, fall back to dropping
+    }
+  }
+  shouldMark = false;
   if (!enqueue) {
 
       NS_LOG_LOGIC ("Queue disc limit exceeded -- dropping packet");
@@ -734,14 +796,21 @@ GenQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
         // if (debug) sharedMemory->debugTotalDropBytes[proberId] += item->GetSize();
       }
 
-      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      // AnnC: with TrimOnDrop the payload is still counted as dropped above, but the headers go on to
+      // queue 0 (with the control packets) so that the receiver learns about the loss right away
+      bool trim = false;
+      if (trimOnDrop) {
+        uint32_t trimmedSize = item->GetSize() - packet->GetSize() + GetHeadersSize(packet);
+        trim = trimmedSize < item->GetSize() && sharedMemory->EnqueueBuffer(trimmedSize);
+      }
+      if (!trim) DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
       if (isMyBM) {
         // sharedMemory->setQSize(proberId, GetQueueDiscClass (p)->GetQueueDisc ()->GetNBytes());
         uint32_t currBuffer = GetQueueDiscClass (p)->GetQueueDisc ()->GetNBytes();
         if (currBuffer < sharedMemory->probeMinMinBufferUsed[proberId]) sharedMemory->probeMinMinBufferUsed[proberId] = currBuffer;
         if (currBuffer > sharedMemory->probeMinMaxBufferUsed[proberId]) sharedMemory->probeMinMaxBufferUsed[proberId] = currBuffer;
       }
-      return false;
+      return trim && EnqueueTrimmed(item);
   }
 
   if (isMyBM) {
@@ -825,6 +894,9 @@ GenQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   }
   else{
     sharedMemory->PerPriorityStatEnq(item->GetSize(),p);
+    if (enableHistograms) {
+      GetOccupancyHistogram(p).Record(GetQueueDiscClass (p)->GetQueueDisc ()->GetNBytes());
+    }
     retval = GetQueueDiscClass (p)->GetQueueDisc ()->Enqueue (item);
     // AnnC: AQM could drop packets here
     // if (!retval) std::cout << "AQM drop" << std::endl;
@@ -895,6 +967,37 @@ GenQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   return retval;
 }
 
+LogLinearHistogram&
+GenQueueDisc::GetSojournHistogram(uint32_t p){
+  if (sojournHist.size() <= p) sojournHist.resize(p+1);
+  return sojournHist[p];
+}
+
+LogLinearHistogram&
+GenQueueDisc::GetOccupancyHistogram(uint32_t p){
+  if (occupancyHist.size() <= p) occupancyHist.resize(p+1);
+  return occupancyHist[p];
+}
+
+void
+GenQueueDisc::ResetHistograms(){
+  for (uint32_t p=0; p<sojournHist.size(); p++) sojournHist[p].Reset();
+  for (uint32_t p=0; p<occupancyHist.size(); p++) occupancyHist[p].Reset();
+}
+
+void
+GenQueueDisc::PrintHistograms(std::ostream &os){
+  // one row per class: port queue metric count mean p50 p99 p99.9 max
+  for (uint32_t p=0; p<nPrior; p++) {
+    os << portId << " " << p << " sojournNs ";
+    GetSojournHistogram(p).PrintSummary(os);
+    os << std::endl;
+    os << portId << " " << p << " occupancyBytes ";
+    GetOccupancyHistogram(p).PrintSummary(os);
+    os << std::endl;
+  }
+}
+
 // std::pair<double,double>
 std::vector<double>
 GenQueueDisc::GetThroughputQueue(uint32_t p, double nanodelay){
@@ -934,6 +1037,10 @@ GenQueueDisc::DoDequeue (void)
 
             uint32_t p = dequeueIndex;
 
+            if (enableHistograms) {
+              GetSojournHistogram(p).Record((Simulator::Now() - item->GetTimeStamp()).GetNanoSeconds());
+            }
+
             uint8_t countIsDroppedByCodel = item->GetIsDroppedByCodel();
             uint8_t countIsDequeuedByCodel = item->GetIsDequeuedByCodel();
             if (countIsDroppedByCodel>0) {
@@ -954,7 +1061,7 @@ GenQueueDisc::DoDequeue (void)
               numBytesSentQueue[107]+=item->GetSize();
             }
 
-            Deq[p]+=item->GetSize();
+            addDequeuedBytes(p, item->GetSize());
 
             uint32_t proberId = sharedMemory->getProberId(portId, p);
             if (isMyBM) {
@@ -1061,12 +1168,14 @@ GenQueueDisc::DoDequeue (void)
                 //   }
                 // }
               } else {
-                std::cout << "dodequeue flowId not found: p=" << p << std::endl;
+                // untagged packets, e.g. ICMP errors, are expected in p=0
+                NS_LOG_LOGIC ("dodequeue flowId not found: p=" << p);
               }
             }
+            if (!mrQueueFlows.empty()) releaseMRQueueIfIdle(p);
             return item;
           }
-        Deq[dequeueIndex]+=1472;
+        addDequeuedBytes(dequeueIndex, 1472);
 
         // probeMinAverageThroughput[dequeueIndex] += 1472;
 
@@ -1086,6 +1195,10 @@ GenQueueDisc::DoDequeue (void)
 
             uint32_t p = i;
 
+            if (enableHistograms) {
+              GetSojournHistogram(p).Record((Simulator::Now() - item->GetTimeStamp()).GetNanoSeconds());
+            }
+
             uint8_t countIsDroppedByCodel = item->GetIsDroppedByCodel();
             uint8_t countIsDequeuedByCodel = item->GetIsDequeuedByCodel();
             if (countIsDroppedByCodel) {
@@ -1106,7 +1219,7 @@ GenQueueDisc::DoDequeue (void)
               numBytesSentQueue[107]+=item->GetSize();
             }
 
-            Deq[p]+=item->GetSize();
+            addDequeuedBytes(p, item->GetSize());
 
             uint32_t proberId = sharedMemory->getProberId(portId, p);
             if (isMyBM) {
@@ -1163,12 +1276,13 @@ GenQueueDisc::DoDequeue (void)
                 //   }
                 // }
               } else {
-                std::cout << "dodequeue flowId not found" << std::endl;
+                NS_LOG_LOGIC ("dodequeue flowId not found: p=" << p);
               }
             }
+            if (!mrQueueFlows.empty()) releaseMRQueueIfIdle(p);
             return item;
           }
-        Deq[i]+=1472;
+        addDequeuedBytes(i, 1472);
 
         // probeMinAverageThroughput[i] += 1472;
       }
@@ -1246,11 +1360,12 @@ bool GenQueueDisc::isNewFlow(uint32_t flowId) {
   return true;
 }
 
-bool GenQueueDisc::isNewProber(uint32_t proberId) {
-	if (proberStarted.find(proberId) != proberStarted.end()) {
+bool GenQueueDisc::isNewProber(uint32_t queueid) {
+  // AnnC: the prober of a queue is fixed by the port, so the queue id stands for it
+  if (proberStarted[queueid]) {
     return false;
   }
-  proberStarted.insert(proberId);
+  proberStarted[queueid] = true;
   return true;
 }
 
@@ -1264,7 +1379,8 @@ bool GenQueueDisc::MyBM(uint32_t priority, Ptr<Packet> packet, uint32_t bmType){
   PacketMetadata::Item item;
   while (mdit.HasNext()) {
     item = mdit.Next();
-    if (item.tid.GetName() == "ns3::TcpHeader") {
+    // payload and padding items carry no TypeId (UDP packets have no TcpHeader to stop at)
+    if (item.type == PacketMetadata::Item::HEADER && item.tid.GetName() == "ns3::TcpHeader") {
       NS_ASSERT (item.tid.HasConstructor ());
       Callback<ObjectBase *> constructor = item.tid.GetConstructor ();
       NS_ASSERT (!constructor.IsNull ());
@@ -1327,12 +1443,10 @@ bool GenQueueDisc::MyBM(uint32_t priority, Ptr<Packet> packet, uint32_t bmType){
   //   setUpHeadRoomNonProber(priority, flowId, bmType);
   // }
   // if (isNewProber(proberId)) startProbing(proberId, flowId, bmType);
-  uint32_t proberid = sharedMemory->getProberId(portId, priority);
-  if (isNewProber(proberId)) sharedMemory->allocateBufferSpaceSimple(proberid, startProbeBuffer);
+  if (isNewProber(priority)) sharedMemory->allocateBufferSpaceSimple(proberId, startProbeBuffer);
 
   uint32_t maxSize = sharedMemory->getCurrMaxSizeAllowed(proberId);
   uint32_t instantaneousQSize = GetQueueDiscClass (priority)->GetQueueDisc ()->GetNBytes();
-  uint32_t averageQSize = static_cast<uint32_t>(std::round(smoothGetAverageQlen(priority)));
   // AnnC: I want to make sure there is at least one more packet space for this packet to get in
   // Can be a dirty fix. But hopefully is ok.
   // I want to make sure that maxSize is at least 1 packet size more than qSize
@@ -1397,31 +1511,21 @@ bool GenQueueDisc::MyBM(uint32_t priority, Ptr<Packet> packet, uint32_t bmType){
   // std::cout << "***Debug: " << Simulator::Now() << ", proberid=" << proberId << ", iqSize=" << instantaneousQSize << ", aqSize=" << averageQSize << ", recordLen=" << smoothQlenRecord[priority].size() << ", maxSize=" << maxSize << ", remainingBuffer=" << sharedMemory->GetRemainingBuffer() << ", packetSize=" << packet->GetSize() << std::endl;
 
   // if ( ((qSize + packet->GetSize()) >  maxSize) || (remainingBuffer < packet->GetSize())  ){
-  bool shouldDrop = false;
-  if (pawMode.compare("paw")==0) {
-    shouldDrop = remainingBuffer<packet->GetSize() || ((instantaneousQSize+packet->GetSize())>maxSize && averageQSize>maxSize);
-  } else if (pawMode.compare("pa")==0) {
-    shouldDrop = remainingBuffer<packet->GetSize() || ((instantaneousQSize+packet->GetSize())>maxSize && averageQSize>maxSize);
-  } else if (pawMode.compare("aw")==0) {
-    shouldDrop = remainingBuffer<packet->GetSize() || ((instantaneousQSize+packet->GetSize())>maxSize && averageQSize>maxSize);
-  } else if (pawMode.compare("fixed")==0) {
-    shouldDrop = remainingBuffer<packet->GetSize() || (instantaneousQSize+packet->GetSize())>maxSize;
-  } else if (pawMode.compare("fixed_vary")==0) {
-    for (const auto& entry : fixedVaryThresVec) {
-      int64_t now = Simulator::Now().GetMicroSeconds();
-      if (now > entry.first*1e6) {
-        maxSize = entry.second*1e3;
-      } else {
-        break;
-      }
-    }
-    shouldDrop = remainingBuffer<packet->GetSize() || (instantaneousQSize+packet->GetSize())>maxSize;
-  } else if (pawMode.compare("p")==0) {
-    shouldDrop = remainingBuffer<packet->GetSize() || (instantaneousQSize+packet->GetSize())>maxSize;
-  }
+  bool shouldDrop = (this->*myBMShouldDrop)(priority, packet->GetSize(), instantaneousQSize, maxSize, remainingBuffer);
 
   // std::cout << "test," << shouldDrop << "," << maxSize << "," << instantaneousQSize << "," << averageQSize << "," << remainingBuffer << std::endl;
 
+  if (useEcn && remainingBuffer >= (int32_t)packet->GetSize()) {
+    uint32_t qSizeAfter = instantaneousQSize+packet->GetSize();
+    if (shouldDrop && qSizeAfter <= ecnHardDropRatio*maxSize) {
+      shouldMark = true; // DoEnqueue marks the packet, or drops it if it is not ECN-capable
+      return true;
+    }
+    if (!shouldDrop && qSizeAfter > ecnMarkRatio*maxSize) {
+      shouldEarlyMark = true; // DoEnqueue marks the packet if it is ECN-capable
+    }
+  }
+
   if (shouldDrop) {
     // std::cout << "***Debug: drop" << std::endl;
     // std::cout << Simulator::Now() << ": drop, proberid=" << proberId << ", flowid=" << flowId << ", maxSize=" << maxSize << ", qSize=" << qSize << ", remainingBuffer=" << remainingBuffer << " -- DEBUG***********" << std::endl;
@@ -4179,6 +4283,40 @@ void GenQueueDisc::setProbingStats(uint32_t _startProbeBuffer, uint16_t _monitor
   smoothWindowByNumData = _smoothWindowByNumData;
   smoothOutlierThresholdByMultiple = _smoothOutlierThresholdByMultiple;
   pawMode = _pawMode;
+
+  smoothWeightedAverage = !(pawMode=="pa" || pawMode=="fixed" || pawMode=="p");
+  if (pawMode=="paw" || pawMode=="pa" || pawMode=="aw") {
+    myBMShouldDrop = &GenQueueDisc::myBMDropAboveAverage;
+  } else if (pawMode=="fixed" || pawMode=="p") {
+    myBMShouldDrop = &GenQueueDisc::myBMDropAboveInstantaneous;
+  } else if (pawMode=="fixed_vary") {
+    myBMShouldDrop = &GenQueueDisc::myBMDropAboveFixedVary;
+  } else {
+    myBMShouldDrop = &GenQueueDisc::myBMNeverDrop;
+  }
+}
+
+// AnnC: paw, pa and aw only drop when the smoothed queue length is above the threshold too
+bool GenQueueDisc::myBMDropAboveAverage(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer) {
+  if (remainingBuffer<packetSize) return true;
+  if ((instantaneousQSize+packetSize)<=maxSize) return false;
+  uint32_t averageQSize = static_cast<uint32_t>(std::round(smoothGetAverageQlen(priority)));
+  return averageQSize>maxSize;
+}
+
+bool GenQueueDisc::myBMDropAboveInstantaneous(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer) {
+  return remainingBuffer<packetSize || (instantaneousQSize+packetSize)>maxSize;
+}
+
+// AnnC: the fixed_vary thresholds replace currMaxSizeAllowed once the first one is applied
+bool GenQueueDisc::myBMDropAboveFixedVary(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer) {
+  if (fixedVaryMaxSize>0) maxSize = fixedVaryMaxSize;
+  return remainingBuffer<packetSize || (instantaneousQSize+packetSize)>maxSize;
+}
+
+// AnnC: an unknown pawMode never drops, as before
+bool GenQueueDisc::myBMNeverDrop(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer) {
+  return false;
 }
 
 void GenQueueDisc::setUpTrackingStats(uint32_t numqueues) {
@@ -4193,6 +4331,15 @@ void GenQueueDisc::setUpTrackingStats(uint32_t numqueues) {
     std::deque<uint32_t> record;
     smoothQlenRecord.push_back(record);
     isWindowOn.push_back(false);
+    proberStarted.push_back(false);
+  }
+  if (mainRoomQueueScheme==FQ || mainRoomQueueScheme==CCA || mainRoomQueueScheme==RTT) {
+    mrQueueActiveFlows.assign(numqueues, 0);
+    mrQueueFlows.assign(numqueues, std::vector<uint32_t>());
+    mrQueueClasses.assign(numqueues, std::vector<uint32_t>());
+    for (uint32_t q=numqueues-1; q>=1; q--) {
+      freeMRQueues.push_back(q); // queue 0 stays with the control packets
+    }
   }
   // nextAvailableHRqueueid = mainRoomNumQueues+1;
   smoothStartMonitoring(numqueues);
@@ -4216,7 +4363,10 @@ double GenQueueDisc::smoothGetAverageQlen(uint32_t p) {
     sum += smoothQlenRecord[p][i];
   }
   double average = sum/(double)smoothQlenRecord[p].size();
-  uint64_t mysum = sum;
+  // AnnC: pa, fixed and p use the plain average; the other modes leave out the samples above it
+  if (!smoothWeightedAverage) {
+    return average;
+  }
   sum = 0;
   uint32_t count = 0;
   for (uint32_t i=0; i<smoothQlenRecord[p].size(); i++) {
@@ -4229,19 +4379,6 @@ double GenQueueDisc::smoothGetAverageQlen(uint32_t p) {
     }
   }
   double weighted_average = sum/(double)count;
-  // int64_t micronow = Simulator::Now().GetMicroSeconds();
-  // if (65000000 < micronow && micronow < 75000000) std::cout << "SMOOTH," << micronow << "," << p << "," << average << "," << weighted_average << "," << smoothQlenRecord[p].size() << "," << mysum << std::endl;
-  if (pawMode.compare("paw")==0) {
-    return weighted_average;
-  } else if (pawMode.compare("pa")==0) {
-    return average;
-  } else if (pawMode.compare("aw")==0) {
-    return weighted_average;
-  } else if (pawMode.compare("fixed")==0) {
-    return average;
-  } else if (pawMode.compare("p")==0) {
-    return average;
-  }
   return weighted_average;
 }
 
@@ -4275,8 +4412,105 @@ void GenQueueDisc::setParameters(
   MinQHold = ParMinQHold;
 }
 
+// AnnC: a threshold of value KB from key seconds on. MyBM used to scan the list per packet for
+// the last entry with now > key, in whole microseconds; it now takes effect 1us after key seconds.
 void GenQueueDisc::insertIntoFixedVaryThresVec(uint32_t key, uint32_t value) {
-  fixedVaryThresVec.emplace_back(key,value);
+  if (pawMode!="fixed_vary") return; // set by setProbingStats, which is called first
+  Time at = MicroSeconds((int64_t)key*1000000 + 1);
+  Simulator::Schedule(at > Simulator::Now() ? at - Simulator::Now() : Time(0), &GenQueueDisc::applyFixedVaryThres, this, (uint32_t)(value*1e3));
+}
+
+void GenQueueDisc::applyFixedVaryThres(uint32_t maxSize) {
+  fixedVaryMaxSize = maxSize;
+}
+
+// AnnC: FQ gives every flow its own main-room queue; CCA and RTT give one queue to each class the
+// sender put in the priority tag (its CCA, or its RTT bucket). Queues 1..nPrior-1 are the pool of
+// the port. When the pool runs out, new flows share a queue in use, picked by flowid. A queue goes
+// back to the pool once every flow on it has sent a FIN and it is empty; its prober is set up again
+// by MyBM when the next flow arrives.
+uint32_t GenQueueDisc::classifyMRQueue(Ptr<QueueDiscItem> item, uint32_t p) {
+  FlowIdTag tag;
+  if (mrQueueFlows.empty() || !item->GetPacket()->PeekPacketTag(tag)) return p;
+  uint32_t flowid = tag.GetFlowId();
+
+  uint32_t queueid = p;
+  auto it = flowidMRqueueidMapping.find(flowid);
+  if (it != flowidMRqueueidMapping.end()) {
+    if (p>0) queueid = it->second.first;
+  } else if (p>0) {
+    if (sharedMemory->isFlowEnded(flowid)) {
+      // a straggler of a flow that already ended at this switch, it does not get a queue of its own
+      return sharedMRQueue(flowid);
+    }
+    if (mainRoomQueueScheme==FQ) {
+      queueid = allocateMRQueue(flowid);
+    } else {
+      auto cit = ccaHRqueueidMapping.find(p);
+      if (cit != ccaHRqueueidMapping.end()) {
+        queueid = cit->second;
+      } else {
+        queueid = allocateMRQueue(flowid);
+        ccaHRqueueidMapping[p] = queueid;
+        mrQueueClasses[queueid].push_back(p);
+      }
+    }
+    it = flowidMRqueueidMapping.emplace(flowid, std::make_pair(queueid, false)).first;
+    mrQueueFlows[queueid].push_back(flowid);
+    mrQueueActiveFlows[queueid]++;
+  }
+
+  if (it != flowidMRqueueidMapping.end() && !it->second.second) {
+    Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem>(item);
+    TcpHeader tcpHeader;
+    if (ipv4Item && ipv4Item->GetHeader().GetProtocol()==6
+        && item->GetPacket()->PeekHeader(tcpHeader) && (tcpHeader.GetFlags() & TcpHeader::FIN)) {
+      sharedMemory->addToFlowIdEnded(flowid);
+      it->second.second = true;
+      uint32_t flowQueueid = it->second.first;
+      mrQueueActiveFlows[flowQueueid]--;
+      // a FIN going to the flow's queue frees it when dequeued
+      if (flowQueueid != queueid) releaseMRQueueIfIdle(flowQueueid);
+    }
+  }
+  return queueid;
+}
+
+uint32_t GenQueueDisc::allocateMRQueue(uint32_t flowid) {
+  if (freeMRQueues.empty()) {
+    return sharedMRQueue(flowid);
+  }
+  uint32_t queueid = freeMRQueues.back();
+  freeMRQueues.pop_back();
+  return queueid;
+}
+
+// AnnC: a queue from the pool would carry packets that no flow of mrQueueFlows accounts for, and the
+// next flow it is handed to would share it; only queues in use are shared, queue 0 when there is none
+uint32_t GenQueueDisc::sharedMRQueue(uint32_t flowid) {
+  std::vector<uint32_t> used;
+  for (uint32_t q=1; q<mrQueueFlows.size(); q++) {
+    if (!mrQueueFlows[q].empty()) used.push_back(q);
+  }
+  if (used.empty()) return 0;
+  return used[flowid % used.size()];
+}
+
+void GenQueueDisc::releaseMRQueueIfIdle(uint32_t queueid) {
+  if (queueid==0 || mrQueueActiveFlows[queueid]>0 || mrQueueFlows[queueid].empty()
+      || GetQueueDiscClass (queueid)->GetQueueDisc ()->GetNPackets()>0) {
+    return;
+  }
+  if (verbose) std::cout << Simulator::Now() << ": release queue, portid=" << portId << ", queueid=" << queueid << std::endl;
+  for (uint32_t flowid : mrQueueFlows[queueid]) flowidMRqueueidMapping.erase(flowid);
+  for (uint32_t c : mrQueueClasses[queueid]) ccaHRqueueidMapping.erase(c);
+  mrQueueFlows[queueid].clear();
+  mrQueueClasses[queueid].clear();
+  // hand the buffer back, the next flow starts probing from startProbeBuffer
+  uint32_t proberid = sharedMemory->getProberId(portId, queueid);
+  sharedMemory->allocateBufferSpaceSimple(proberid, -(int32_t)sharedMemory->getCurrMaxSizeAllowed(proberid));
+  proberStarted[queueid] = false;
+  freeMRQueues.push_back(queueid);
 }
 
 void GenQueueDisc::startWindowAfterDrop(uint32_t queueid) {
@@ -4331,33 +4565,18 @@ void GenQueueDisc::endWindowAfterDrop(uint32_t queueid, uint32_t window, uint8_t
 
   double MTU = 1500;
   uint8_t SAFE_THRES = 2;
-  uint8_t SSTHRESH_MULTIPLIER = ExploreThres;
-  uint8_t DEC_RATIO = DecreaseRatio;
-  double INC_RATIO = IncreaseRatio/10.0;
   uint8_t COUNT_THRES = 2;
   if (design_mar2625_v2) {
-    if (zeroqueueduration > 0) {
-      ssthreshBuffer = cmsa * SSTHRESH_MULTIPLIER;
-      if (is_log) std::cout << Simulator::Now() << ",thres+=" << (uint32_t)(((double)INC_RATIO*window*1000000/(window*1000000-zeroqueueduration))*cmsa-cmsa) << ",ssthreshBuffer=" << ssthreshBuffer << std::endl;
-      sharedMemory->allocateBufferSpaceSimple(proberid,(uint32_t)(((double)INC_RATIO*window*1000000/(window*1000000-zeroqueueduration))*cmsa-cmsa));
-    } else {
-      if (minbuffer > SAFE_THRES*MTU) {
-        if (count < COUNT_THRES) {
-          if (is_log) std::cout << Simulator::Now() << ",one more monitoring interval" << std::endl;
-          Simulator::Schedule(MilliSeconds(window), &GenQueueDisc::endWindowAfterDrop, this, queueid, window, count+1);
-          return;
-        } else {
-          if (cmsa > ssthreshBuffer) {
-            uint32_t thres_change = (uint32_t)(cmsa-(cmsa+ssthreshBuffer)/2.0);
-            thres_change = (uint32_t)((thres_change-1)/(double)MTU + 1)*MTU;
-            if (is_log) std::cout << Simulator::Now() << ",thres-=" << thres_change << ",ssthreshBuffer=" << ssthreshBuffer << std::endl;
-            if (cmsa-thres_change > SAFE_THRES*MTU) sharedMemory->allocateBufferSpaceSimple(proberid,-thres_change);
-          } else {
-            if (is_log) std::cout << Simulator::Now() << ",thres-=" << DEC_RATIO*MTU*count << ",ssthreshBuffer=" << ssthreshBuffer << std::endl;
-            if (cmsa-MTU*count > SAFE_THRES*MTU) sharedMemory->allocateBufferSpaceSimple(proberid,-DEC_RATIO*MTU*count);
-          }
-        }
-      }
+    TitrateBufferController::Step step = TitrateBufferController::WindowStep(cmsa, ssthreshBuffer, zeroqueueduration, minbuffer, window, count, ExploreThres, IncreaseRatio, DecreaseRatio);
+    if (step.extend) {
+      if (is_log) std::cout << Simulator::Now() << ",one more monitoring interval" << std::endl;
+      Simulator::Schedule(MilliSeconds(window), &GenQueueDisc::endWindowAfterDrop, this, queueid, window, count+1);
+      return;
+    }
+    ssthreshBuffer = step.ssthresh;
+    if (step.resize) {
+      if (is_log) std::cout << Simulator::Now() << ",thres+=" << step.change << ",ssthreshBuffer=" << ssthreshBuffer << std::endl;
+      sharedMemory->allocateBufferSpaceSimple(proberid,(int32_t)step.change);
     }
   }
 
@@ -32,6 +32,7 @@
 #include "unordered_map"
 #include "ns3/simulator.h"
 #include "shared-memory.h"
+#include "log-linear-histogram.h"
 // #include "utility-warehouse.h"
 
 namespace ns3 {
@@ -70,6 +71,7 @@ public:
 
   // Reasons for dropping packets
   static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+  static constexpr const char* THRESHOLD_EXCEEDED_MARK = "currMaxSizeAllowed exceeded";  //!< Packet marked above the Titrate threshold (UseEcn)
 
 
   void setStrictPriority() {
@@ -92,6 +94,7 @@ public:
   uint64_t GetBuffersize(uint32_t p);
 
   uint64_t GetDroppedBytes(uint32_t p);
+  uint64_t GetMarkedBytes(uint32_t p);
   double GetAlpha(uint32_t p);
   double GetRemainingBuffer();
 
@@ -108,21 +111,31 @@ public:
 
   void setUpTrackingStats(uint32_t numqueues);
 
-  void setPortBw(double bw){portBW = bw;}
+  void setPortBw(double bw){portBW = bw; registerPortBw();}
+  double getPortBw(){return portBW;}
+
+  // AnnC: per-class histograms, only recorded when EnableHistograms is set.
+  // Copy the returned histogram for a snapshot; Merge() to aggregate across ports.
+  LogLinearHistogram& GetSojournHistogram(uint32_t p);
+  LogLinearHistogram& GetOccupancyHistogram(uint32_t p);
+  void ResetHistograms();
+  void PrintHistograms(std::ostream &os);
+
   // AnnC: [WrongRTTns] temporarily set RTTns as an attribute of the port
   void setRTT(double rtt) { RTTms = rtt; }
 
   // void setTargetBw(uint32_t bw) {targetBW = bw;}
   void setTargetBw(uint32_t bw) {ssthreshBuffer = bw;}
 
-  void SetSharedMemory(Ptr<SharedMemoryBuffer> sm){sharedMemory=sm;}
+  void SetSharedMemory(Ptr<SharedMemoryBuffer> sm){sharedMemory=sm; registerPortBw();}
+  Ptr<SharedMemoryBuffer> GetSharedMemory(){return sharedMemory;}
   // void setUtilityWarehouse(Ptr<UtilityWarehouse> warehouse) {utilityWarehouse=warehouse;}
 
   void SetBufferAlgorithm(uint32_t alg){
     bufferalg=alg;
   }
 
-  void SetPortId(uint32_t port){portId=port;}
+  void SetPortId(uint32_t port){portId=port; portIdSet=true; registerPortBw();}
   uint32_t getPortId(){return portId;}
 
   // void setHeadRoomQueueScheme(uint32_t scheme) { headRoomQueueScheme = scheme; }
@@ -143,9 +156,8 @@ public:
 
   bool DynamicThresholds(uint32_t priority, Ptr<Packet> packet);
 
-  void UpdateDequeueRate(double nanodelay);
-  void UpdateNofP();
-  void InvokeUpdates(double nanodelay);
+  void rollDequeueWindow(uint32_t p);
+  void addDequeuedBytes(uint32_t p, double bytes);
   bool ActiveBufferManagement(uint32_t priority, Ptr<Packet> packet);
 
   bool FlowAwareBuffer(uint32_t priority, Ptr<Packet> packet);
@@ -162,7 +174,17 @@ public:
 
   bool AcceptPacket(uint32_t priority, Ptr<Packet> packet);
 
-  void TrimPacket(Ptr<Packet> packetCopy);
+  // AnnC: NDP-style trimming, drops the payload in place, fires the Trim trace and returns the bytes removed
+  uint32_t TrimPacket(Ptr<Packet> packetCopy);
+  uint32_t GetHeadersSize(Ptr<const Packet> packet);
+  // AnnC: trims a rejected item and enqueues its headers in queue 0 (TrimOnDrop)
+  bool EnqueueTrimmed(Ptr<QueueDiscItem> item);
+  /**
+   * TracedCallback signature for trimmed packets.
+   * \param [in] packet the packet after trimming
+   * \param [in] trimmedBytes number of payload bytes removed
+   */
+  typedef void (* TrimTracedCallback)(Ptr<const Packet> packet, uint32_t trimmedBytes);
 
   bool MyBM(uint32_t priority, Ptr<Packet> packet, uint32_t bmType=0);
   void setUpHeadRoomNonProber(uint32_t priority, uint32_t flowid, uint32_t bmType);
@@ -173,7 +195,7 @@ public:
   void probeMinBufferSetUp(uint32_t priority);
   void probeMinBuffer(uint32_t priority);
   bool isNewFlow(uint32_t flowId);
-  bool isNewProber(uint32_t proberId);
+  bool isNewProber(uint32_t queueid);
   void probeMinMonitorLongInvoke(uint32_t proberid, uint32_t bmType);
   void probeMinMonitorLongInvoke2(uint32_t proberid, uint64_t nextmoveus);
   void probeMinMonitorLongCollect(uint32_t proberid);
@@ -184,6 +206,10 @@ public:
   void removeFromFlowIdSeen(uint32_t flowid) { flowIdSeen.erase(flowid); }
   void startWindowAfterDrop(uint32_t queueid);
   void endWindowAfterDrop(uint32_t queueid, uint32_t window, uint8_t count);
+  uint32_t classifyMRQueue(Ptr<QueueDiscItem> item, uint32_t p);
+  uint32_t allocateMRQueue(uint32_t flowid);
+  uint32_t sharedMRQueue(uint32_t flowid);
+  void releaseMRQueueIfIdle(uint32_t queueid);
 
   void setParameters(
     uint16_t ParHistLen,
@@ -221,7 +247,16 @@ public:
   double smoothGetAverageQlen(uint32_t p);
 
   std::string pawMode;
+  // AnnC: the MyBM admission test and smoothing for pawMode, picked once by setProbingStats
+  typedef bool (GenQueueDisc::*MyBMDropTest)(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer);
+  MyBMDropTest myBMShouldDrop = &GenQueueDisc::myBMNeverDrop;
+  bool smoothWeightedAverage = true;
+  bool myBMDropAboveAverage(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer);
+  bool myBMDropAboveInstantaneous(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer);
+  bool myBMDropAboveFixedVary(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer);
+  bool myBMNeverDrop(uint32_t priority, uint32_t packetSize, uint32_t instantaneousQSize, uint32_t& maxSize, uint32_t remainingBuffer);
   void insertIntoFixedVaryThresVec(uint32_t key, uint32_t value);
+  void applyFixedVaryThres(uint32_t maxSize);
 
   /**************************** 
    * For COS597K final project
@@ -242,6 +277,16 @@ private:
   virtual void InitializeParams (void);
 
   uint64_t droppedBytes[1008]; // AnnC: isn't this per priority?
+  uint64_t markedBytes[1008];
+
+  TracedCallback<Ptr<const Packet>, uint32_t> m_trimTrace;
+  bool trimOnDrop;
+
+  bool useEcn;
+  double ecnHardDropRatio;
+  bool shouldMark = false; // set by MyBM when the packet should be marked instead of dropped
+  double ecnMarkRatio;
+  bool shouldEarlyMark = false; // set by MyBM when the packet should be marked below currMaxSizeAllowed
 
   /*at enqueue*/
   Time firstSeen[1008];
@@ -253,8 +298,11 @@ private:
   Time lastAcceptedQueue[1008];
   double numBytesSentQueue[1008];
 
+  // AnnC: DeqRate is the normalized dequeue rate over the last full updateInterval window,
+  // Deq the bytes dequeued in the window that started at DeqWindowStart (in ns)
   double DeqRate[1008];
   double Deq[1008];
+  int64_t DeqWindowStart[1008];
 
   uint32_t nPrior;
   std::unordered_map<uint32_t,uint32_t> flowPrior;
@@ -269,11 +317,14 @@ private:
   Ptr<SharedMemoryBuffer> sharedMemory;
   uint32_t bufferalg;
   uint32_t portId;
+  bool portIdSet = false;
+  // AnnC: the water-filling weight of this port; the setup calls setPortBw, SetPortId and SetSharedMemory in any order
+  void registerPortBw(){if (sharedMemory && portIdSet) sharedMemory->setPortBW(portId, portBW);}
   uint32_t sat;
   std::string switchname; //optional
 
   // uint32_t headRoomQueueScheme;
-  uint32_t mainRoomQueueScheme;
+  uint32_t mainRoomQueueScheme = 0; // FQ, CCA and RTT hand out main-room queues at runtime
   // uint32_t headRoomNumQueues;
   uint32_t mainRoomNumQueues;
 
@@ -284,7 +335,7 @@ private:
   double adaptiveIncreaseParameter;
   double adaptiveDecreaseParameter;
   uint32_t targetBW;
-  std::vector<std::pair<uint32_t,uint32_t>> fixedVaryThresVec;
+  uint32_t fixedVaryMaxSize = 0; // fixed_vary threshold in bytes, 0 until the first one applies
 
   // Ptr<UtilityWarehouse> utilityWarehouse;
 
@@ -320,15 +371,18 @@ private:
   // AnnC: [WrongRTTns] temporarily set RTTns as an attribute of the port
   double RTTms;
 
-  double nofP[1008];
 
   bool is_homa;
 
+  bool enableHistograms;
+  std::vector<LogLinearHistogram> sojournHist;
+  std::vector<LogLinearHistogram> occupancyHist;
+
   uint64_t txBytesInt=0;
   bool enableDPPQueue;
 
   std::set<uint32_t> flowIdSeen;
-  std::set<uint32_t> proberStarted;
+  std::vector<bool> proberStarted; // by queue id
   std::vector<uint16_t> idealMinBufferProbeCount;
   std::vector<uint16_t> maxBufferUnchangingCount;
   std::vector<uint32_t> prevMaxBufferUsed;
@@ -339,9 +393,13 @@ private:
   std::vector<bool> isWindowOn;
 
   std::map<uint32_t, uint32_t> flowidHRqueueidMapping;
-  std::map<uint32_t, uint32_t> flowidMRqueueidMapping;
+  std::unordered_map<uint32_t, std::pair<uint32_t,bool>> flowidMRqueueidMapping; // flowid --> <queueid, FIN seen>
   // uint32_t nextAvailableHRqueueid;
-  std::map<uint32_t,uint32_t> ccaHRqueueidMapping;
+  std::unordered_map<uint32_t,uint32_t> ccaHRqueueidMapping; // CCA or RTT class of the sender --> queueid
+  std::vector<uint32_t> freeMRQueues; // pool of queue ids not in use
+  std::vector<uint32_t> mrQueueActiveFlows; // by queue id, flows without a FIN
+  std::vector<std::vector<uint32_t>> mrQueueFlows; // by queue id, flowids mapped to it
+  std::vector<std::vector<uint32_t>> mrQueueClasses; // by queue id, classes mapped to it
 
   uint16_t HistLen;
   uint16_t RemoveStartLen;
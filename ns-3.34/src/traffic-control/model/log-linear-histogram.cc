@@ -0,0 +1,115 @@
+/*
+ * log-linear-histogram.cc
+ */
+
+#include "ns3/assert.h"
+#include "log-linear-histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+LogLinearHistogram::LogLinearHistogram (uint32_t subBucketBits)
+  : subBits (subBucketBits),
+    count (0),
+    sum (0),
+    minValue (UINT64_MAX),
+    maxValue (0)
+{
+  NS_ASSERT (subBits >= 2 && subBits <= 16);
+  // 2^S exact buckets, then 2^(S-1) sub-buckets for each shift in [1, 64-S]
+  counts.resize ((1u << subBits) + (64 - subBits) * (1u << (subBits - 1)), 0);
+}
+
+uint32_t
+LogLinearHistogram::GetIndex (uint64_t value) const
+{
+  if (value < (uint64_t(1) << subBits))
+    {
+      return value;
+    }
+  uint32_t msb = 63 - __builtin_clzll (value);
+  uint32_t shift = msb - (subBits - 1);
+  uint32_t half = 1u << (subBits - 1);
+  uint32_t mantissa = value >> shift; // in [2^(S-1), 2^S)
+  return (1u << subBits) + (shift - 1) * half + (mantissa - half);
+}
+
+uint64_t
+LogLinearHistogram::GetValue (uint32_t index) const
+{
+  if (index < (1u << subBits))
+    {
+      return index;
+    }
+  uint32_t half = 1u << (subBits - 1);
+  uint32_t offset = index - (1u << subBits);
+  uint32_t shift = offset / half + 1;
+  uint64_t mantissa = offset % half + half;
+  // middle of [mantissa << shift, (mantissa+1) << shift)
+  return (mantissa << shift) + ((uint64_t(1) << shift) >> 1);
+}
+
+void
+LogLinearHistogram::Record (uint64_t value)
+{
+  counts[GetIndex (value)]++;
+  count++;
+  sum += value;
+  if (value < minValue) minValue = value;
+  if (value > maxValue) maxValue = value;
+}
+
+void
+LogLinearHistogram::Merge (const LogLinearHistogram &other)
+{
+  NS_ASSERT_MSG (subBits == other.subBits, "Cannot merge histograms with different precision");
+  for (uint32_t i = 0; i < counts.size (); i++)
+    {
+      counts[i] += other.counts[i];
+    }
+  count += other.count;
+  sum += other.sum;
+  minValue = std::min (minValue, other.minValue);
+  maxValue = std::max (maxValue, other.maxValue);
+}
+
+void
+LogLinearHistogram::Reset (void)
+{
+  std::fill (counts.begin (), counts.end (), 0);
+  count = 0;
+  sum = 0;
+  minValue = UINT64_MAX;
+  maxValue = 0;
+}
+
+uint64_t
+LogLinearHistogram::GetPercentile (double q) const
+{
+  if (count == 0)
+    {
+      return 0;
+    }
+  uint64_t rank = std::max (uint64_t(1), uint64_t (std::ceil (q / 100.0 * count)));
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < counts.size (); i++)
+    {
+      seen += counts[i];
+      if (seen >= rank)
+        {
+          return std::min (std::max (GetValue (i), GetMin ()), maxValue);
+        }
+    }
+  return maxValue;
+}
+
+void
+LogLinearHistogram::PrintSummary (std::ostream &os) const
+{
+  os << count << " " << GetMean ()
+     << " " << GetPercentile (50) << " " << GetPercentile (99) << " " << GetPercentile (99.9)
+     << " " << maxValue;
+}
+
+} // namespace ns3
@@ -0,0 +1,58 @@
+/*
+ * log-linear-histogram.h
+ *
+ * HDR-style log-linear histogram used by GenQueueDisc to record per-class
+ * sojourn time and queue occupancy without keeping per-packet samples.
+ */
+
+#ifndef SRC_TRAFFIC_CONTROL_MODEL_LOG_LINEAR_HISTOGRAM_H_
+#define SRC_TRAFFIC_CONTROL_MODEL_LOG_LINEAR_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <vector>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * Values below 2^subBucketBits are recorded exactly; larger values fall into
+ * 2^(subBucketBits-1) linear sub-buckets per power of two, so the relative
+ * error of any reported percentile is bounded by 2^-(subBucketBits-1).
+ * Recording is a couple of shifts and an increment. Histograms with the same
+ * subBucketBits can be merged, e.g., across ports or across runs.
+ */
+class LogLinearHistogram {
+public:
+  LogLinearHistogram (uint32_t subBucketBits = 7);
+
+  void Record (uint64_t value);
+  void Merge (const LogLinearHistogram &other);
+  void Reset (void);
+
+  uint64_t GetCount (void) const { return count; }
+  uint64_t GetMin (void) const { return count ? minValue : 0; }
+  uint64_t GetMax (void) const { return maxValue; }
+  double GetMean (void) const { return count ? double(sum)/count : 0; }
+  /** \param q percentile in [0,100], eg, 99.9 */
+  uint64_t GetPercentile (double q) const;
+
+  /** Prints "count mean p50 p99 p99.9 max" */
+  void PrintSummary (std::ostream &os) const;
+
+private:
+  uint32_t GetIndex (uint64_t value) const;
+  uint64_t GetValue (uint32_t index) const; // representative value of a bucket
+
+  uint32_t subBits;
+  std::vector<uint64_t> counts;
+  uint64_t count;
+  uint64_t sum;
+  uint64_t minValue;
+  uint64_t maxValue;
+};
+
+} // namespace ns3
+
+#endif /* SRC_TRAFFIC_CONTROL_MODEL_LOG_LINEAR_HISTOGRAM_H_ */
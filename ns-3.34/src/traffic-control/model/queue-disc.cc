@@ -102,7 +102,9 @@ QueueDisc::Stats::Stats ()
     nTotalRequeuedPackets (0),
     nTotalRequeuedBytes (0),
     nTotalMarkedPackets (0),
-    nTotalMarkedBytes (0)
+    nTotalMarkedBytes (0),
+    nTotalTrimmedPackets (0),
+    nTotalTrimmedBytes (0)
 {
 }
 
@@ -127,6 +129,8 @@ QueueDisc::Stats::operator += (const Stats& stats)
   nTotalRequeuedBytes += stats.nTotalRequeuedBytes;
   nTotalMarkedPackets += stats.nTotalMarkedPackets;
   nTotalMarkedBytes += stats.nTotalMarkedBytes;
+  nTotalTrimmedPackets += stats.nTotalTrimmedPackets;
+  nTotalTrimmedBytes += stats.nTotalTrimmedBytes;
   return *this;
 }
 
@@ -273,6 +277,13 @@ QueueDisc::Stats::Print (std::ostream &os) const
       itb++;
     }
 
+  if (nTotalTrimmedPackets > 0)
+    {
+      os << std::endl << "Packets/Bytes trimmed before enqueue: "
+                      << nTotalTrimmedPackets << " / "
+                      << nTotalTrimmedBytes;
+    }
+
   os << std::endl;
 }
 
@@ -881,6 +892,19 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
   return true;
 }
 
+void
+QueueDisc::TrimBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t trimmedBytes)
+{
+  NS_LOG_FUNCTION (this << item << trimmedBytes);
+
+  m_stats.nTotalTrimmedPackets++;
+  m_stats.nTotalTrimmedBytes += trimmedBytes;
+
+  NS_LOG_DEBUG ("Total packets/bytes trimmed before enqueue: "
+                << m_stats.nTotalTrimmedPackets << " / "
+                << m_stats.nTotalTrimmedBytes);
+}
+
 bool
 QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
 {
@@ -911,7 +935,7 @@ QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
   NS_ASSERT (m_stats.nTotalReceivedPackets == m_stats.nTotalDroppedPacketsBeforeEnqueue +
              m_stats.nTotalEnqueuedPackets);
   NS_ASSERT (m_stats.nTotalReceivedBytes == m_stats.nTotalDroppedBytesBeforeEnqueue +
-             m_stats.nTotalEnqueuedBytes);
+             m_stats.nTotalEnqueuedBytes + m_stats.nTotalTrimmedBytes);
 
   return retval;
 }
@@ -232,6 +232,10 @@ public:
     uint32_t nTotalMarkedBytes;
     /// Marked bytes, for each reason
     std::map<std::string, uint64_t> nMarkedBytes;
+    /// Total packets trimmed before enqueue
+    uint32_t nTotalTrimmedPackets;
+    /// Total bytes removed from the packets trimmed before enqueue
+    uint64_t nTotalTrimmedBytes;
 
     /// constructor
     Stats ();
@@ -565,6 +569,18 @@ protected:
    */
   bool Mark (Ptr<QueueDiscItem> item, const char* reason);
 
+  /**
+   *  \brief Update the counters after the payload of the given item has been
+   *         trimmed before enqueue
+   *  \param item item that was trimmed, with its new size
+   *  \param trimmedBytes the number of bytes removed from the item
+   *  This method must be called by subclasses that shrink a received item
+   *  before enqueuing it, so that the received bytes still add up to the
+   *  enqueued, dropped and trimmed bytes. Only a root queue disc may trim
+   *  items, since its parent would not see the bytes removed.
+   */
+  void TrimBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t trimmedBytes);
+
 private:
   /**
    * \brief Copy constructor
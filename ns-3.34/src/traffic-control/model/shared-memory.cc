@@ -12,6 +12,7 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/uinteger.h"
+#include "ns3/nstime.h"
 #include "ns3/pointer.h"
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
@@ -57,6 +58,11 @@ TypeId SharedMemoryBuffer::GetTypeId (void)
 	                   UintegerValue (1000*1000),
 	                   MakeUintegerAccessor (&SharedMemoryBuffer::burstReserve),
 	                   MakeUintegerChecker <uint32_t> ())
+		.AddAttribute ("WaterFillInterval",
+	                   "Window of the water-filling allocator; the requests made in a window are resolved together at its end, weighted by port bandwidth (0 grants requests first come, first served)",
+	                   TimeValue (Seconds (0)),
+	                   MakeTimeAccessor (&SharedMemoryBuffer::waterFillInterval),
+	                   MakeTimeChecker ())
 		;
   return tid;
 }
@@ -100,6 +106,7 @@ SharedMemoryBuffer::DoDispose (void)
   	RemainingBuffer=0;
   	maxports=0;
   	maxpriority=0;
+  	waterFillEvent.Cancel();
 
   Object::DoDispose ();
 }
@@ -190,30 +197,24 @@ void SharedMemoryBuffer::setSaturated(uint32_t port,uint32_t priority, double sa
 }
 
 void SharedMemoryBuffer::addDeq(uint32_t bytes,uint32_t prio, uint32_t port){
-	if(Deq[port][prio].size() > 100){
-		sumBytes[port][prio]-= Deq[port][prio][0].first;
-		Deq[port][prio].erase(Deq[port][prio].begin());
+	DeqRing &ring = Deq[port][prio];
+	if (ring.slots.empty()) ring.slots.resize(DeqWindow);
+	if (ring.size == DeqWindow) {
+		sumBytes[port][prio]-= ring.slots[ring.head].first;
+		ring.head = (ring.head+1)%DeqWindow;
+		ring.size--;
 	}
-
-	std::pair<uint32_t,Time> temp;
-	temp.first=bytes;
-	temp.second=Simulator::Now();
-	Deq[port][prio].push_back(temp);
+	ring.slots[(ring.head+ring.size)%DeqWindow] = std::make_pair(bytes, Simulator::Now());
+	ring.size++;
 	sumBytes[port][prio]+=bytes;
 }
 
 double SharedMemoryBuffer::getDeq(uint32_t prio,uint32_t port){
-	Time t = Seconds(0);
-//	std::cout << "Size " << Deq[port][prio].size() << " SumBytes " << sumBytes[port][prio] << std::endl;
-	if(Deq[port][prio].size()>1){
-//		std::cout << "tEnd " << (Deq[port][prio].end()-1)->second.GetSeconds() << " tBegin " << Deq[port][prio].begin()->second.GetSeconds() << std::endl;
-		t = (Deq[port][prio].end()-1)->second - Deq[port][prio].begin()->second;
-	}
-	else
+	const DeqRing &ring = Deq[port][prio];
+	if (ring.size<=1)
 		return 1;
+	Time t = ring.slots[(ring.head+ring.size-1)%DeqWindow].second - ring.slots[ring.head].second;
 	double deq = 8*sumBytes[port][prio]/t.GetSeconds()/MaxRate;
-//	std::cout << "Size " << Deq[port][prio].size() << " SumBytes " << sumBytes[port][prio] << " Deq " << deq << " t " << t.GetSeconds()<< std::endl;
-//	std::cout << "Deq " << deq << std::endl;
 	if (deq>1 || deq<0) // sanity check
 		return 1;
 	else
@@ -255,6 +256,7 @@ void SharedMemoryBuffer::setUp(uint32_t numports, uint32_t numqueues, uint32_t r
 		// normalizedPortBW.push_back(0);
 		// averageQueueRTT.push_back(0);
 		currMaxSizeAllowedLastChanged.push_back(0);
+		cmsaDemand.push_back(0);
 		// doMonitorDrop.push_back(true);
 		// doMonitorDrop.push_back(false);
 		// qSize.push_back(0);
@@ -434,7 +436,7 @@ void SharedMemoryBuffer::removeFromProberInHeadRoom(uint32_t proberId) {
 }
 
 bool SharedMemoryBuffer::isProberInWaitRoom(uint32_t proberId) {
-	if (proberInWaitRoom.find(proberId) != proberInWaitRoom.end()) return false;
+	if (proberInWaitRoom.find(proberId) == proberInWaitRoom.end()) return false;
 	if (proberInWaitRoom.at(proberId) > 0) return true;
 	return false;
 }
@@ -961,6 +963,14 @@ void SharedMemoryBuffer::allocateBufferSpaceSimple(uint32_t thisProberId, int32_
 	if (verbose) std::cout << Simulator::Now() << ": allocateBufferSpaceSimple, thisProberId=" << thisProberId << ", marginalRequest=" << marginalRequest;
 
 	uint32_t prevCMSA = currMaxSizeAllowed[thisProberId];
+	if (!waterFillInterval.IsZero()) {
+		// AnnC: the grant below only hands out free buffer; the water-filling at the end of the window rebalances
+		cmsaDemand[thisProberId] = std::max((int64_t)0, (int64_t)prevCMSA+marginalRequest);
+		if (!waterFillEvent.IsRunning()) {
+			int64_t step = waterFillInterval.GetTimeStep();
+			waterFillEvent = Simulator::Schedule(TimeStep(step - Simulator::Now().GetTimeStep()%step), &SharedMemoryBuffer::waterFillBufferSpace, this);
+		}
+	}
 	uint32_t totalbufferused = 0;
 	for (uint32_t i=0; i<getTotalProbers(); i++) {
 		uint32_t cmsa = currMaxSizeAllowed[i];
@@ -979,6 +989,67 @@ void SharedMemoryBuffer::allocateBufferSpaceSimple(uint32_t thisProberId, int32_
 	checkChangeInCurrMaxSizeAllowed(thisProberId,prevCMSA,thisCMSA);
 }
 
+double SharedMemoryBuffer::getPortWeight(uint32_t portid) {
+	std::map<uint32_t, double>::iterator it = portBW.find(portid);
+	if (it != portBW.end() && it->second > 0) return it->second;
+	// AnnC: a port without a bandwidth weighs as the average port, in the same unit (Gbps) as the others
+	double sum = 0;
+	uint32_t known = 0;
+	for (it = portBW.begin(); it != portBW.end(); it++) {
+		if (it->second > 0) {
+			sum += it->second;
+			known++;
+		}
+	}
+	return known > 0 ? sum/known : 1;
+}
+
+// AnnC: weighted max-min fair split of capacity among probers: sorted by demand per unit of port bandwidth,
+// a prober gets its demand while that is below its share of what is left, and everyone after that gets their share.
+// Returns the buffer handed out.
+uint32_t SharedMemoryBuffer::waterFill(std::vector<uint32_t> &probers, uint32_t capacity) {
+	std::sort(probers.begin(), probers.end(), [this](uint32_t a, uint32_t b) {
+		return cmsaDemand[a]/getPortWeight(getPortId(a)) < cmsaDemand[b]/getPortWeight(getPortId(b));
+	});
+	double weights = 0;
+	for (uint32_t i=0; i<probers.size(); i++) weights += getPortWeight(getPortId(probers[i]));
+	double remaining = capacity;
+	uint32_t granted = 0;
+	for (uint32_t i=0; i<probers.size(); i++) {
+		uint32_t proberid = probers[i];
+		double weight = getPortWeight(getPortId(proberid));
+		uint32_t thisCMSA = (uint32_t)std::min((double)cmsaDemand[proberid], remaining*weight/weights + 1e-6); // 1e-6: whole shares do not round down
+		weights -= weight;
+		remaining -= thisCMSA;
+		granted += thisCMSA;
+		uint32_t prevCMSA = currMaxSizeAllowed[proberid];
+		if (verbose) std::cout << Simulator::Now() << ": waterFill, proberId=" << proberid << ", demand=" << cmsaDemand[proberid] << ", prev=" << prevCMSA << ", this=" << thisCMSA << std::endl;
+		currMaxSizeAllowed[proberid] = thisCMSA;
+		checkChangeInCurrMaxSizeAllowed(proberid,prevCMSA,thisCMSA);
+	}
+	return granted;
+}
+
+void SharedMemoryBuffer::waterFillBufferSpace() {
+	// AnnC: wait-room probers keep what they hold, head-room probers are filled first and may use the burst reserve,
+	// main-room probers share what is left outside of the reserve
+	std::vector<uint32_t> headRoomProbers;
+	std::vector<uint32_t> mainRoomProbers;
+	uint32_t waitRoomHeld = 0;
+	for (uint32_t i=0; i<getTotalProbers(); i++) {
+		if (isProberInWaitRoom(i)) {
+			waitRoomHeld += currMaxSizeAllowed[i];
+		} else if (cmsaDemand[i]>0 || currMaxSizeAllowed[i]>0) {
+			if (isProberInHeadRoom(i)) headRoomProbers.push_back(i);
+			else mainRoomProbers.push_back(i);
+		}
+	}
+	uint32_t capacity = TotalBuffer>waitRoomHeld ? TotalBuffer-waitRoomHeld : 0;
+	uint32_t headRoomGranted = waterFill(headRoomProbers, capacity);
+	uint32_t reserve = std::max(burstReserve, headRoomGranted);
+	waterFill(mainRoomProbers, capacity>reserve ? capacity-reserve : 0);
+}
+
 // void SharedMemoryBuffer::allocateBufferSpace(uint32_t thisProberId, int32_t marginalRequest) {
 // 	if (marginalRequest>0) marginalRequest = (((marginalRequest-1)/1500)+1)*1500;
 // 	if (verbose) std::cout << Simulator::Now() << ": allocateBufferSpace, thisProberId=" << thisProberId << ", marginalRequest=" << marginalRequest;
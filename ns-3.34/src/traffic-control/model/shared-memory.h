@@ -81,10 +81,11 @@ public:
 	// void setBufferSizeLockStart(uint32_t proberid, uint64_t value) { bufferSizeLockStart[proberid] = value; }
 	// void setMinBufferThreshold(uint32_t proberid, uint32_t threshold);
 	// void setBurstToleranceThreshold(uint32_t portid, uint32_t queueid, uint32_t threshold) { burstToleranceThreshold[getProberId(portid,queueid)] = threshold; }
-	void setCurrMaxSizeAllowed(uint32_t proberid, uint32_t threshold) { currMaxSizeAllowed[proberid] = threshold; }
+	void setCurrMaxSizeAllowed(uint32_t proberid, uint32_t threshold) { currMaxSizeAllowed[proberid] = threshold; cmsaDemand[proberid] = threshold; }
 	// bool getDoMonitorDrop(uint32_t proberid) { return doMonitorDrop[proberid]; }
 	// void setDoMonitorDrop(uint32_t proberid, bool value);
 	// void setNormalizedPortBW(uint32_t proberid, double bw) { normalizedPortBW[proberid] = bw; }
+	void setPortBW(uint32_t portid, double bw) { portBW[portid] = bw; }
 	// void setAverageQueueRTT(uint32_t proberid, uint32_t rtt) { averageQueueRTT[proberid] = rtt; }
 	// void addProberToProberAwaitingMinBuffer(uint32_t proberId);
 	// bool isProberInProberAwaitingMinBuffer(uint32_t proberId);
@@ -108,6 +109,7 @@ public:
 	bool isProberInWaitRoom(uint32_t proberId);
 	// void collectDebugStats();
 	void allocateBufferSpaceSimple(uint32_t thisProberId, int32_t marginalRequest);
+	void waterFillBufferSpace();
 	// void allocateBufferSpace(uint32_t thisProberId, int32_t marginalRequest);
 	// void allocateBufferSpace2(uint32_t thisProberId, int32_t marginalRequest);
 	// void allocateBufferSpaceDeprecated(uint32_t thisProberId, int32_t marginalRequest);
@@ -218,6 +220,9 @@ protected:
 
 
 private:
+	double getPortWeight(uint32_t portid);
+	uint32_t waterFill(std::vector<uint32_t> &probers, uint32_t capacity);
+
 	uint32_t TotalBuffer;
 	uint32_t OccupiedBuffer;
 	uint32_t OccupiedBufferPriority[1008]={0};
@@ -229,7 +234,14 @@ private:
 
 	std::unordered_map<uint32_t,uint32_t> PriorityToGroupMap;
 
-	std::vector<std::pair<uint32_t,Time>> Deq[100][1008];
+	// AnnC: the last DeqWindow dequeues of a queue, in a ring that is allocated on first use
+	struct DeqRing {
+		std::vector<std::pair<uint32_t,Time>> slots;
+		uint32_t head = 0; // oldest entry
+		uint32_t size = 0;
+	};
+	static constexpr uint32_t DeqWindow = 101;
+	DeqRing Deq[100][1008];
 	double sumBytes[100][1008];
 	Time tDiff[100][1008];
 	uint64_t MaxRate;
@@ -260,6 +272,11 @@ private:
 	// std::vector<uint32_t> minBufferThreshold;
 	// std::vector<uint32_t> burstToleranceThreshold;
 	std::vector<int64_t> currMaxSizeAllowedLastChanged;
+	// AnnC: water-filling allocator, off when waterFillInterval is zero
+	Time waterFillInterval;
+	EventId waterFillEvent;
+	std::vector<uint32_t> cmsaDemand; // latest CMSA asked for by each prober
+	std::map<uint32_t, double> portBW; // in Gbps, the weight of the probers of a port
 	// std::vector<double> normalizedPortBW;
 	// std::vector<uint32_t> averageQueueRTT;
 	// std::vector<bool> doMonitorDrop;
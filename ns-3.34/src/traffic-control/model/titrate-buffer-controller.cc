@@ -0,0 +1,199 @@
+/*
+ * AnnC: Titrate threshold adaptation for a single queue that is not a GenQueueDisc.
+ * See titrate-buffer-controller.h.
+ */
+
+#include "titrate-buffer-controller.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TitrateBufferController");
+
+NS_OBJECT_ENSURE_REGISTERED (TitrateBufferController);
+
+TypeId TitrateBufferController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TitrateBufferController")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<TitrateBufferController> ()
+    .AddAttribute ("MonitorInterval",
+                   "Length of the monitoring window opened by a drop, in ms (monitorInterval)",
+                   UintegerValue (500),
+                   MakeUintegerAccessor (&TitrateBufferController::monitorlongms),
+                   MakeUintegerChecker<uint16_t> (1))
+    .AddAttribute ("ExploreThres",
+                   "ssthresh is set to this multiple of the threshold when it grows (ParExploreThres)",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&TitrateBufferController::ExploreThres),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("IncreaseRatio",
+                   "Growth factor in tenths applied when the queue ran empty (ParIncreaseRatio)",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&TitrateBufferController::IncreaseRatio),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("DecreaseRatio",
+                   "Decrease step in MTUs below ssthresh (ParDecreaseRatio)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TitrateBufferController::DecreaseRatio),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("InitialThreshold",
+                   "Starting threshold in bytes (startProbeBuffer), 0 to start at the maximum",
+                   UintegerValue (15000),
+                   MakeUintegerAccessor (&TitrateBufferController::initialThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("Threshold",
+                     "Current Titrate threshold in bytes",
+                     MakeTraceSourceAccessor (&TitrateBufferController::threshold),
+                     "ns3::TracedValueCallback::Uint32")
+  ;
+  return tid;
+}
+
+TitrateBufferController::TitrateBufferController ()
+  : maxThreshold (0),
+    threshold (0),
+    ssthreshBuffer (0),
+    isWindowOn (false),
+    maxBufferUsed (0),
+    minBufferUsed (1000000000),
+    dropBytes (0),
+    sentBytes (0),
+    zeroStart (-1),
+    zeroWindowSum (0),
+    windowStart (0)
+{
+}
+
+TitrateBufferController::~TitrateBufferController ()
+{
+}
+
+void TitrateBufferController::DoDispose (void)
+{
+  windowEvent.Cancel ();
+  Object::DoDispose ();
+}
+
+void TitrateBufferController::SetMaxThreshold (uint32_t maxBytes)
+{
+  maxThreshold = maxBytes;
+  threshold = initialThreshold > 0 ? std::min (initialThreshold, maxBytes) : maxBytes;
+  ssthreshBuffer = maxBytes;
+}
+
+void TitrateBufferController::updateMinMax (uint32_t qBytes)
+{
+  if (qBytes < minBufferUsed) minBufferUsed = qBytes;
+  if (qBytes > maxBufferUsed) maxBufferUsed = qBytes;
+}
+
+void TitrateBufferController::NotifyEnqueue (uint32_t qBytes)
+{
+  if (zeroStart != -1 && qBytes != 0) {
+    int64_t now = Simulator::Now ().GetNanoSeconds ();
+    zeroWindowSum += now - std::max (zeroStart, windowStart*1000);
+    zeroStart = -1;
+  }
+  updateMinMax (qBytes);
+}
+
+void TitrateBufferController::NotifyDequeue (uint32_t qBytes, uint32_t bytes)
+{
+  sentBytes += bytes;
+  if (zeroStart == -1 && qBytes == 0) {
+    zeroStart = Simulator::Now ().GetNanoSeconds ();
+  }
+  updateMinMax (qBytes);
+}
+
+void TitrateBufferController::NotifyDrop (uint32_t qBytes, uint32_t bytes)
+{
+  startWindowAfterDrop ();
+  dropBytes += bytes;
+  updateMinMax (qBytes);
+}
+
+void TitrateBufferController::startWindowAfterDrop ()
+{
+  if (isWindowOn) return;
+  isWindowOn = true;
+  maxBufferUsed = 0;
+  dropBytes = 0;
+  sentBytes = 0;
+  minBufferUsed = 1000000000;
+  zeroWindowSum = 0;
+  windowStart = Simulator::Now ().GetMicroSeconds ();
+  windowEvent = Simulator::Schedule (MilliSeconds (monitorlongms), &TitrateBufferController::endWindowAfterDrop, this, 1);
+}
+
+TitrateBufferController::Step
+TitrateBufferController::WindowStep (uint32_t threshold, uint32_t ssthresh, int64_t zeroWindowSum, uint32_t minBufferUsed,
+                                     uint32_t windowMs, uint8_t count,
+                                     uint16_t exploreThres, uint16_t increaseRatio, uint16_t decreaseRatio)
+{
+  double MTU = 1500;
+  uint8_t SAFE_THRES = 2;
+  uint8_t SSTHRESH_MULTIPLIER = exploreThres;
+  uint8_t DEC_RATIO = decreaseRatio;
+  double INC_RATIO = increaseRatio/10.0;
+  uint8_t COUNT_THRES = 2;
+  uint32_t cmsa = threshold;
+  Step step = {false, false, 0, ssthresh};
+  if (zeroWindowSum > 0) {
+    step.ssthresh = cmsa * SSTHRESH_MULTIPLIER;
+    // the queue cannot have been empty for the whole window, as it was dropping
+    double busy = std::max ((double) windowMs*1000000 - zeroWindowSum, 1.0);
+    double grow = (INC_RATIO*windowMs*1000000/busy)*cmsa - cmsa;
+    step.resize = true;
+    step.change = (int64_t) std::max (grow, 0.0);
+  } else if (minBufferUsed > SAFE_THRES*MTU) {
+    if (count < COUNT_THRES) {
+      // one more monitoring interval
+      step.extend = true;
+    } else if (cmsa > ssthresh) {
+      uint32_t thres_change = (uint32_t)(cmsa-(cmsa+ssthresh)/2.0);
+      thres_change = (uint32_t)((thres_change-1)/(double)MTU + 1)*MTU;
+      if (cmsa-thres_change > SAFE_THRES*MTU) {
+        step.resize = true;
+        step.change = -(int64_t) thres_change;
+      }
+    } else if (cmsa-MTU*count > SAFE_THRES*MTU) {
+      step.resize = true;
+      step.change = -(int64_t) (DEC_RATIO*MTU*count);
+    }
+  }
+  return step;
+}
+
+void TitrateBufferController::endWindowAfterDrop (uint8_t count)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) count << threshold << zeroWindowSum << minBufferUsed << dropBytes << sentBytes);
+  Step step = WindowStep (threshold, ssthreshBuffer, zeroWindowSum, minBufferUsed, monitorlongms, count,
+                          ExploreThres, IncreaseRatio, DecreaseRatio);
+  if (step.extend) {
+    windowEvent = Simulator::Schedule (MilliSeconds (monitorlongms), &TitrateBufferController::endWindowAfterDrop, this, count+1);
+    return;
+  }
+  ssthreshBuffer = step.ssthresh;
+  if (step.resize) allocateBufferSpaceSimple (step.change);
+  isWindowOn = false;
+}
+
+void TitrateBufferController::allocateBufferSpaceSimple (int64_t marginalRequest)
+{
+  // a single prober owns the whole buffer, so only the buffer size caps the growth
+  int64_t current = threshold.Get ();
+  if (marginalRequest > 0 && current + marginalRequest > maxThreshold) {
+    marginalRequest = std::max ((int64_t) maxThreshold - current, (int64_t) 0);
+  }
+  int64_t next = std::max (current + marginalRequest, (int64_t) 0);
+  threshold = (uint32_t) next;
+}
+
+} // namespace ns3
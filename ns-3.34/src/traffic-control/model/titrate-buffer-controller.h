@@ -0,0 +1,102 @@
+/*
+ * AnnC: Titrate threshold adaptation for a single queue that is not a GenQueueDisc
+ * (e.g. the LTE RLC transmit buffer).
+ *
+ * This is the per-prober logic of GenQueueDisc::startWindowAfterDrop/endWindowAfterDrop
+ * (mainRoomNumQueues==12) with the SharedMemoryBuffer prober state kept locally:
+ * a drop opens a monitoring window; at its end the threshold grows if the queue ran
+ * empty during the window, and shrinks if it never got close to empty. The decision
+ * at the end of a window is WindowStep, which GenQueueDisc uses as well.
+ */
+
+#ifndef TITRATE_BUFFER_CONTROLLER_H
+#define TITRATE_BUFFER_CONTROLLER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+class TitrateBufferController : public Object {
+public:
+  static TypeId GetTypeId (void);
+  TitrateBufferController ();
+  virtual ~TitrateBufferController ();
+
+  /**
+   * \brief Set the buffer the threshold can grow to; the threshold starts at
+   * InitialThreshold, or at the maximum if InitialThreshold is 0
+   */
+  void SetMaxThreshold (uint32_t maxBytes);
+  uint32_t GetThreshold () const { return threshold; }
+
+  /// \return true if a packet of pktBytes fits under the threshold with qBytes queued
+  bool CanEnqueue (uint32_t qBytes, uint32_t pktBytes) const { return qBytes + pktBytes <= threshold; }
+
+  /// Call after a packet was added to the queue, with the new queue length
+  void NotifyEnqueue (uint32_t qBytes);
+  /// Call after bytes left the queue, with the new queue length
+  void NotifyDequeue (uint32_t qBytes, uint32_t bytes);
+  /// Call when a packet was refused, with the current queue length
+  void NotifyDrop (uint32_t qBytes, uint32_t bytes);
+
+  /// Decision at the end of a monitoring window, see WindowStep
+  struct Step {
+    bool extend;        ///< watch one more window before deciding
+    bool resize;        ///< change the threshold by change
+    int64_t change;     ///< bytes to add to the threshold, negative to remove
+    uint32_t ssthresh;  ///< the ssthresh to keep
+  };
+
+  /**
+   * \brief The design_mar2625_v2 Titrate step at the end of a monitoring window
+   * \param threshold the current threshold (currMaxSizeAllowed)
+   * \param ssthresh the current ssthresh
+   * \param zeroWindowSum time the queue was empty during the window, in ns
+   * \param minBufferUsed the smallest queue length seen during the window
+   * \param windowMs the length of the window in ms
+   * \param count the number of windows watched so far, from 1
+   * \param exploreThres ParExploreThres
+   * \param increaseRatio ParIncreaseRatio
+   * \param decreaseRatio ParDecreaseRatio
+   * \return what to do with the threshold
+   */
+  static Step WindowStep (uint32_t threshold, uint32_t ssthresh, int64_t zeroWindowSum, uint32_t minBufferUsed,
+                          uint32_t windowMs, uint8_t count,
+                          uint16_t exploreThres, uint16_t increaseRatio, uint16_t decreaseRatio);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  void startWindowAfterDrop ();
+  void endWindowAfterDrop (uint8_t count);
+  void allocateBufferSpaceSimple (int64_t marginalRequest);
+  void updateMinMax (uint32_t qBytes);
+
+  uint16_t monitorlongms;
+  uint16_t ExploreThres;
+  uint16_t IncreaseRatio;
+  uint16_t DecreaseRatio;
+  uint32_t initialThreshold;
+
+  uint32_t maxThreshold;
+  TracedValue<uint32_t> threshold; // currMaxSizeAllowed
+  uint32_t ssthreshBuffer;
+
+  bool isWindowOn;
+  EventId windowEvent;
+  uint32_t maxBufferUsed;  // probeMinMaxBufferUsed
+  uint32_t minBufferUsed;  // probeMinMinBufferUsed
+  uint32_t dropBytes;      // probeMinTotalDropBytes
+  uint32_t sentBytes;      // probeMinAverageThroughput
+  int64_t zeroStart;       // designZeroStart, ns, -1 if the queue is not empty
+  int64_t zeroWindowSum;   // designZeroWindowSum, ns
+  int64_t windowStart;     // designZeroWindowStart, us
+};
+
+} // namespace ns3
+
+#endif /* TITRATE_BUFFER_CONTROLLER_H */
@@ -0,0 +1,414 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/gen-queue-disc.h"
+#include "ns3/shared-memory.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/tcp-header.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/custom-priority-tag.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief GenQueueDisc TrimOnDrop test
+ */
+class GenQueueDiscTrimTestCase : public TestCase
+{
+public:
+  GenQueueDiscTrimTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a GenQueueDisc with two classes sharing a complete-sharing buffer
+   * \param bufferSize the size of the shared buffer
+   * \param trimOnDrop the TrimOnDrop attribute
+   * \return the queue disc
+   */
+  Ptr<GenQueueDisc> CreateQueueDisc (uint32_t bufferSize, bool trimOnDrop);
+  /**
+   * Create a TCP data segment of flow 7 in queue 1
+   * \param seq the sequence number
+   * \param payload the payload size
+   * \return the queue disc item
+   */
+  Ptr<QueueDiscItem> CreateItem (uint32_t seq, uint32_t payload);
+  /**
+   * Record a trimmed packet
+   * \param packet the trimmed packet
+   * \param trimmedBytes the bytes removed
+   */
+  void Trimmed (Ptr<const Packet> packet, uint32_t trimmedBytes);
+
+  uint32_t m_nTrimmed;      //!< number of Trim trace calls
+  uint32_t m_trimmedBytes;  //!< bytes reported by the Trim trace
+};
+
+GenQueueDiscTrimTestCase::GenQueueDiscTrimTestCase ()
+  : TestCase ("TrimOnDrop enqueues the headers of a rejected packet in queue 0"),
+    m_nTrimmed (0),
+    m_trimmedBytes (0)
+{
+}
+
+Ptr<GenQueueDisc>
+GenQueueDiscTrimTestCase::CreateQueueDisc (uint32_t bufferSize, bool trimOnDrop)
+{
+  Ptr<SharedMemoryBuffer> sharedMemory = CreateObject<SharedMemoryBuffer> ();
+  sharedMemory->SetAttribute ("BufferSize", UintegerValue (bufferSize));
+  sharedMemory->SetSharedBufferSize (bufferSize);
+  sharedMemory->setUp (1, 2, 1, 0, 1);
+
+  Ptr<GenQueueDisc> qdisc = CreateObject<GenQueueDisc> ();
+  qdisc->SetAttribute ("TrimOnDrop", BooleanValue (trimOnDrop));
+  qdisc->SetSharedMemory (sharedMemory);
+  qdisc->SetBufferAlgorithm (103); // complete sharing: accept while the shared buffer has room
+  qdisc->SetPortId (0);
+  qdisc->setNPrior (2);
+  qdisc->TraceConnectWithoutContext ("Trim", MakeCallback (&GenQueueDiscTrimTestCase::Trimmed, this));
+  qdisc->Initialize ();
+  return qdisc;
+}
+
+Ptr<QueueDiscItem>
+GenQueueDiscTrimTestCase::CreateItem (uint32_t seq, uint32_t payload)
+{
+  Ptr<Packet> p = Create<Packet> (payload);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (49153);
+  tcpHeader.SetDestinationPort (5000);
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (seq));
+  tcpHeader.SetFlags (TcpHeader::ACK);
+  p->AddHeader (tcpHeader);
+  p->AddPacketTag (FlowIdTag (7));
+  MyPriorityTag priorityTag;
+  priorityTag.SetPriority (1);
+  p->AddPacketTag (priorityTag);
+  Ipv4Header ipHeader;
+  ipHeader.SetPayloadSize (p->GetSize ());
+  ipHeader.SetProtocol (6);
+  return Create<Ipv4QueueDiscItem> (p, Address (), 0, ipHeader);
+}
+
+void
+GenQueueDiscTrimTestCase::Trimmed (Ptr<const Packet> packet, uint32_t trimmedBytes)
+{
+  m_nTrimmed++;
+  m_trimmedBytes += trimmedBytes;
+}
+
+void
+GenQueueDiscTrimTestCase::DoRun (void)
+{
+  // two 1040-byte items fit in the buffer, the third one does not, and
+  // 81 bytes are left for the headers of the next ones
+  uint32_t headerSize = 20 + 20; // TCP and IPv4
+  Ptr<GenQueueDisc> dropping = CreateQueueDisc (2161, false);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      dropping->Enqueue (CreateItem (1 + i * 1000, 1000));
+    }
+  NS_TEST_EXPECT_MSG_EQ (dropping->GetStats ().nTotalDroppedPackets, 1, "Without TrimOnDrop the packet is dropped");
+  NS_TEST_EXPECT_MSG_EQ (dropping->GetNPackets (), 2, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (m_nTrimmed, 0, "Without TrimOnDrop nothing is trimmed");
+
+  Ptr<GenQueueDisc> qdisc = CreateQueueDisc (2161, true);
+  NS_TEST_EXPECT_MSG_EQ (qdisc->Enqueue (CreateItem (1, 1000)), true, "The first packet fits");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->Enqueue (CreateItem (1001, 1000)), true, "The second packet fits");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->Enqueue (CreateItem (2001, 1000)), true, "The headers of the third packet fit");
+
+  QueueDisc::Stats stats = qdisc->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalDroppedPackets, 0, "A trimmed packet is not a dropped packet");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalTrimmedPackets, 1, "Wrong number of trimmed packets");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalTrimmedBytes, 1000, "The whole payload is trimmed");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalEnqueuedBytes, 2 * (1000 + headerSize) + headerSize, "Wrong enqueued bytes");
+  NS_TEST_EXPECT_MSG_EQ (m_nTrimmed, 1, "The Trim trace did not fire once");
+  NS_TEST_EXPECT_MSG_EQ (m_trimmedBytes, 1000, "The Trim trace reported the wrong size");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetSharedMemory ()->GetRemainingBuffer (), 2161 - 2 * (1000 + headerSize) - headerSize,
+                         "The trimmed packet only takes its headers from the shared buffer");
+
+  // the trimmed packet is alone in queue 0, with its TCP header and tags intact
+  Ptr<QueueDisc> control = qdisc->GetQueueDiscClass (0)->GetQueueDisc ();
+  NS_TEST_ASSERT_MSG_EQ (control->GetNPackets (), 1, "The trimmed packet is not in queue 0");
+  Ptr<const QueueDiscItem> item = control->Peek ();
+  NS_TEST_EXPECT_MSG_EQ (item->GetSize (), headerSize, "The trimmed item is not its headers");
+  Ptr<Packet> trimmed = item->GetPacket ();
+  TcpHeader tcpHeader;
+  NS_TEST_EXPECT_MSG_EQ (trimmed->RemoveHeader (tcpHeader), 20, "The TCP header was not kept");
+  NS_TEST_EXPECT_MSG_EQ (tcpHeader.GetSequenceNumber (), SequenceNumber32 (2001), "Wrong sequence number");
+  NS_TEST_EXPECT_MSG_EQ (tcpHeader.GetSourcePort (), 49153, "Wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (tcpHeader.GetDestinationPort (), 5000, "Wrong destination port");
+  NS_TEST_EXPECT_MSG_EQ (trimmed->GetSize (), 0, "Payload left after trimming");
+  trimmed->AddHeader (tcpHeader);
+  FlowIdTag flowIdTag;
+  NS_TEST_ASSERT_MSG_EQ (trimmed->PeekPacketTag (flowIdTag), true, "The flow id tag was not kept");
+  NS_TEST_EXPECT_MSG_EQ (flowIdTag.GetFlowId (), 7, "Wrong flow id");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (flowIdTag.GetTrim ()), 1, "The trim bit is not set");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 2,
+                         "The untrimmed packets moved");
+
+  // once the headers do not fit either, the packet is dropped
+  NS_TEST_EXPECT_MSG_EQ (qdisc->Enqueue (CreateItem (3001, 1000)), true, "The headers of the fourth packet fit");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->Enqueue (CreateItem (4001, 1000)), false, "The headers of the fifth packet do not fit");
+  stats = qdisc->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalTrimmedPackets, 2, "Wrong number of trimmed packets");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalDroppedPackets, 1, "The fifth packet is not dropped");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalDroppedBytes, 1000 + headerSize, "The fifth packet is not dropped whole");
+
+  // the dequeued headers give their space back to the shared buffer
+  uint32_t nHeaders = 0;
+  uint32_t remaining = qdisc->GetSharedMemory ()->GetRemainingBuffer ();
+  while (Ptr<QueueDiscItem> dequeued = qdisc->Dequeue ())
+    {
+      uint32_t remainingNow = qdisc->GetSharedMemory ()->GetRemainingBuffer ();
+      if (dequeued->GetSize () == headerSize)
+        {
+          nHeaders++;
+          NS_TEST_EXPECT_MSG_EQ (remainingNow - remaining, headerSize, "The headers did not give their space back");
+        }
+      remaining = remainingNow;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nHeaders, 2, "Wrong number of trimmed packets dequeued");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief GenQueueDisc main-room queue pool test
+ */
+class GenQueueDiscPoolTestCase : public TestCase
+{
+public:
+  GenQueueDiscPoolTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a TCP segment in class 1
+   * \param flowId the flow id
+   * \param flags the TCP flags
+   * \return the queue disc item
+   */
+  Ptr<QueueDiscItem> CreateItem (uint32_t flowId, uint8_t flags);
+  /**
+   * Enqueue a segment and find the queue it went to
+   * \param qdisc the queue disc
+   * \param flowId the flow id
+   * \param flags the TCP flags
+   * \return the queue whose length grew
+   */
+  uint32_t EnqueueTo (Ptr<GenQueueDisc> qdisc, uint32_t flowId, uint8_t flags);
+};
+
+GenQueueDiscPoolTestCase::GenQueueDiscPoolTestCase ()
+  : TestCase ("FQ flows beyond the pool and stragglers of ended flows only share queues in use")
+{
+}
+
+Ptr<QueueDiscItem>
+GenQueueDiscPoolTestCase::CreateItem (uint32_t flowId, uint8_t flags)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHeader;
+  tcpHeader.SetFlags (flags);
+  p->AddHeader (tcpHeader);
+  p->AddPacketTag (FlowIdTag (flowId));
+  MyPriorityTag priorityTag;
+  priorityTag.SetPriority (1);
+  p->AddPacketTag (priorityTag);
+  Ipv4Header ipHeader;
+  ipHeader.SetPayloadSize (p->GetSize ());
+  ipHeader.SetProtocol (6);
+  return Create<Ipv4QueueDiscItem> (p, Address (), 0, ipHeader);
+}
+
+uint32_t
+GenQueueDiscPoolTestCase::EnqueueTo (Ptr<GenQueueDisc> qdisc, uint32_t flowId, uint8_t flags)
+{
+  std::vector<uint32_t> before;
+  for (uint32_t q = 0; q < qdisc->GetNQueueDiscClasses (); q++)
+    {
+      before.push_back (qdisc->GetQueueDiscClass (q)->GetQueueDisc ()->GetNPackets ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (qdisc->Enqueue (CreateItem (flowId, flags)), true, "Flow " << flowId << " was dropped");
+  for (uint32_t q = 0; q < qdisc->GetNQueueDiscClasses (); q++)
+    {
+      if (qdisc->GetQueueDiscClass (q)->GetQueueDisc ()->GetNPackets () > before[q])
+        {
+          return q;
+        }
+    }
+  return qdisc->GetNQueueDiscClasses ();
+}
+
+void
+GenQueueDiscPoolTestCase::DoRun (void)
+{
+  // queues 1 and 2 are the pool, queue 0 is for control packets
+  uint32_t nPrior = 3;
+  Ptr<SharedMemoryBuffer> sharedMemory = CreateObject<SharedMemoryBuffer> ();
+  sharedMemory->SetAttribute ("BufferSize", UintegerValue (1000000));
+  sharedMemory->SetSharedBufferSize (1000000);
+  sharedMemory->setUp (1, nPrior, 1, 0, nPrior - 1);
+
+  Ptr<GenQueueDisc> qdisc = CreateObject<GenQueueDisc> ();
+  qdisc->SetSharedMemory (sharedMemory);
+  qdisc->SetBufferAlgorithm (103);
+  qdisc->SetPortId (0);
+  qdisc->setNPrior (nPrior);
+  qdisc->setMainRoomQueueScheme (201); // FQ
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::FifoQueueDisc");
+  for (uint32_t q = 0; q < nPrior; q++)
+    {
+      Ptr<QueueDisc> child = factory.Create<QueueDisc> ();
+      child->Initialize ();
+      Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+      c->SetQueueDisc (child);
+      qdisc->AddQueueDiscClass (c);
+    }
+  qdisc->Initialize ();
+  qdisc->setUpTrackingStats (nPrior);
+
+  uint32_t q10 = EnqueueTo (qdisc, 10, TcpHeader::ACK);
+  uint32_t q11 = EnqueueTo (qdisc, 11, TcpHeader::ACK);
+  NS_TEST_EXPECT_MSG_NE (q10, q11, "Two flows did not get a queue each");
+  NS_TEST_EXPECT_MSG_EQ ((q10 >= 1 && q10 < nPrior && q11 >= 1 && q11 < nPrior), true, "A flow is not in the pool");
+
+  // the pool is exhausted: flow 13 shares a queue in use, and keeps it
+  uint32_t q13 = EnqueueTo (qdisc, 13, TcpHeader::ACK);
+  NS_TEST_EXPECT_MSG_EQ ((q13 == q10 || q13 == q11), true, "Flow 13 is not in a queue in use");
+  NS_TEST_EXPECT_MSG_EQ (EnqueueTo (qdisc, 13, TcpHeader::ACK), q13, "Flow 13 moved");
+
+  // flow 10 ends, its queue goes back to the pool once drained, unless flow 13 shares it
+  NS_TEST_EXPECT_MSG_EQ (EnqueueTo (qdisc, 10, TcpHeader::FIN | TcpHeader::ACK), q10, "The FIN left the queue of its flow");
+  while (qdisc->Dequeue ())
+    {
+    }
+  uint32_t busy = q13 == q10 ? q10 : q11;
+  uint32_t freed = q13 == q10 ? q11 : q10;
+  if (q13 == q10)
+    {
+      // flow 13 keeps q10 in use, end flow 11 so that its queue is freed
+      NS_TEST_EXPECT_MSG_EQ (EnqueueTo (qdisc, 11, TcpHeader::FIN | TcpHeader::ACK), q11, "The FIN left the queue of its flow");
+      while (qdisc->Dequeue ())
+        {
+        }
+    }
+
+  // stragglers of both ended flows go to the queue still in use, never to the free one
+  NS_TEST_EXPECT_MSG_EQ (EnqueueTo (qdisc, 10, TcpHeader::ACK), busy, "A straggler went to a free queue");
+  NS_TEST_EXPECT_MSG_EQ (EnqueueTo (qdisc, q13 == q10 ? 11 : 10, TcpHeader::ACK), busy, "A straggler went to a free queue");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetQueueDiscClass (freed)->GetQueueDisc ()->GetNPackets (), 0, "The free queue has packets");
+
+  // the free queue is handed to the next flow, alone
+  NS_TEST_EXPECT_MSG_EQ (EnqueueTo (qdisc, 14, TcpHeader::ACK), freed, "A new flow did not get the free queue");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Water-filling weighted by the port bandwidth of the GenQueueDiscs
+ */
+class GenQueueDiscWaterFillTestCase : public TestCase
+{
+public:
+  GenQueueDiscWaterFillTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GenQueueDiscWaterFillTestCase::GenQueueDiscWaterFillTestCase ()
+  : TestCase ("The water-filling splits the shared buffer by the bandwidth of the ports")
+{
+}
+
+void
+GenQueueDiscWaterFillTestCase::DoRun (void)
+{
+  uint32_t nPrior = 2;
+  Ptr<SharedMemoryBuffer> sharedMemory = CreateObject<SharedMemoryBuffer> ();
+  sharedMemory->SetAttribute ("BufferSize", UintegerValue (400000));
+  sharedMemory->SetAttribute ("BurstReserve", UintegerValue (0));
+  sharedMemory->SetAttribute ("WaterFillInterval", TimeValue (MilliSeconds (1)));
+  sharedMemory->SetSharedBufferSize (400000);
+  sharedMemory->setUp (2, nPrior, 1, 0, nPrior - 1);
+
+  // set up in the order of star-buffer-mp: the bandwidth before the shared buffer
+  double bw[] = {1, 3};
+  std::vector<Ptr<GenQueueDisc> > qdiscs;
+  for (uint32_t port = 0; port < 2; port++)
+    {
+      Ptr<GenQueueDisc> qdisc = CreateObject<GenQueueDisc> ();
+      qdisc->SetPortId (port);
+      qdisc->setPortBw (bw[port]);
+      qdisc->SetSharedMemory (sharedMemory);
+      qdiscs.push_back (qdisc);
+    }
+  uint32_t prober0 = sharedMemory->getProberId (0, 1);
+  uint32_t prober1 = sharedMemory->getProberId (1, 1);
+
+  // both ports ask for the whole buffer in the same window
+  sharedMemory->allocateBufferSpaceSimple (prober0, 400000);
+  sharedMemory->allocateBufferSpaceSimple (prober1, 400000);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (sharedMemory->getCurrMaxSizeAllowed (prober0), 100000, "The 1 Gbps port did not get a quarter");
+  NS_TEST_EXPECT_MSG_EQ (sharedMemory->getCurrMaxSizeAllowed (prober1), 300000, "The 3 Gbps port did not get three quarters");
+
+  // a bandwidth changed later, as by deltaBw, changes the weight
+  qdiscs[0]->setPortBw (3);
+  sharedMemory->allocateBufferSpaceSimple (prober0, 300000);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (sharedMemory->getCurrMaxSizeAllowed (prober0), 200000, "Equal ports did not get half each");
+  NS_TEST_EXPECT_MSG_EQ (sharedMemory->getCurrMaxSizeAllowed (prober1), 200000, "Equal ports did not get half each");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief GenQueueDisc Test Suite
+ */
+static class GenQueueDiscTestSuite : public TestSuite
+{
+public:
+  GenQueueDiscTestSuite ()
+    : TestSuite ("gen-queue-disc", UNIT)
+  {
+    AddTestCase (new GenQueueDiscTrimTestCase (), TestCase::QUICK);
+    AddTestCase (new GenQueueDiscPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new GenQueueDiscWaterFillTestCase (), TestCase::QUICK);
+  }
+} g_genQueueDiscTestSuite; ///< the test suite
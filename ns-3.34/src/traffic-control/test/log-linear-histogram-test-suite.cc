@@ -0,0 +1,215 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log-linear-histogram.h"
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the buckets values fall in at their boundaries
+ */
+class LogLinearHistogramBucketTestCase : public TestCase
+{
+public:
+  LogLinearHistogramBucketTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LogLinearHistogramBucketTestCase::LogLinearHistogramBucketTestCase ()
+  : TestCase ("Values are recorded exactly below 2^subBucketBits, then in log-linear buckets")
+{
+}
+
+void
+LogLinearHistogramBucketTestCase::DoRun (void)
+{
+  // 4 sub-bucket bits: 0..15 exactly, then 8 buckets per power of two
+  LogLinearHistogram h (4);
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile (50), 0, "An empty histogram reports 0");
+  NS_TEST_EXPECT_MSG_EQ (h.GetMin (), 0, "An empty histogram reports 0");
+
+  // 0, the last exact value, the first two buckets of width 2, the last
+  // bucket of width 2 and the first bucket of width 4, and a large value
+  // so that the percentiles are not clamped to the maximum
+  uint64_t values[] = {0, 15, 16, 17, 18, 31, 32, 35, 1000000};
+  for (uint64_t v : values)
+    {
+      h.Record (v);
+    }
+  NS_TEST_ASSERT_MSG_EQ (h.GetCount (), 9, "Wrong count");
+  NS_TEST_EXPECT_MSG_EQ (h.GetMin (), 0, "Wrong minimum");
+  NS_TEST_EXPECT_MSG_EQ (h.GetMax (), 1000000, "Wrong maximum");
+
+  // the value reported for rank k, at percentile (k - 0.5) * step, is the
+  // middle of the bucket of that rank
+  double step = 100.0 / 9;
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile ((1 - 0.5) * step), 0, "0 is recorded exactly");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile ((2 - 0.5) * step), 15, "15 is recorded exactly");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile ((3 - 0.5) * step), 17, "16 falls in [16,18)");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile ((4 - 0.5) * step), 17, "17 falls in [16,18)");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile ((5 - 0.5) * step), 19, "18 falls in [18,20)");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile ((6 - 0.5) * step), 31, "31 falls in [30,32)");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile ((7 - 0.5) * step), 34, "32 falls in [32,36)");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile ((8 - 0.5) * step), 34, "35 falls in [32,36)");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile (100), 1000000, "The maximum is reported at 100");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the relative error of the percentiles, and the top bucket
+ */
+class LogLinearHistogramQuantileTestCase : public TestCase
+{
+public:
+  LogLinearHistogramQuantileTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LogLinearHistogramQuantileTestCase::LogLinearHistogramQuantileTestCase ()
+  : TestCase ("Percentiles are within the relative error of their bucket, up to the top bucket")
+{
+}
+
+void
+LogLinearHistogramQuantileTestCase::DoRun (void)
+{
+  // each value between the minimum and the maximum of the histogram is
+  // reported within 2^-(subBucketBits-1) of itself
+  for (uint32_t bits : {2u, 7u, 16u})
+    {
+      double maxError = 1.0 / (1u << (bits - 1));
+      for (uint64_t v = 1; v < UINT64_MAX / 3; v = v * 3 + 1)
+        {
+          LogLinearHistogram h (bits);
+          h.Record (0);
+          h.Record (v);
+          h.Record (UINT64_MAX);
+          uint64_t p = h.GetPercentile (50);
+          double error = (p > v ? double (p - v) : double (v - p)) / v;
+          NS_TEST_EXPECT_MSG_LT_OR_EQ (error, maxError, "Value " << v << " reported as " << p << " with " << bits << " bits");
+        }
+    }
+
+  // the top bucket, [2^64 - 2^57, 2^64), holds the largest 64-bit values
+  // without overflowing the value reported for it
+  LogLinearHistogram top (7);
+  top.Record (UINT64_MAX);
+  top.Record (UINT64_MAX - 1);
+  top.Record (uint64_t (1) << 63);
+  NS_TEST_EXPECT_MSG_EQ (top.GetMax (), UINT64_MAX, "Wrong maximum");
+  NS_TEST_EXPECT_MSG_EQ (top.GetMin (), uint64_t (1) << 63, "Wrong minimum");
+  NS_TEST_EXPECT_MSG_EQ (top.GetPercentile (100), UINT64_MAX - (uint64_t (1) << 56) + 1,
+                         "UINT64_MAX not reported as the middle of the top bucket");
+  NS_TEST_EXPECT_MSG_EQ (top.GetPercentile (50), UINT64_MAX - (uint64_t (1) << 56) + 1,
+                         "UINT64_MAX - 1 not reported as the middle of the top bucket");
+  NS_TEST_EXPECT_MSG_EQ (top.GetPercentile (1), (uint64_t (1) << 63) + (uint64_t (1) << 56),
+                         "2^63 not reported as the middle of its bucket");
+
+  // 1..1000 uniformly: the percentiles are within 1/64 of the exact ones
+  LogLinearHistogram uniform (7);
+  for (uint64_t v = 1; v <= 1000; v++)
+    {
+      uniform.Record (v);
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (double (uniform.GetPercentile (50)), 500, 500.0 / 64, "Wrong median");
+  NS_TEST_EXPECT_MSG_EQ_TOL (double (uniform.GetPercentile (99)), 990, 990.0 / 64, "Wrong 99th percentile");
+  NS_TEST_EXPECT_MSG_EQ_TOL (uniform.GetMean (), 500.5, 1e-9, "The mean is exact");
+
+  std::ostringstream summary;
+  uniform.PrintSummary (summary);
+  std::ostringstream expected;
+  expected << 1000 << " " << 500.5 << " " << uniform.GetPercentile (50) << " " << uniform.GetPercentile (99)
+           << " " << uniform.GetPercentile (99.9) << " " << 1000;
+  NS_TEST_EXPECT_MSG_EQ (summary.str (), expected.str (), "Wrong summary");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that merged histograms are the same as one histogram
+ */
+class LogLinearHistogramMergeTestCase : public TestCase
+{
+public:
+  LogLinearHistogramMergeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LogLinearHistogramMergeTestCase::LogLinearHistogramMergeTestCase ()
+  : TestCase ("Merged histograms report the same as one histogram of all the values, Reset empties one")
+{
+}
+
+void
+LogLinearHistogramMergeTestCase::DoRun (void)
+{
+  LogLinearHistogram all;
+  LogLinearHistogram even;
+  LogLinearHistogram odd;
+  for (uint64_t v = 0; v < 5000; v += 7)
+    {
+      all.Record (v);
+      (v % 2 ? odd : even).Record (v);
+    }
+  even.Merge (odd);
+  NS_TEST_EXPECT_MSG_EQ (even.GetCount (), all.GetCount (), "Wrong count");
+  NS_TEST_EXPECT_MSG_EQ (even.GetMin (), all.GetMin (), "Wrong minimum");
+  NS_TEST_EXPECT_MSG_EQ (even.GetMax (), all.GetMax (), "Wrong maximum");
+  for (double q : {0.1, 10.0, 50.0, 90.0, 99.0, 99.9, 100.0})
+    {
+      NS_TEST_EXPECT_MSG_EQ (even.GetPercentile (q), all.GetPercentile (q), "Wrong percentile " << q);
+    }
+
+  even.Reset ();
+  NS_TEST_EXPECT_MSG_EQ (even.GetCount (), 0, "Reset did not empty the histogram");
+  NS_TEST_EXPECT_MSG_EQ (even.GetMax (), 0, "Reset did not clear the maximum");
+  even.Record (42);
+  NS_TEST_EXPECT_MSG_EQ (even.GetMin (), 42, "Reset did not clear the minimum");
+  NS_TEST_EXPECT_MSG_EQ (even.GetPercentile (50), 42, "Wrong percentile after Reset");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief LogLinearHistogram Test Suite
+ */
+static class LogLinearHistogramTestSuite : public TestSuite
+{
+public:
+  LogLinearHistogramTestSuite ()
+    : TestSuite ("log-linear-histogram", UNIT)
+  {
+    AddTestCase (new LogLinearHistogramBucketTestCase (), TestCase::QUICK);
+    AddTestCase (new LogLinearHistogramQuantileTestCase (), TestCase::QUICK);
+    AddTestCase (new LogLinearHistogramMergeTestCase (), TestCase::QUICK);
+  }
+} g_logLinearHistogramTestSuite; ///< the test suite
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Wi-Fi bottleneck for the Titrate WifiMacQueue mode.
+//
+//   server ---- p2p (1 Gbps) ---- AP ~~~~ 802.11n ~~~~ STA 0 .. STA n-1
+//
+// The server sends one bulk TCP download to each STA. The AP has no
+// queue disc, so the per-AC WifiMacQueues of the AP are the bottleneck
+// queue. Run it once with the default MaxSize/MaxDelay policy and once
+// with --titrate to let Titrate adapt an admission threshold below
+// MaxSize, starting from startProbeBuffer, then compare the per-flow
+// delay and throughput:
+//
+//   ./waf --run "wifi-titrate-bottleneck"
+//   ./waf --run "wifi-titrate-bottleneck --titrate=1"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/ssid.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("WifiTitrateBottleneck");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nStas = 2;
+  double simulationTime = 10; // seconds
+  std::string phyRate = "HtMcs7";
+  std::string maxSize = "500p";
+  Time maxDelay = MilliSeconds (500);
+  bool titrate = false;
+  uint16_t monitorInterval = 500;
+  uint32_t startProbeBuffer = 96000; // one A-MPDU of 64 MPDUs
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("nStas", "Number of stations, one download each", nStas);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("phyRate", "Physical layer bitrate", phyRate);
+  cmd.AddValue ("maxSize", "MaxSize of the WifiMacQueues", maxSize);
+  cmd.AddValue ("maxDelay", "MaxDelay of the WifiMacQueues", maxDelay);
+  cmd.AddValue ("titrate", "Let Titrate adapt the AP queue admission threshold", titrate);
+  cmd.AddValue ("monitorInterval", "Titrate monitoring window after a drop [ms]", monitorInterval);
+  cmd.AddValue ("startProbeBuffer", "Titrate starting threshold in bytes, 0 to start at MaxSize", startProbeBuffer);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (4 * 1024 * 1024));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (4 * 1024 * 1024));
+  Config::SetDefault ("ns3::WifiMacQueue::MaxSize", QueueSizeValue (QueueSize (maxSize)));
+  Config::SetDefault ("ns3::WifiMacQueue::MaxDelay", TimeValue (maxDelay));
+  Config::SetDefault ("ns3::TitrateBufferController::MonitorInterval", UintegerValue (monitorInterval));
+  Config::SetDefault ("ns3::TitrateBufferController::InitialThreshold", UintegerValue (startProbeBuffer));
+
+  NodeContainer serverNode;
+  serverNode.Create (1);
+  NodeContainer apNode;
+  apNode.Create (1);
+  NodeContainer staNodes;
+  staNodes.Create (nStas);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  NetDeviceContainer wiredDevices = p2p.Install (serverNode.Get (0), apNode.Get (0));
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211n_5GHZ);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue (phyRate),
+                                "ControlMode", StringValue ("HtMcs0"));
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy;
+  phy.SetChannel (channel.Create ());
+
+  WifiMacHelper mac;
+  Ssid ssid = Ssid ("titrate");
+  mac.SetType ("ns3::StaWifiMac", "Ssid", SsidValue (ssid));
+  NetDeviceContainer staDevices = wifi.Install (phy, mac, staNodes);
+  mac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (ssid));
+  NetDeviceContainer apDevice = wifi.Install (phy, mac, apNode);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  for (uint32_t i = 0; i < nStas; i++)
+    {
+      positionAlloc->Add (Vector (5.0, i, 0.0));
+    }
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (apNode);
+  mobility.Install (staNodes);
+
+  InternetStackHelper stack;
+  stack.Install (serverNode);
+  stack.Install (apNode);
+  stack.Install (staNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer serverInterface = address.Assign (wiredDevices);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  address.Assign (apDevice);
+  Ipv4InterfaceContainer staInterfaces = address.Assign (staDevices);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // no queue disc on the AP, so that packets wait in the WifiMacQueues
+  TrafficControlHelper tch;
+  tch.Uninstall (apDevice);
+
+  for (const char *ac : {"VO", "VI", "BE", "BK"})
+    {
+      Config::Set ("/NodeList/" + std::to_string (apNode.Get (0)->GetId ())
+                   + "/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/" + ac + "_Txop/Queue/EnableTitrate",
+                   BooleanValue (titrate));
+    }
+
+  uint16_t port = 9;
+  ApplicationContainer sinkApps;
+  ApplicationContainer sourceApps;
+  for (uint32_t i = 0; i < nStas; i++)
+    {
+      PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+      sinkApps.Add (sink.Install (staNodes.Get (i)));
+
+      BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (staInterfaces.GetAddress (i), port));
+      source.SetAttribute ("MaxBytes", UintegerValue (0));
+      sourceApps.Add (source.Install (serverNode.Get (0)));
+    }
+  sinkApps.Start (Seconds (0.0));
+  sourceApps.Start (Seconds (1.0));
+
+  FlowMonitorHelper flowHelper;
+  Ptr<FlowMonitor> flowMonitor = flowHelper.InstallAll ();
+
+  Simulator::Stop (Seconds (simulationTime + 1));
+  Simulator::Run ();
+
+  flowMonitor->CheckForLostPackets ();
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
+  std::cout << "WifiMacQueue MaxSize " << maxSize << ", MaxDelay " << maxDelay.As (Time::MS)
+            << (titrate ? ", Titrate" : ", no Titrate") << std::endl;
+  for (const auto& flow : flowMonitor->GetFlowStats ())
+    {
+      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (flow.first);
+      if (t.sourceAddress != serverInterface.GetAddress (0) || flow.second.rxPackets == 0)
+        {
+          continue; // only report the downlink data direction
+        }
+      const FlowMonitor::FlowStats& st = flow.second;
+      double duration = (st.timeLastRxPacket - st.timeFirstTxPacket).GetSeconds ();
+      std::cout << "Flow " << flow.first << " (" << t.sourceAddress << " -> " << t.destinationAddress << ")"
+                << "  throughput " << st.rxBytes * 8.0 / duration / 1e6 << " Mbps"
+                << "  mean delay " << st.delaySum.GetMilliSeconds () / (double) st.rxPackets << " ms"
+                << "  lost " << st.lostPackets << "/" << st.txPackets
+                << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
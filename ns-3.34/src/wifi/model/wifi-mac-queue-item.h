@@ -28,6 +28,7 @@
 #include "wifi-mac-header.h"
 #include "amsdu-subframe-header.h"
 #include <list>
+#include <array>
 
 namespace ns3 {
 
@@ -196,6 +197,17 @@ private:
   Time m_tstamp;                                //!< timestamp when the packet arrived at the queue
   DeaggregatedMsdus m_msduList;                 //!< The list of aggregated MSDUs included in this MPDU
   std::list<QueueIteratorPair> m_queueIts;      //!< Queue iterators pointing to this MSDU(s), if queued
+
+  /// Entry of this item in one of the lookup indexes of the WifiMacQueue holding it
+  struct QueueIndexEntry
+  {
+    std::list<ConstIterator>* index;              //!< the index (list in queue order)
+    std::list<ConstIterator>::iterator it;        //!< the entry pointing to this item
+  };
+
+  int64_t m_queueRank;                          //!< increases from head to tail of the queue holding this item
+  std::array<QueueIndexEntry, 3> m_queueIndexEntries; //!< entries in the queue indexes, if queued
+  uint8_t m_nQueueIndexEntries;                 //!< number of valid entries in m_queueIndexEntries
 };
 
 /**
@@ -22,6 +22,7 @@
  */
 
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
 #include "wifi-mac-queue.h"
 #include "qos-blocked-destinations.h"
 #include <functional>
@@ -55,6 +56,11 @@ WifiMacQueue::GetTypeId (void)
                    MakeEnumAccessor (&WifiMacQueue::m_dropPolicy),
                    MakeEnumChecker (WifiMacQueue::DROP_OLDEST, "DropOldest",
                                     WifiMacQueue::DROP_NEWEST, "DropNewest"))
+    .AddAttribute ("EnableTitrate",
+                   "Admit packets against a Titrate threshold (in bytes) that adapts below MaxSize",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&WifiMacQueue::m_enableTitrate),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Expired", "MPDU dropped because its lifetime expired.",
                      MakeTraceSourceAccessor (&WifiMacQueue::m_traceExpired),
                      "ns3::WifiMacQueueItem::TracedCallback")
@@ -64,6 +70,7 @@ WifiMacQueue::GetTypeId (void)
 
 WifiMacQueue::WifiMacQueue ()
   : m_expiredPacketsPresent (false),
+    m_enableTitrate (false),
     NS_LOG_TEMPLATE_DEFINE ("WifiMacQueue")
 {
 }
@@ -73,6 +80,22 @@ WifiMacQueue::~WifiMacQueue ()
   NS_LOG_FUNCTION_NOARGS ();
   m_nQueuedPackets.clear ();
   m_nQueuedBytes.clear ();
+  m_tidAddressIndex.clear ();
+  m_tidIndex.clear ();
+  m_addressIndex.clear ();
+  m_nonQosDataIndex.clear ();
+}
+
+void
+WifiMacQueue::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_titrate)
+    {
+      m_titrate->Dispose ();
+      m_titrate = 0;
+    }
+  Queue<WifiMacQueueItem>::DoDispose ();
 }
 
 static std::list<Ptr<WifiMacQueueItem>> g_emptyWifiMacQueue; //!< empty Wi-Fi MAC queue
@@ -139,8 +162,16 @@ WifiMacQueue::Insert (ConstIterator pos, Ptr<WifiMacQueueItem> item)
   //     std::cout<<*em<<std::endl;
   // }
   // std::cout<<"TOTAL"<<QueueBase::GetTotalReceivedPackets()<<std::endl;
+  if (m_enableTitrate && !m_titrate)
+    {
+      // the threshold is in bytes, MaxSize in packets of at most one MTU
+      m_titrate = CreateObject<TitrateBufferController> ();
+      m_titrate->SetMaxThreshold (GetMaxSize ().GetValue () * 1500);
+    }
+  bool titrateFull = m_titrate && !m_titrate->CanEnqueue (QueueBase::GetNBytes (), item->GetSize ());
+
   // insert the item if the queue is not full
-  if (QueueBase::GetNPackets () < GetMaxSize ().GetValue ())
+  if (QueueBase::GetNPackets () < GetMaxSize ().GetValue () && !titrateFull)
     {
       return DoEnqueue (pos, item);
     }
@@ -160,6 +191,11 @@ WifiMacQueue::Insert (ConstIterator pos, Ptr<WifiMacQueueItem> item)
       it++;
     }
 
+  if (m_titrate)
+    {
+      m_titrate->NotifyDrop (QueueBase::GetNBytes (), item->GetSize ());
+    }
+
   // the queue is still full, remove the oldest item if the policy is drop oldest
   if (m_dropPolicy == DROP_OLDEST)
     {
@@ -175,6 +211,12 @@ WifiMacQueue::Insert (ConstIterator pos, Ptr<WifiMacQueueItem> item)
           DoRemove (begin ());
         }
     }
+  else if (titrateFull)
+    {
+      // below MaxSize the base queue would accept the item
+      DropBeforeEnqueue (item);
+      return false;
+    }
   std::cout<<"TOTAL"<<QueueBase::GetTotalReceivedPackets()<<std::endl;
   return DoEnqueue (pos, item);
 }
@@ -326,89 +368,66 @@ WifiMacQueue::ConstIterator
 WifiMacQueue::PeekByAddress (Mac48Address dest, ConstIterator pos) const
 {
   NS_LOG_FUNCTION (this << dest);
-  ConstIterator it = (pos != EMPTY ? pos : begin ());
-  while (it != end ())
+  auto index = m_addressIndex.find (dest);
+  if (index == m_addressIndex.end ())
     {
-      // skip packets that stayed in the queue for too long. They will be
-      // actually removed from the queue by the next call to a non-const method
-      if (Simulator::Now () <= (*it)->GetTimeStamp () + m_maxDelay)
-        {
-          if (((*it)->GetHeader ().IsData () || (*it)->GetHeader ().IsQosData ())
-              && (*it)->GetDestinationAddress () == dest)
-            {
-              return it;
-            }
-        }
-      else
-        {
-          // signal the presence of expired packets
-          m_expiredPacketsPresent = true;
-        }
-      it++;
+      NS_LOG_DEBUG ("The queue is empty");
+      return end ();
     }
-  NS_LOG_DEBUG ("The queue is empty");
-  return end ();
+  return PeekInIndex (index->second, pos);
 }
 
 WifiMacQueue::ConstIterator
 WifiMacQueue::PeekByTid (uint8_t tid, ConstIterator pos) const
 {
   NS_LOG_FUNCTION (this << +tid);
-  ConstIterator it = (pos != EMPTY ? pos : begin ());
-  while (it != end ())
+  auto index = m_tidIndex.find (tid);
+  if (index == m_tidIndex.end ())
     {
-      // skip packets that stayed in the queue for too long. They will be
-      // actually removed from the queue by the next call to a non-const method
-      if (Simulator::Now () <= (*it)->GetTimeStamp () + m_maxDelay)
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return it;
-            }
-        }
-      else
-        {
-          // signal the presence of expired packets
-          m_expiredPacketsPresent = true;
-        }
-      it++;
+      NS_LOG_DEBUG ("The queue is empty");
+      return end ();
     }
-  NS_LOG_DEBUG ("The queue is empty");
-  return end ();
+  return PeekInIndex (index->second, pos);
 }
 
 WifiMacQueue::ConstIterator
 WifiMacQueue::PeekByTidAndAddress (uint8_t tid, Mac48Address dest, ConstIterator pos) const
 {
   NS_LOG_FUNCTION (this << +tid << dest);
-  ConstIterator it = (pos != EMPTY ? pos : begin ());
-  while (it != end ())
+  auto index = m_tidAddressIndex.find (WifiAddressTidPair (dest, tid));
+  if (index == m_tidAddressIndex.end ())
     {
-      // skip packets that stayed in the queue for too long. They will be
-      // actually removed from the queue by the next call to a non-const method
-      if (Simulator::Now () <= (*it)->GetTimeStamp () + m_maxDelay)
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return it;
-            }
-        }
-      else
-        {
-          // signal the presence of expired packets
-          m_expiredPacketsPresent = true;
-        }
-      it++;
+      NS_LOG_DEBUG ("The queue is empty");
+      return end ();
     }
-  NS_LOG_DEBUG ("The queue is empty");
-  return end ();
+  return PeekInIndex (index->second, pos);
 }
 
 WifiMacQueue::ConstIterator
 WifiMacQueue::PeekFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets, ConstIterator pos) const
 {
   NS_LOG_FUNCTION (this);
+  if (blockedPackets && (pos == EMPTY || pos == begin ()))
+    {
+      // the first available item is the earliest of the first non-QoS data frame
+      // and the heads of the (receiver, TID) indexes that are not blocked
+      ConstIterator first = PeekInIndex (m_nonQosDataIndex, EMPTY);
+      for (const auto& index : m_tidAddressIndex)
+        {
+          if (index.second.empty ()
+              || blockedPackets->IsBlocked (index.first.first, index.first.second))
+            {
+              continue;
+            }
+          ConstIterator it = PeekInIndex (index.second, EMPTY);
+          if (it != end () && (first == end () || (*it)->m_queueRank < (*first)->m_queueRank))
+            {
+              first = it;
+            }
+        }
+      return first;
+    }
+
   ConstIterator it = (pos != EMPTY ? pos : begin ());
   while (it != end ())
     {
@@ -644,6 +663,12 @@ WifiMacQueue::DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item)
         }
       // set item's information about its position in the queue
       item->m_queueIts = {{this, ret}};
+      SetRank (ret);
+      AddToIndexes (ret);
+      if (m_titrate)
+        {
+          m_titrate->NotifyEnqueue (QueueBase::GetNBytes ());
+        }
       return true;
     }
   return false;
@@ -669,6 +694,11 @@ WifiMacQueue::DoDequeue (ConstIterator pos)
     {
       NS_ASSERT (item->m_queueIts.size () == 1);
       item->m_queueIts.clear ();
+      RemoveFromIndexes (item);
+      if (m_titrate)
+        {
+          m_titrate->NotifyDequeue (QueueBase::GetNBytes (), item->GetSize ());
+        }
     }
 
   return item;
@@ -694,9 +724,169 @@ WifiMacQueue::DoRemove (ConstIterator pos)
     {
       NS_ASSERT (item->m_queueIts.size () == 1);
       item->m_queueIts.clear ();
+      RemoveFromIndexes (item);
+      if (m_titrate)
+        {
+          m_titrate->NotifyDequeue (QueueBase::GetNBytes (), item->GetSize ());
+        }
     }
 
   return item;
 }
 
+void
+WifiMacQueue::SetRank (ConstIterator pos)
+{
+  // ranks are spaced so that insertions in the middle rarely need a renumbering
+  static const int64_t RANK_GAP = 1 << 16;
+
+  ConstIterator next = std::next (pos);
+  bool hasPrev = (pos != begin ());
+  bool hasNext = (next != end ());
+  if (!hasPrev && !hasNext)
+    {
+      (*pos)->m_queueRank = 0;
+    }
+  else if (!hasNext)
+    {
+      (*pos)->m_queueRank = (*std::prev (pos))->m_queueRank + RANK_GAP;
+    }
+  else if (!hasPrev)
+    {
+      (*pos)->m_queueRank = (*next)->m_queueRank - RANK_GAP;
+    }
+  else
+    {
+      int64_t prevRank = (*std::prev (pos))->m_queueRank;
+      int64_t nextRank = (*next)->m_queueRank;
+      if (nextRank - prevRank > 1)
+        {
+          (*pos)->m_queueRank = prevRank + (nextRank - prevRank) / 2;
+        }
+      else
+        {
+          NS_LOG_DEBUG ("Renumbering the queue");
+          int64_t rank = 0;
+          for (ConstIterator it = begin (); it != end (); it++)
+            {
+              (*it)->m_queueRank = rank;
+              rank += RANK_GAP;
+            }
+        }
+    }
+}
+
+void
+WifiMacQueue::AddToIndexes (ConstIterator pos)
+{
+  const WifiMacHeader& hdr = (*pos)->GetHeader ();
+  (*pos)->m_nQueueIndexEntries = 0;
+  if (hdr.IsQosData ())
+    {
+      InsertInIndex (m_tidAddressIndex[WifiAddressTidPair (hdr.GetAddr1 (), hdr.GetQosTid ())], pos);
+      InsertInIndex (m_tidIndex[hdr.GetQosTid ()], pos);
+    }
+  else
+    {
+      InsertInIndex (m_nonQosDataIndex, pos);
+    }
+  if (hdr.IsData ())
+    {
+      InsertInIndex (m_addressIndex[hdr.GetAddr1 ()], pos);
+    }
+}
+
+void
+WifiMacQueue::InsertInIndex (QueueIndex &index, ConstIterator pos)
+{
+  Ptr<WifiMacQueueItem> item = *pos;
+  int64_t rank = item->m_queueRank;
+  QueueIndex::iterator it = index.end ();
+  if (!index.empty () && (*index.front ())->m_queueRank > rank)
+    {
+      it = index.begin ();
+    }
+  else
+    {
+      // items are mostly enqueued at the tail, so search from the back
+      while (it != index.begin () && (*(*std::prev (it)))->m_queueRank > rank)
+        {
+          it--;
+        }
+    }
+  NS_ASSERT (item->m_nQueueIndexEntries < item->m_queueIndexEntries.size ());
+  item->m_queueIndexEntries[item->m_nQueueIndexEntries++] = {&index, index.insert (it, pos)};
+}
+
+void
+WifiMacQueue::RemoveFromIndexes (Ptr<WifiMacQueueItem> item)
+{
+  for (uint8_t i = 0; i < item->m_nQueueIndexEntries; i++)
+    {
+      item->m_queueIndexEntries[i].index->erase (item->m_queueIndexEntries[i].it);
+    }
+  item->m_nQueueIndexEntries = 0;
+  const WifiMacHeader& hdr = item->GetHeader ();
+  if (hdr.IsQosData ())
+    {
+      // PeekFirstAvailable goes through every (receiver, TID) index
+      auto index = m_tidAddressIndex.find (WifiAddressTidPair (hdr.GetAddr1 (), hdr.GetQosTid ()));
+      if (index != m_tidAddressIndex.end () && index->second.empty ())
+        {
+          m_tidAddressIndex.erase (index);
+        }
+    }
+}
+
+WifiMacQueue::ConstIterator
+WifiMacQueue::PeekInIndex (const QueueIndex &index, ConstIterator pos) const
+{
+  QueueIndex::const_iterator it = index.begin ();
+  if (pos != EMPTY && pos != begin ())
+    {
+      if (pos == end ())
+        {
+          return end ();
+        }
+      // callers usually resume the search from a matching item or right after it
+      int64_t rank = (*pos)->m_queueRank;
+      bool found = false;
+      for (uint8_t i = 0; i < (*pos)->m_nQueueIndexEntries && !found; i++)
+        {
+          if ((*pos)->m_queueIndexEntries[i].index == &index)
+            {
+              it = (*pos)->m_queueIndexEntries[i].it;
+              found = true;
+            }
+        }
+      ConstIterator prev = std::prev (pos);
+      for (uint8_t i = 0; i < (*prev)->m_nQueueIndexEntries && !found; i++)
+        {
+          if ((*prev)->m_queueIndexEntries[i].index == &index)
+            {
+              it = std::next ((*prev)->m_queueIndexEntries[i].it);
+              found = true;
+            }
+        }
+      while (!found && it != index.end () && (*(*it))->m_queueRank < rank)
+        {
+          it++;
+        }
+    }
+
+  for (; it != index.end (); it++)
+    {
+      // skip packets that stayed in the queue for too long. They will be
+      // actually removed from the queue by the next call to a non-const method
+      if (Simulator::Now () <= (*(*it))->GetTimeStamp () + m_maxDelay)
+        {
+          return *it;
+        }
+      // signal the presence of expired packets
+      m_expiredPacketsPresent = true;
+    }
+  NS_LOG_DEBUG ("The queue is empty");
+  return end ();
+}
+
 } //namespace ns3
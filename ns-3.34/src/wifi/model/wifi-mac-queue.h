@@ -26,6 +26,7 @@
 
 #include "wifi-mac-queue-item.h"
 #include "ns3/queue.h"
+#include "ns3/titrate-buffer-controller.h"
 #include <unordered_map>
 #include "qos-utils.h"
 
@@ -55,6 +56,13 @@ extern template class Queue<WifiMacQueueItem>;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * Queued items are indexed by (receiver, TID), by TID, by receiver and
+ * (for non-QoS data frames) in a separate list, each index kept in queue
+ * order, so that the PeekBy* lookups do not scan the whole queue.
+ *
+ * If EnableTitrate is set, items are admitted against a Titrate threshold
+ * (in bytes) that adapts below MaxSize, as GenQueueDisc does for its queues.
  */
 class WifiMacQueue : public Queue<WifiMacQueueItem>
 {
@@ -338,6 +346,8 @@ public:
   //std::deque<int64_t> time_list;
 
 private:
+  void DoDispose (void) override;
+
   /**
    * Remove the item pointed to by the iterator <i>it</i> if it has been in the
    * queue for too long. If the item is removed, the iterator is updated to
@@ -376,6 +386,46 @@ private:
    */
   Ptr<WifiMacQueueItem> DoRemove (ConstIterator pos);
 
+  /// Iterators to queued items, in queue order
+  typedef std::list<ConstIterator> QueueIndex;
+
+  /**
+   * Give the item just inserted at <i>pos</i> a rank between its neighbours,
+   * renumbering the queue if there is no room left.
+   *
+   * \param pos the position of the inserted item
+   */
+  void SetRank (ConstIterator pos);
+  /**
+   * Add the item at <i>pos</i> to the indexes it belongs to.
+   *
+   * \param pos the position of the item
+   */
+  void AddToIndexes (ConstIterator pos);
+  /**
+   * Insert the item at <i>pos</i> in the given index, keeping the index in queue order.
+   *
+   * \param index the index
+   * \param pos the position of the item
+   */
+  static void InsertInIndex (QueueIndex &index, ConstIterator pos);
+  /**
+   * Remove the given item from all the indexes it belongs to, and drop its
+   * (receiver, TID) index if it is left empty.
+   *
+   * \param item the item
+   */
+  void RemoveFromIndexes (Ptr<WifiMacQueueItem> item);
+  /**
+   * Return the first item of the given index that is at or after <i>pos</i>
+   * and has not expired. Expired items are skipped and flagged.
+   *
+   * \param index the index
+   * \param pos the iterator pointing to the packet the search starts from
+   * \return an iterator pointing to the item, or end () if none
+   */
+  ConstIterator PeekInIndex (const QueueIndex &index, ConstIterator pos) const;
+
   Time m_maxDelay;                          //!< Time to live for packets in the queue
   DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
   mutable bool m_expiredPacketsPresent;     //!< True if expired packets are in the queue
@@ -385,6 +435,18 @@ private:
   /// Per (MAC address, TID) pair queued bytes
   std::unordered_map<WifiAddressTidPair, uint32_t, WifiAddressTidHash> m_nQueuedBytes;
 
+  /// Per (MAC address, TID) pair queued QoS data frames
+  std::unordered_map<WifiAddressTidPair, QueueIndex, WifiAddressTidHash> m_tidAddressIndex;
+  /// Per TID queued QoS data frames
+  std::unordered_map<uint8_t, QueueIndex> m_tidIndex;
+  /// Per receiver address queued data frames
+  std::unordered_map<Mac48Address, QueueIndex, WifiAddressHash> m_addressIndex;
+  /// Queued frames that are not QoS data
+  QueueIndex m_nonQosDataIndex;
+
+  bool m_enableTitrate;                     //!< whether admission follows a Titrate threshold
+  Ptr<TitrateBufferController> m_titrate;   //!< Titrate threshold, created on the first enqueue
+
   /// Traced callback: fired when a packet is dropped due to lifetime expiration
   TracedCallback<Ptr<const WifiMacQueueItem> > m_traceExpired;
 
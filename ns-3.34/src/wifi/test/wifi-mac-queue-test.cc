@@ -20,7 +20,10 @@
 
 #include "ns3/test.h"
 #include "ns3/wifi-mac-queue.h"
+#include "ns3/qos-blocked-destinations.h"
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include <random>
 
 using namespace ns3;
 
@@ -107,6 +110,268 @@ WifiMacQueueDropOldestTest::DoRun ()
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Test the indexed lookups.
+ *
+ * This test inserts and removes frames at random positions and checks that
+ * PeekByAddress, PeekByTid, PeekByTidAndAddress and PeekFirstAvailable return
+ * the same item as a linear scan of the queue.
+ */
+class WifiMacQueueIndexTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  WifiMacQueueIndexTest ();
+
+  void DoRun () override;
+
+private:
+  /**
+   * Check all the lookups against a linear scan
+   * \param queue the queue
+   * \param blocked the blocked (receiver, TID) pairs
+   * \param pos the position the searches start from
+   */
+  void CheckLookups (Ptr<WifiMacQueue> queue, Ptr<QosBlockedDestinations> blocked,
+                     WifiMacQueue::ConstIterator pos);
+
+  std::vector<Mac48Address> m_addresses; ///< receivers of the queued frames
+};
+
+WifiMacQueueIndexTest::WifiMacQueueIndexTest ()
+  : TestCase ("Test indexed lookups")
+{
+}
+
+void
+WifiMacQueueIndexTest::CheckLookups (Ptr<WifiMacQueue> queue, Ptr<QosBlockedDestinations> blocked,
+                                     WifiMacQueue::ConstIterator pos)
+{
+  WifiMacQueue::ConstIterator from = (pos != WifiMacQueue::EMPTY ? pos : queue->begin ());
+  for (uint8_t tid = 0; tid < 3; tid++)
+    {
+      WifiMacQueue::ConstIterator expected = from;
+      while (expected != queue->end ()
+             && !((*expected)->GetHeader ().IsQosData () && (*expected)->GetHeader ().GetQosTid () == tid))
+        {
+          expected++;
+        }
+      NS_TEST_EXPECT_MSG_EQ ((queue->PeekByTid (tid, pos) == expected), true, "Unexpected PeekByTid result");
+
+      for (const auto& address : m_addresses)
+        {
+          expected = from;
+          while (expected != queue->end ()
+                 && !((*expected)->GetHeader ().IsQosData () && (*expected)->GetHeader ().GetQosTid () == tid
+                      && (*expected)->GetHeader ().GetAddr1 () == address))
+            {
+              expected++;
+            }
+          NS_TEST_EXPECT_MSG_EQ ((queue->PeekByTidAndAddress (tid, address, pos) == expected), true,
+                                 "Unexpected PeekByTidAndAddress result");
+        }
+    }
+  for (const auto& address : m_addresses)
+    {
+      WifiMacQueue::ConstIterator expected = from;
+      while (expected != queue->end ()
+             && !((*expected)->GetHeader ().IsData () && (*expected)->GetHeader ().GetAddr1 () == address))
+        {
+          expected++;
+        }
+      NS_TEST_EXPECT_MSG_EQ ((queue->PeekByAddress (address, pos) == expected), true,
+                             "Unexpected PeekByAddress result");
+    }
+  WifiMacQueue::ConstIterator expected = from;
+  while (expected != queue->end () && (*expected)->GetHeader ().IsQosData ()
+         && blocked->IsBlocked ((*expected)->GetHeader ().GetAddr1 (), (*expected)->GetHeader ().GetQosTid ()))
+    {
+      expected++;
+    }
+  NS_TEST_EXPECT_MSG_EQ ((queue->PeekFirstAvailable (blocked, pos) == expected), true,
+                         "Unexpected PeekFirstAvailable result");
+}
+
+void
+WifiMacQueueIndexTest::DoRun ()
+{
+  auto queue = CreateObject<WifiMacQueue> ();
+  queue->SetMaxSize (QueueSize ("1000p"));
+  auto blocked = Create<QosBlockedDestinations> ();
+  m_addresses = {Mac48Address ("00:00:00:00:00:01"), Mac48Address ("00:00:00:00:00:02"),
+                 Mac48Address ("00:00:00:00:00:03")};
+  blocked->Block (m_addresses[0], 1);
+  blocked->Block (m_addresses[1], 0);
+
+  std::mt19937 rng (1);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      uint32_t op = rng () % 10;
+      uint32_t nPackets = queue->GetNPackets ();
+      if (op < 6 || nPackets == 0)
+        {
+          WifiMacHeader header;
+          uint32_t type = rng () % 6;
+          header.SetType (type < 4 ? WIFI_MAC_QOSDATA : (type == 4 ? WIFI_MAC_DATA : WIFI_MAC_MGT_ACTION));
+          header.SetQosTid (rng () % 3);
+          header.SetAddr1 (m_addresses[rng () % m_addresses.size ()]);
+          auto item = Create<WifiMacQueueItem> (Create<Packet> (100), header);
+          uint32_t where = rng () % 3;
+          if (where == 0 || nPackets == 0)
+            {
+              queue->Enqueue (item);
+            }
+          else if (where == 1)
+            {
+              queue->PushFront (item);
+            }
+          else
+            {
+              queue->Insert (std::next (queue->begin (), rng () % nPackets), item);
+            }
+        }
+      else
+        {
+          queue->Dequeue (std::next (queue->begin (), rng () % nPackets));
+        }
+
+      CheckLookups (queue, blocked, WifiMacQueue::EMPTY);
+      nPackets = queue->GetNPackets ();
+      if (nPackets > 0)
+        {
+          CheckLookups (queue, blocked, std::next (queue->begin (), rng () % nPackets));
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Test the Titrate admission.
+ *
+ * With EnableTitrate set, the queue admits frames up to the starting Titrate
+ * threshold, well below MaxSize, and refuses the next one. The refusal opens
+ * a 500 ms monitoring window; the queue is drained 100 ms into it and gets a
+ * frame again 300 ms later, so the threshold grows by 500 / 200 times.
+ */
+class WifiMacQueueTitrateTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  WifiMacQueueTitrateTest ();
+
+  void DoRun () override;
+
+private:
+  /**
+   * Enqueue frames until one is refused
+   * \return the number of frames enqueued
+   */
+  uint32_t Fill (void);
+  /**
+   * Dequeue all the frames
+   */
+  void Drain (void);
+  /**
+   * Enqueue a single frame
+   */
+  void EnqueueOne (void);
+  /**
+   * Check that the frames fitting under the grown threshold are admitted
+   */
+  void CheckGrown (void);
+
+  Ptr<WifiMacQueue> m_queue; ///< the queue
+  uint32_t m_itemSize;       ///< the size of the queued frames
+};
+
+WifiMacQueueTitrateTest::WifiMacQueueTitrateTest ()
+  : TestCase ("Test Titrate admission")
+{
+}
+
+uint32_t
+WifiMacQueueTitrateTest::Fill (void)
+{
+  uint32_t n = 0;
+  while (true)
+    {
+      WifiMacHeader header;
+      header.SetType (WIFI_MAC_QOSDATA);
+      header.SetQosTid (0);
+      auto item = Create<WifiMacQueueItem> (Create<Packet> (1000), header);
+      m_itemSize = item->GetSize ();
+      if (!m_queue->Enqueue (item))
+        {
+          return n;
+        }
+      n++;
+    }
+}
+
+void
+WifiMacQueueTitrateTest::EnqueueOne (void)
+{
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_QOSDATA);
+  header.SetQosTid (0);
+  NS_TEST_EXPECT_MSG_EQ (m_queue->Enqueue (Create<WifiMacQueueItem> (Create<Packet> (1000), header)), true,
+                         "Frame not admitted in an empty queue");
+}
+
+void
+WifiMacQueueTitrateTest::Drain (void)
+{
+  while (m_queue->Dequeue ())
+    {
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNBytes (), 0, "The queue was not drained");
+}
+
+void
+WifiMacQueueTitrateTest::CheckGrown (void)
+{
+  // the queue was empty for 300 ms of the 500 ms window:
+  // the threshold grows by (500 / 200) * 15000 - 15000 bytes
+  uint32_t admitted = Fill ();
+  NS_TEST_EXPECT_MSG_EQ (admitted + 1, 37500 / m_itemSize, "Frames not admitted up to the grown threshold");
+  NS_TEST_EXPECT_MSG_LT (m_queue->GetNPackets (), 100, "The queue should not be limited by MaxSize");
+}
+
+void
+WifiMacQueueTitrateTest::DoRun ()
+{
+  m_queue = CreateObject<WifiMacQueue> ();
+  m_queue->SetMaxSize (QueueSize ("100p"));
+  m_queue->SetAttribute ("EnableTitrate", BooleanValue (true));
+
+  // the threshold starts at the TitrateBufferController InitialThreshold
+  uint32_t dropsBefore = m_queue->GetTotalDroppedPackets ();
+  uint32_t admitted = Fill ();
+  NS_TEST_EXPECT_MSG_EQ (admitted, 15000 / m_itemSize, "Frames not admitted up to the starting threshold");
+  NS_TEST_EXPECT_MSG_LT (m_queue->GetNPackets (), 100, "The queue should not be limited by MaxSize");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetTotalDroppedPackets (), dropsBefore + 1, "The refused frame was not dropped");
+
+  Simulator::Schedule (MilliSeconds (100), &WifiMacQueueTitrateTest::Drain, this);
+  Simulator::Schedule (MilliSeconds (400), &WifiMacQueueTitrateTest::EnqueueOne, this);
+  Simulator::Schedule (MilliSeconds (600), &WifiMacQueueTitrateTest::CheckGrown, this);
+  Simulator::Run ();
+
+  m_queue->Dispose ();
+  m_queue = 0;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -123,6 +388,8 @@ WifiMacQueueTestSuite::WifiMacQueueTestSuite ()
   : TestSuite ("wifi-mac-queue", UNIT)
 {
   AddTestCase (new WifiMacQueueDropOldestTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueIndexTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueTitrateTest, TestCase::QUICK);
 }
 
 static WifiMacQueueTestSuite g_wifiMacQueueTestSuite; ///< the test suite
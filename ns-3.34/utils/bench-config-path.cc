@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks repeated Config::Set calls on a wildcard path
+// against a Config::CompiledPath of the same path. It builds a star of
+// --nodes point-to-point links, then sets the DataRate of every device
+// --iterations times in each mode, and prints the wall time of each.
+// Sample usage:  ./waf --run 'bench-config-path --nodes=1000 --iterations=100'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t nodes = 1000;
+  uint32_t iterations = 100;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark repeated Config::Set against a Config::CompiledPath");
+  cmd.AddValue ("nodes", "number of leaves of the star", nodes);
+  cmd.AddValue ("iterations", "number of Sets in each mode", iterations);
+  cmd.Parse (argc, argv);
+
+  if (nodes == 0 || iterations == 0)
+    {
+      std::cerr << "Error-- need --nodes > 0 and --iterations > 0" << std::endl;
+      exit (1);
+    }
+
+  NodeContainer hub;
+  hub.Create (1);
+  NodeContainer leaves;
+  leaves.Create (nodes);
+  PointToPointHelper p2p;
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      p2p.Install (hub.Get (0), leaves.Get (i));
+    }
+
+  std::string path = "/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/DataRate";
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      Config::Set (path, StringValue (i % 2 ? "10Gbps" : "1Gbps"));
+    }
+  uint64_t setMs = time.End ();
+
+  Config::CompiledPath compiled (path);
+  time.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      compiled.Set (StringValue (i % 2 ? "10Gbps" : "1Gbps"));
+    }
+  uint64_t compiledMs = time.End ();
+
+  std::cout << "devices\titerations\tsetMs\tcompiledMs" << std::endl;
+  std::cout << compiled.GetN ()
+            << "\t" << iterations
+            << "\t" << setMs
+            << "\t" << compiledMs
+            << std::endl;
+  Simulator::Destroy ();
+}
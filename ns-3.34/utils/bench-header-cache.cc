@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the header work done on a TCP data segment
+// along the path of the star topology: the sender adds the TCP and IPv4
+// headers, each switch copies the packet twice (channel and
+// Ipv4L3Protocol::Receive), removes the IPv4 header, peeks the TCP
+// header (queue disc classification) and adds the IPv4 header back,
+// and the sink removes the IPv4 header, peeks the TCP header
+// (TcpL4Protocol) and removes it (TcpSocketBase). It runs the path
+// without and then with Packet::EnableHeaderCache.
+// Sample usage:  ./waf --run 'bench-header-cache --n=100000 --hops=1'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-option-ts.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace ns3;
+
+/// Receive a packet from the channel, as Ipv4L3Protocol::Receive does
+static Ptr<Packet>
+Receive (Ptr<const Packet> p, Ipv4Header &ipHeader)
+{
+  Ptr<Packet> packet = p->Copy ()->Copy ();
+  packet->RemoveHeader (ipHeader);
+  return packet;
+}
+
+/// Carry n segments from the sender to the sink through the switches
+static uint64_t
+BenchPath (uint32_t n, uint32_t hops)
+{
+  uint64_t check = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      TcpHeader tcpHeader;
+      tcpHeader.SetSourcePort (1000);
+      tcpHeader.SetDestinationPort (1000);
+      tcpHeader.SetSequenceNumber (SequenceNumber32 (i * 1448));
+      tcpHeader.SetFlags (TcpHeader::ACK);
+      Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+      ts->SetTimestamp (i);
+      ts->SetEcho (i);
+      tcpHeader.AppendOption (ts);
+      Ipv4Header ipHeader;
+      ipHeader.SetSource (Ipv4Address ("10.1.1.1"));
+      ipHeader.SetDestination (Ipv4Address ("10.2.1.1"));
+      ipHeader.SetProtocol (6);
+      ipHeader.SetTtl (64);
+
+      Ptr<Packet> packet = Create<Packet> (1448);
+      packet->AddHeader (tcpHeader);
+      ipHeader.SetPayloadSize (packet->GetSize ());
+      packet->AddHeader (ipHeader);
+
+      for (uint32_t hop = 0; hop < hops; hop++)
+        {
+          Ipv4Header forward;
+          packet = Receive (packet, forward);
+          TcpHeader peek;
+          packet->PeekHeader (peek);
+          check += peek.GetFlags ();
+          forward.SetTtl (forward.GetTtl () - 1);
+          packet->AddHeader (forward);
+        }
+
+      Ipv4Header local;
+      packet = Receive (packet, local);
+      TcpHeader l4Header;
+      packet->PeekHeader (l4Header);
+      TcpHeader socketHeader;
+      packet->RemoveHeader (socketHeader);
+      check += local.GetTtl () + socketHeader.GetSequenceNumber ().GetValue () + packet->GetSize ();
+    }
+  return check;
+}
+
+static void
+RunBench (uint32_t n, uint32_t hops, char const *name)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  uint64_t check = BenchPath (n, hops);
+  uint64_t deltaMs = time.End ();
+  std::cout << deltaMs * 1e6 / n << " ns/segment"
+            << " (" << deltaMs << " ms elapsed, checksum " << check << ")\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100000;
+  uint32_t hops = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the header work on a TCP segment through the star topology");
+  cmd.AddValue ("n", "number of segments", n);
+  cmd.AddValue ("hops", "number of switches between the sender and the sink", hops);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- need --n > 0" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-header-cache with n=" << n << " hops=" << hops << std::endl;
+
+  RunBench (n, hops, "Deserialize in every reader");
+  // no packet is left, so the cache can be enabled for the second run
+  Packet::EnableHeaderCache ();
+  RunBench (n, hops, "Header cache");
+}
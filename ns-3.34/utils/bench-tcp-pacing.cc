@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks TCP pacing with many flows on one sender: n
+// paced flows (BBR by default) share a point-to-point link, paced first
+// by a timer per socket and then by the pacing scheduler of the node
+// (TcpL4Protocol::SharedPacing) with --timerSlack. The number of flows
+// doubles from 1 to --maxFlows. For each run it prints the simulator events, the wall
+// time, the events per second and the bytes received by the sinks,
+// which stay close in both modes when the pacing rates are honored.
+// Sample usage:  ./waf --run 'bench-tcp-pacing --maxFlows=256 --duration=1'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace ns3;
+
+/// Run n flows for duration seconds, and print the statistics of the run
+static void
+RunBench (uint32_t n, double duration, std::string cca, bool shared)
+{
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TypeId::LookupByName ("ns3::Tcp" + cca)));
+  Config::SetDefault ("ns3::TcpL4Protocol::SharedPacing", BooleanValue (shared));
+  Config::SetDefault ("ns3::TcpSocketState::EnablePacing", BooleanValue (true));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("10000p"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  ApplicationContainer sources;
+  ApplicationContainer sinks;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint16_t port = 1000 + i;
+      BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), port));
+      sources.Add (source.Install (nodes.Get (0)));
+      PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+      sinks.Add (sink.Install (nodes.Get (1)));
+    }
+  sources.Start (Seconds (0));
+  Simulator::Stop (Seconds (duration));
+
+  uint64_t events = Simulator::GetEventCount ();
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+  events = Simulator::GetEventCount () - events;
+
+  uint64_t rx = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      rx += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  std::cout << n << "\t" << (shared ? "shared" : "timers")
+            << "\t" << events
+            << "\t" << deltaMs
+            << "\t" << (deltaMs > 0 ? events * 1000 / deltaMs : 0)
+            << "\t" << rx
+            << std::endl;
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t maxFlows = 256;
+  double duration = 1;
+  std::string cca = "Bbr";
+  Time timerSlack = MicroSeconds (10);
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark TCP pacing with per-socket timers and with the shared pacing scheduler");
+  cmd.AddValue ("maxFlows", "largest number of flows", maxFlows);
+  cmd.AddValue ("duration", "simulated seconds per run", duration);
+  cmd.AddValue ("cca", "congestion control of the flows, without ns3::Tcp", cca);
+  cmd.AddValue ("timerSlack", "TimerSlack of the pacing scheduler", timerSlack);
+  cmd.Parse (argc, argv);
+
+  if (maxFlows == 0 || duration <= 0)
+    {
+      std::cerr << "Error-- need --maxFlows > 0 and --duration > 0" << std::endl;
+      exit (1);
+    }
+  Config::SetDefault ("ns3::TcpPacingScheduler::TimerSlack", TimeValue (timerSlack));
+  std::cout << "flows\tpacing\tevents\twallMs\tevents/s\trxBytes" << std::endl;
+  for (uint32_t n = 1; n <= maxFlows; n *= 2)
+    {
+      RunBench (n, duration, cca, false);
+      RunBench (n, duration, cca, true);
+    }
+}
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the per-feedback cost of the GCC trendline
+// estimator: one new delay sample, evictions out of the window, and a
+// least-squares slope over the window. It compares the running-sum
+// rmcat::TrendlineAccumulator against a two-pass fit over the whole window.
+// Sample usage:  ./waf --run 'bench-trendline --n=100000 --window=1000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/gcc-controller.h"
+#include <iostream>
+#include <deque>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Delay samples: one per ms, a slow random walk with a trend
+static std::vector<double>
+MakeSamples (uint32_t n)
+{
+  std::vector<double> samples (n);
+  double y = 0;
+  srand (1);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      y += 0.01 + (rand () % 1000 - 500) / 1000.0;
+      samples[i] = y;
+    }
+  return samples;
+}
+
+/// The two-pass fit GccController used before TrendlineAccumulator
+static double
+TwoPassSlope (const std::deque<std::pair<double, double>>& points)
+{
+  double sum_x = 0;
+  double sum_y = 0;
+  for (const std::pair<double, double>& point : points)
+    {
+      sum_x += point.first;
+      sum_y += point.second;
+    }
+  double x_avg = sum_x / points.size ();
+  double y_avg = sum_y / points.size ();
+  double numerator = 0;
+  double denominator = 0;
+  for (const std::pair<double, double>& point : points)
+    {
+      numerator += (point.first - x_avg) * (point.second - y_avg);
+      denominator += (point.first - x_avg) * (point.first - x_avg);
+    }
+  if (denominator == 0)
+    {
+      return 0;
+    }
+  return numerator / denominator;
+}
+
+static double
+BenchTwoPass (const std::vector<double>& samples, uint32_t window, std::vector<double>& slopes)
+{
+  std::deque<std::pair<double, double>> points;
+  double check = 0;
+  for (uint32_t i = 0; i < samples.size (); i++)
+    {
+      points.push_back (std::make_pair (static_cast<double> (i), samples[i]));
+      while (points.size () > window)
+        {
+          points.pop_front ();
+        }
+      slopes[i] = TwoPassSlope (points);
+      check += slopes[i];
+    }
+  return check;
+}
+
+static double
+BenchAccumulator (const std::vector<double>& samples, uint32_t window, std::vector<double>& slopes)
+{
+  rmcat::TrendlineAccumulator points;
+  double check = 0;
+  for (uint32_t i = 0; i < samples.size (); i++)
+    {
+      points.Add (static_cast<double> (i), samples[i]);
+      while (points.Size () > window)
+        {
+          points.PopFront ();
+        }
+      slopes[i] = points.Slope ();
+      check += slopes[i];
+    }
+  return check;
+}
+
+static void
+RunBench (double (*bench) (const std::vector<double>&, uint32_t, std::vector<double>&),
+          const std::vector<double>& samples, uint32_t window, std::vector<double>& slopes,
+          char const *name)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  double check = (*bench) (samples, window, slopes);
+  uint64_t deltaMs = time.End ();
+  std::cout << deltaMs * 1e6 / samples.size () << " ns/feedback"
+            << " (" << deltaMs << " ms elapsed, checksum " << check << ")\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100000;
+  uint32_t window = 1000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the GCC trendline estimator");
+  cmd.AddValue ("n", "number of feedbacks", n);
+  cmd.AddValue ("window", "number of samples in the regression window", window);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || window < 2)
+    {
+      std::cerr << "Error-- need --n > 0 and --window >= 2" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-trendline with n=" << n << " window=" << window << std::endl;
+
+  std::vector<double> samples = MakeSamples (n);
+  std::vector<double> twoPass (n);
+  std::vector<double> accumulator (n);
+  RunBench (&BenchTwoPass, samples, window, twoPass, "Two-pass fit over the window");
+  RunBench (&BenchAccumulator, samples, window, accumulator, "Running-sum accumulator");
+
+  double maxError = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      maxError = std::max (maxError, std::abs (twoPass[i] - accumulator[i]));
+    }
+  std::cout << "Max slope difference: " << maxError << std::endl;
+
+  return 0;
+}